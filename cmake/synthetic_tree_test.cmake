@@ -0,0 +1,44 @@
+# ctest driver: build a synthetic sysfs/procfs tree, take two CPUs offline and
+# check that --fs-root=... --list reports exactly the tree's usable CPUs.
+#
+#   cmake -DCPU_INSTR_FREQ=<binary> -DTREE_DIR=<scratch dir> -P synthetic_tree_test.cmake
+
+if(NOT CPU_INSTR_FREQ OR NOT TREE_DIR)
+  message(FATAL_ERROR "CPU_INSTR_FREQ and TREE_DIR must be set")
+endif()
+
+function(run_checked output_var)
+  execute_process(COMMAND ${ARGN}
+                  RESULT_VARIABLE result
+                  OUTPUT_VARIABLE output
+                  ERROR_VARIABLE output
+                  TIMEOUT 60)
+  if(NOT result EQUAL 0)
+    message(FATAL_ERROR "'${ARGN}' failed (${result}):\n${output}")
+  endif()
+  set(${output_var} "${output}" PARENT_SCOPE)
+endfunction()
+
+function(expect output pattern)
+  if(NOT output MATCHES "${pattern}")
+    message(FATAL_ERROR "Expected '${pattern}' in:\n${output}")
+  endif()
+endfunction()
+
+file(REMOVE_RECURSE "${TREE_DIR}")
+
+run_checked(output "${CPU_INSTR_FREQ}" "--synth-tree=${TREE_DIR}" --synth-cpus=8 --synth-smt=2)
+expect("${output}" "Synthetic tree with 8 CPUs")
+
+file(WRITE "${TREE_DIR}/sys/devices/system/cpu/online" "0-5\n")
+
+run_checked(output "${CPU_INSTR_FREQ}" "--fs-root=${TREE_DIR}" --list)
+expect("${output}" "Model: Synthetic CPU")
+expect("${output}" "Cores: 6 usable \\(0-5\\)")
+expect("${output}" "Skipped offline: 6-7")
+expect("${output}" "Core 5: 3000 MHz")
+if(output MATCHES "Core 6: ")
+  message(FATAL_ERROR "Offline CPU 6 was sampled:\n${output}")
+endif()
+
+file(REMOVE_RECURSE "${TREE_DIR}")
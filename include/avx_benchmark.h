@@ -1,8 +1,17 @@
 #pragma once
 
+#include <map>
 #include <string>
 #include <vector>
 
+#include "cpu_utils.h"
+#include "numa_placement.h"
+#include "steady_state.h"
+
+class SpinBarrier;
+struct RawTrace;
+class LiveBoard;
+
 enum class InstructionSet {
     AVX128,
     AVX256,
@@ -11,27 +20,154 @@ enum class InstructionSet {
     BASIC_ADD
 };
 
+// Why a run produced no result
+enum class BenchmarkFailure {
+    NONE,
+    UNSUPPORTED_ISA,   // The CPU has no kernel for the instruction set
+    NOT_PINNABLE,      // The thread could not be pinned to core_id
+    NO_SAMPLES,        // The run finished without a single frequency sample
+    ERROR              // The run threw, see BenchmarkResult::error
+};
+
 // Structure to hold benchmark results
 struct BenchmarkResult {
     int core_id;
-    double min_freq;
-    double max_freq;
-    double avg_freq;
+    double min_freq = 0.0;
+    double max_freq = 0.0;
+    double avg_freq = 0.0;
     std::vector<double> frequencies;
     bool success;
+    BenchmarkFailure failure = BenchmarkFailure::NONE; // Set whenever success is false
+    std::string error;                 // What the run threw, for BenchmarkFailure::ERROR
+
+    // Run loop accounting
+    size_t batch_iterations = 0;       // Kernel iterations per batch, from calibration
+    unsigned long long total_iterations = 0;
+    double elapsed_sec = 0.0;          // Measured kernel run time
+    double overrun_us = 0.0;           // How far the last batch ran past the deadline
+    unsigned long long start_tsc = 0;  // TSC when the first batch started
+    unsigned long long end_tsc = 0;    // TSC when the last batch finished
+
+    // Seconds since the monitor started, one entry per frequency sample
+    std::vector<double> sample_times;
+    unsigned long long monitor_start_tsc = 0;  // TSC at sample time 0, places samples on the TSC timeline
+
+    // Adaptive run summary (only filled when BenchmarkOptions::adaptive is set)
+    bool adaptive = false;
+    bool converged = false;            // Stopped because the CI target was met
+    double warmup_sec = -1.0;
+    double steady_mean = 0.0;
+    double ci_half_width = 0.0;
+    int throttle_events = 0;
+    std::vector<PhaseSpan> phases;
+
+    // Observer cost
+    bool sampled = false;              // The frequency monitor ran alongside the kernel
+    double sampler_cpu_sec = 0.0;      // Monitor thread CPU time (getrusage RUSAGE_THREAD)
+    double sampler_wait_sec = -1.0;    // Monitor thread runqueue wait (schedstat), -1 if unavailable
+    long kernel_preemptions = 0;       // Involuntary context switches of the kernel thread during the run
+
+    double avg_package_power_w = -1.0; // From RAPL energy readings, -1 if not measured
+
+    // Package power between consecutive RAPL readings, stamped at the end of
+    // each interval on the sample_times clock. Empty unless power was sampled.
+    int package_id = -1;
+    std::vector<double> power_times;
+    std::vector<double> package_power_w;
+
+    // NUMA placement of the run's sample and trace storage
+    int cpu_node = -1;                 // Node of core_id
+    int memory_node = -1;              // Node the storage was bound to, -1 if not placed
+    size_t memory_pages = 0;           // Pages of storage checked with move_pages()
+    size_t memory_pages_off_node = 0;  // Of those, pages found on another node (or unknown)
+};
+
+// Options controlling a single benchmark run
+struct BenchmarkOptions {
+    int duration_sec = 5;              // Fixed run length when not adaptive
+    int sampling_interval_ms = 100;
+    FrequencySource source = FrequencySource::AUTO;
+    bool adaptive = false;             // Stop on steady state instead of duration_sec
+    SteadyStateOptions steady_state;
+    SpinBarrier* start_barrier = nullptr; // If set, wait here right before the first batch
+    bool pin_thread = true;            // Pin the calling thread to core_id first (false on WorkerPool workers)
+    bool sample_frequency = true;      // False runs the kernel unobserved: throughput only, no frequencies
+    RawTrace* raw_trace = nullptr;     // If set, every raw reading of the run is recorded here
+    bool sample_package_power = false; // Read the RAPL package energy with each sample; implied by raw_trace
+    LiveBoard* live_board = nullptr;   // If set, progress is published to core_id's slot for a live view
+    MemoryPlacement memory_placement = MemoryPlacement::LOCAL; // Node the run's allocations are bound to
 };
 
 // Convert string to instruction set enum
 InstructionSet string_to_instruction_set(const std::string& str);
 
+// Parse a comma-separated list such as "avx256,avx512"
+std::vector<InstructionSet> string_to_instruction_set_list(const std::string& str);
+
+// All instruction sets, in the order they are reported
+std::vector<InstructionSet> all_instruction_sets();
+
+// Target wall time for one kernel batch in the run loop
+constexpr double kTargetBatchMs = 1.0;
+
+// Pick an iteration count so one call to the kernel takes about target_ms.
+// Must run on the core that will execute the benchmark.
+size_t calibrate_batch_iterations(InstructionSet instr_set, double target_ms);
+
 // Run the benchmark with specified instruction set for the given duration
 void run_benchmark(InstructionSet instr_set, int duration_sec, int core_id);
+void run_benchmark(InstructionSet instr_set, const BenchmarkOptions& options, int core_id);
 
 // Run the benchmark with specified instruction set and return results
 BenchmarkResult run_benchmark_with_result(InstructionSet instr_set, int duration_sec, int core_id);
+BenchmarkResult run_benchmark_with_result(InstructionSet instr_set, const BenchmarkOptions& options, int core_id);
 
 // Get the string name of the instruction set
 std::string get_instruction_set_name(InstructionSet instr_set);
 
+// Derive the frequency statistics and, for adaptive runs, the steady-state
+// summary from the samples in result, and mark it successful. detector must
+// have seen every sample. Shared by live runs and --replay.
+void finalize_benchmark_result(BenchmarkResult& result, const BenchmarkOptions& options,
+                               const SteadyStateDetector& detector);
+
+// One-line reason a failed run did not produce a result, e.g. for
+// "Error: " prefixes
+std::string get_benchmark_failure_message(const BenchmarkResult& result, InstructionSet instr_set);
+
 // Print detailed benchmark results
-void print_benchmark_result(const BenchmarkResult& result, const std::string& instr_name);
\ No newline at end of file
+void print_benchmark_result(const BenchmarkResult& result, const std::string& instr_name);
+
+// Print up to 50 timestamped samples of a run
+void print_frequency_timeline(const BenchmarkResult& result);
+
+// Aggregate of several per-core results that ran together
+struct ResultSummary {
+    int cores = 0;                  // Results in the set
+    int succeeded = 0;              // Results with success set
+    double avg_freq = 0.0;          // Mean of the per-core averages
+    double min_core_freq = 0.0;     // Slowest core's average
+    double throughput = 0.0;        // Total kernel iterations per second
+    bool all_succeeded() const { return cores > 0 && succeeded == cores; }
+};
+
+ResultSummary summarize_results(const std::vector<BenchmarkResult>& results);
+
+// How closely a synchronized run started, from the per-core start/end TSC.
+// Assumes an invariant TSC that is synchronized across cores.
+struct StartAlignment {
+    int cores = 0;                  // Successful results considered
+    double skew_us = 0.0;           // Last start minus first start
+    double overlap_sec = 0.0;       // Time during which every core was running
+};
+
+// Results of a multi-core run keyed by CPU id. Usable ids can be sparse and
+// exceed 1023, so results are never indexed by a dense 0..N-1 vector.
+using CoreResults = std::map<int, BenchmarkResult>;
+
+StartAlignment compute_start_alignment(const std::vector<BenchmarkResult>& results);
+StartAlignment compute_start_alignment(const CoreResults& results);
+
+// Print start skew and fully-overlapped window of a synchronized run
+void print_start_alignment(const std::vector<BenchmarkResult>& results);
+void print_start_alignment(const CoreResults& results);
\ No newline at end of file
@@ -0,0 +1,65 @@
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+#include "avx_benchmark.h"
+
+// Streaming writer for the Chrome trace-event "JSON Array Format", which
+// chrome://tracing and ui.perfetto.dev load directly. Every event is
+// formatted whole into a reused buffer and handed to the sink at once, so a
+// trace of any length never sits in memory. The format allows the closing
+// ']' to be missing, so a file cut short by a crash still loads.
+//
+// Timestamps are microseconds. Processes (pid) and threads (tid) become
+// track groups and tracks in the viewer.
+class ChromeTraceWriter {
+public:
+    using Sink = std::function<void(const char* data, size_t length)>;
+
+    explicit ChromeTraceWriter(Sink sink) : sink_(std::move(sink)) {}
+
+    // Opening '[' of a new file; resets the comma state
+    void begin();
+    // Closing ']'
+    void end();
+
+    // Metadata: names and ordering of tracks
+    void process_name(int pid, const std::string& name);
+    void process_sort_index(int pid, int index);
+    void thread_name(int pid, int tid, const std::string& name);
+
+    // Counter track `name` in process pid, one series
+    void counter(int pid, const char* name, double ts_us, const char* series, double value);
+
+    // Slice with a known duration on a thread track; `detail` becomes args.detail if non-empty
+    void complete(int pid, int tid, const std::string& name, const char* category,
+                  double ts_us, double dur_us, const std::string& detail = std::string());
+
+    // Zero-length marker on a thread track
+    void instant(int pid, int tid, const std::string& name, double ts_us);
+
+private:
+    void emit(const char* format, ...) __attribute__((format(printf, 2, 3)));
+
+    Sink sink_;
+    bool first_ = true;
+    std::string event_;   // Formatting buffer, grows to the longest event
+};
+
+// One finished benchmark run to place on the trace timeline
+struct TraceRun {
+    std::string label;              // Phase or suite entry the run belonged to
+    InstructionSet instr_set;
+    const BenchmarkResult* result;
+};
+
+// Write runs as one trace: per CPU a frequency counter track, a kernel track
+// with one slice per run, and for adaptive runs a track of warm-up, steady
+// and throttling slices. Runs that sampled package power add a power counter
+// track per package. Runs are placed by their TSC stamps, so runs on
+// different CPUs and in different phases line up. Throws std::runtime_error
+// if the file cannot be written.
+void write_chrome_trace(const std::string& path, const std::vector<TraceRun>& runs);
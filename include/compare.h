@@ -0,0 +1,81 @@
+#pragma once
+
+#include <ostream>
+#include <string>
+#include <vector>
+
+#include "scenario_file.h"
+
+// How a core's frequency samples are tested against the baseline
+enum class CompareTest {
+    MANN_WHITNEY,   // Two-sided Mann-Whitney U, normal approximation with tie correction
+    BOOTSTRAP       // Percentile bootstrap CI of the relative change of the mean
+};
+
+struct CompareOptions {
+    std::string baseline_path;      // A JSON report written by --scenario-file
+    CompareTest test = CompareTest::MANN_WHITNEY;
+    double threshold_pct = 2.0;     // Drops smaller than this are never regressions
+    double alpha = 0.05;            // Significance level; the bootstrap CI is 1 - alpha
+    int bootstrap_rounds = 2000;
+};
+
+// Convert "mwu" or "bootstrap". Throws std::invalid_argument.
+CompareTest string_to_compare_test(const std::string& str);
+
+// One per-core result of a stored report
+struct BaselineCore {
+    int cpu = 0;
+    std::string instr;              // As written by get_instruction_set_name()
+    bool success = false;
+    std::vector<double> frequencies;
+    double throughput = 0.0;        // Kernel iterations per second
+};
+
+struct BaselinePhase {
+    std::string name;
+    std::vector<BaselineCore> cores;
+};
+
+struct BaselineReport {
+    std::string scenario_path;      // Scenario file the report was produced from
+    std::vector<BaselinePhase> phases;
+};
+
+// Load a --scenario-file JSON report. Throws std::runtime_error naming the file.
+BaselineReport load_baseline_report(const std::string& path);
+
+// Verdict for one (phase, core, ISA) present in the baseline
+struct CoreComparison {
+    std::string phase;
+    int cpu = 0;
+    std::string instr;
+    bool missing = false;           // Failed or absent in the current run
+    bool no_baseline = false;       // Baseline kept no samples after warm-up; not tested
+    size_t baseline_samples = 0;
+    size_t current_samples = 0;
+    double baseline_mhz = 0.0;      // Median (Mann-Whitney) or mean (bootstrap)
+    double current_mhz = 0.0;
+    double change_pct = 0.0;        // Relative change of the location estimate
+    double p_value = -1.0;          // Mann-Whitney only
+    double ci_low_pct = 0.0;        // Bootstrap only
+    double ci_high_pct = 0.0;
+    double throughput_change_pct = 0.0;
+    bool significant = false;
+    bool regression = false;        // Significant and worse than the threshold, or missing
+};
+
+// Compare every successful baseline core with the same CPU and ISA in the
+// same phase of the current run. Samples from an adaptive run's warm-up are
+// left out on both sides.
+std::vector<CoreComparison> compare_with_baseline(const BaselineReport& baseline,
+                                                  const Scenario& scenario,
+                                                  const std::vector<PhaseResult>& phase_results,
+                                                  const CompareOptions& options);
+
+// Table of all comparisons, regressions marked
+void print_comparison(const std::vector<CoreComparison>& comparisons, const CompareOptions& options);
+
+// The comparison as one JSON document
+void write_comparison_report(std::ostream& out, const std::vector<CoreComparison>& comparisons,
+                             const CompareOptions& options, const std::string& scenario_path);
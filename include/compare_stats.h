@@ -0,0 +1,18 @@
+#pragma once
+
+#include <vector>
+
+// Statistics behind --compare, kept apart from the report handling so they
+// can be tested on their own.
+
+// Two-sided p-value of the Mann-Whitney U test for a != b in location. Uses
+// the normal approximation with tie correction; 1 when either side is empty
+// or every sample is identical.
+double mann_whitney_p_value(const std::vector<double>& a, const std::vector<double>& b);
+
+// Percentile bootstrap CI (level 1 - alpha) of the relative change of the
+// mean from baseline to current, in percent, over at least 100 rounds.
+// Seeded so the same two runs always give the same interval. Both bounds
+// are 0 when either side is empty.
+void bootstrap_change_ci(const std::vector<double>& baseline, const std::vector<double>& current,
+                         double alpha, int rounds, double& low_pct, double& high_pct);
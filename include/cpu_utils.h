@@ -6,14 +6,44 @@
 #include <functional>
 
 // CPU core-related functions
-void pin_to_core(int core_id);
-int get_core_count();
-int get_max_core_id();
+bool pin_to_core(int core_id);      // Prints the result; returns false on failure
+bool try_pin_to_core(int core_id);  // Silent; returns false on failure
+int get_core_count();               // Number of usable CPUs
+int get_max_core_id();              // Highest usable CPU id
+std::vector<int> get_benchmark_cpus(); // Usable CPU ids, the set the all-cores modes run on
+
+// Why a CPU known to the kernel can or cannot be benchmarked
+enum class CpuStatus {
+    USABLE,
+    OFFLINE,            // Not in /sys/devices/system/cpu/online
+    OUTSIDE_CPUSET,     // Not in the effective cpuset of our cgroup
+    OUTSIDE_AFFINITY    // Not in the affinity mask the process started with
+};
+
+std::string get_cpu_status_name(CpuStatus status);
+
+// Status of every possible CPU. Combines the online list, the cgroup cpuset
+// and sched_getaffinity; all are read below cfp::fs_root() except the
+// affinity mask, which is only consulted on the real root. Read on first use
+// and again only when the fs root changes, so CPUs hotplugged during a run
+// are not picked up.
+std::map<int, CpuStatus> get_cpu_availability();
 
 // CPU frequency monitoring
+enum class FrequencySource {
+    AUTO,      // /proc/cpuinfo, falling back to sysfs scaling_cur_freq
+    CPUINFO,   // "cpu MHz" from /proc/cpuinfo only
+    SYSFS      // /sys/devices/system/cpu/cpuN/cpufreq/scaling_cur_freq only
+};
+
+FrequencySource string_to_frequency_source(const std::string& str); // Throws std::invalid_argument
+std::string get_frequency_source_name(FrequencySource source);
+
 double get_cpu_freq_mhz(int core_id);
+double get_cpu_freq_mhz(int core_id, FrequencySource source);
 std::vector<double> monitor_cpu_freq(int core_id, int duration_ms, int sampling_interval_ms);
 std::map<int, double> get_all_core_frequencies(); // New function to get all core frequencies
+std::map<int, double> get_all_core_frequencies(const std::vector<int>& cpus); // Of the given CPUs only
 std::map<int, std::vector<double>> monitor_all_cpu_freq(int duration_ms, int sampling_interval_ms); // New function to monitor all cores
 
 // Run a function on a specific core
@@ -26,6 +56,25 @@ void run_on_all_cores(const std::function<void()>& func);
 void run_on_all_cores_sequential(const std::function<void(int)>& func);
 
 // CPU feature detection
+struct CpuFeatures {
+    bool sse = false;
+    bool sse2 = false;
+    bool avx = false;
+    bool avx2 = false;
+    bool fma = false;
+    bool avx512f = false;
+    bool amx_tile = false;
+    bool amx_bf16 = false;
+};
+
+// Features are probed once (CPUID plus XGETBV for OS register state support)
+// and cached for the lifetime of the process
+const CpuFeatures& get_cpu_features();
+
+// Look for a flag in the "flags" line of /proc/cpuinfo. Uncached; the
+// fallback feature source when CPUID is not available.
+bool check_cpu_flag(const std::string& flag);
+
 bool has_sse();
 bool has_sse2();
 bool has_avx();
@@ -33,10 +82,20 @@ bool has_avx2();
 bool has_avx512f();
 bool has_amx();
 
+// Time stamp counter. read_tsc() is a single RDTSC on x86 (steady_clock
+// nanoseconds elsewhere); get_tsc_hz() is calibrated against steady_clock
+// on first use and cached.
+unsigned long long read_tsc();
+double get_tsc_hz();
+
 // CPUID helper
 void safe_cpuid(unsigned int leaf, unsigned int subleaf, unsigned int* eax, unsigned int* ebx, unsigned int* ecx, unsigned int* edx);
 
+// CPU model name from /proc/cpuinfo
+std::string get_cpu_model_name();
+
 // Print CPU information
 void print_cpu_info();
+void print_cpu_availability();
 void print_all_core_frequencies();
 void print_single_core_info(int core_id); // New function to print info for just one core
\ No newline at end of file
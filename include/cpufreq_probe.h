@@ -0,0 +1,88 @@
+/*
+ * cpufreq_probe - embeddable per-core CPU frequency sampling.
+ *
+ * A probe owns one background sampler thread that reads the selected CPUs at
+ * a fixed interval and publishes the latest value of each CPU into a
+ * per-core slot. cfp_read() copies a slot without locks or system calls, so
+ * it can be called from latency-sensitive code.
+ *
+ * The library never prints and never terminates the process; every failure
+ * is reported through a negative CFP_E* return code.
+ */
+#ifndef CPUFREQ_PROBE_H
+#define CPUFREQ_PROBE_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define CFP_API_VERSION 1
+
+/* Return codes */
+#define CFP_OK        0
+#define CFP_EINVAL   (-1)   /* Bad argument */
+#define CFP_ENOENT   (-2)   /* No usable frequency source for a CPU */
+#define CFP_ESTATE   (-3)   /* Call not valid in the current state */
+#define CFP_ENOMEM   (-4)
+#define CFP_ESYS     (-5)   /* System call failed */
+#define CFP_ENODATA  (-6)   /* No sample published yet */
+
+/* Where frequencies are read from */
+typedef enum cfp_source {
+    CFP_SOURCE_AUTO = 0,     /* sysfs when the CPU has cpufreq, else /proc/cpuinfo */
+    CFP_SOURCE_SYSFS = 1,    /* /sys/devices/system/cpu/cpuN/cpufreq/scaling_cur_freq */
+    CFP_SOURCE_CPUINFO = 2   /* "cpu MHz" lines of /proc/cpuinfo */
+} cfp_source;
+
+typedef struct cfp_options {
+    cfp_source source;
+    uint32_t interval_us;    /* Sampling interval, default 100000 */
+    const int* cpus;         /* CPUs to sample; NULL samples every online CPU */
+    size_t cpu_count;
+    int sampler_cpu;         /* Pin the sampler thread to this CPU, -1 to leave it unpinned */
+} cfp_options;
+
+typedef struct cfp_sample {
+    uint64_t timestamp_ns;   /* CLOCK_MONOTONIC time of the read */
+    uint32_t freq_khz;
+    uint64_t sequence;       /* Number of samples published for this CPU */
+} cfp_sample;
+
+typedef struct cfp_probe cfp_probe;
+
+/* Fill options with defaults */
+void cfp_options_init(cfp_options* options);
+
+/* Open sources for the selected CPUs. Nothing is sampled until cfp_start(). */
+int cfp_open(const cfp_options* options, cfp_probe** out);
+
+/* Start and stop the background sampler thread */
+int cfp_start(cfp_probe* probe);
+int cfp_stop(cfp_probe* probe);
+
+/* Copy the latest sample of a CPU. Lock-free and wait-free for the reader
+ * except while the sampler is mid-update of that one slot. */
+int cfp_read(const cfp_probe* probe, int cpu, cfp_sample* out);
+
+/* Stop if running and release everything */
+void cfp_close(cfp_probe* probe);
+
+/* Read every sysfs/procfs path below this directory instead of "/", e.g. a
+ * synthetic tree for tests. NULL or "" restores the live system. Affects
+ * probes opened afterwards. Returns CFP_ESTATE, leaving the root unchanged,
+ * while any probe is started. */
+int cfp_set_fs_root(const char* root);
+
+/* Pin the calling thread to one CPU */
+int cfp_pin_thread(int cpu);
+
+const char* cfp_strerror(int code);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* CPUFREQ_PROBE_H */
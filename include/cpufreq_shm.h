@@ -0,0 +1,140 @@
+/*
+ * cpufreq_shm.h - reader for the per-core table published by
+ * `cpu_instr_freq --daemon`.
+ *
+ * The daemon maps a POSIX shared-memory segment (default "/cpu_instr_freq")
+ * holding a header followed by one 64-byte entry per CPU id. Each entry is
+ * guarded by its own sequence counter: odd while the daemon writes, even
+ * when stable. Readers map the segment read-only and copy an entry with
+ * plain loads, retrying if the counter moved. No system call per read.
+ *
+ * Header-only, C99 or C++, GCC/Clang atomics builtins. Link with -lrt on
+ * older glibc.
+ */
+#ifndef CPUFREQ_SHM_H
+#define CPUFREQ_SHM_H
+
+#include <fcntl.h>
+#include <stdint.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define CFS_DEFAULT_NAME "/cpu_instr_freq"
+#define CFS_MAGIC 0x53514643u   /* "CFQS" */
+#define CFS_VERSION 1u
+
+#define CFS_TEMP_UNKNOWN INT32_MIN
+#define CFS_POWER_UNKNOWN UINT32_MAX
+
+struct cfs_header {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t cpu_slots;        /* Entries that follow, indexed by CPU id */
+    uint32_t entry_size;       /* sizeof(struct cfs_entry) */
+    uint64_t interval_ns;      /* Daemon sampling interval */
+    uint64_t daemon_pid;
+    uint64_t updates;          /* Completed sampling passes, for liveness checks */
+    uint8_t reserved[24];
+};
+
+struct cfs_entry {
+    uint32_t seq;              /* Seqlock counter */
+    uint32_t present;          /* 1 if the daemon samples this CPU */
+    uint64_t timestamp_ns;     /* CLOCK_MONOTONIC of the sample */
+    uint32_t freq_khz;
+    int32_t temp_mdegc;        /* Core (or package) temperature, CFS_TEMP_UNKNOWN if none */
+    uint32_t package_power_mw; /* Power of this CPU's package, CFS_POWER_UNKNOWN if none */
+    uint32_t package_id;
+    uint8_t reserved[32];
+};
+
+/* A stable copy of one entry */
+struct cfs_value {
+    uint64_t timestamp_ns;
+    uint32_t freq_khz;
+    int32_t temp_mdegc;
+    uint32_t package_power_mw;
+    uint32_t package_id;
+};
+
+struct cfs_reader {
+    const struct cfs_header* header;
+    const struct cfs_entry* entries;
+    size_t size;
+};
+
+/* Map the table read-only. Returns 0 on success, -1 on failure. */
+static inline int cfs_open(struct cfs_reader* reader, const char* name) {
+    memset(reader, 0, sizeof(*reader));
+    int fd = shm_open(name ? name : CFS_DEFAULT_NAME, O_RDONLY, 0);
+    if (fd < 0) {
+        return -1;
+    }
+
+    struct stat st;
+    if (fstat(fd, &st) != 0 || (size_t)st.st_size < sizeof(struct cfs_header)) {
+        close(fd);
+        return -1;
+    }
+
+    void* map = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (map == MAP_FAILED) {
+        return -1;
+    }
+
+    const struct cfs_header* header = (const struct cfs_header*)map;
+    size_t needed = sizeof(struct cfs_header) + (size_t)header->cpu_slots * sizeof(struct cfs_entry);
+    if (header->magic != CFS_MAGIC || header->version != CFS_VERSION ||
+        header->entry_size != sizeof(struct cfs_entry) || needed > (size_t)st.st_size) {
+        munmap(map, (size_t)st.st_size);
+        return -1;
+    }
+
+    reader->header = header;
+    reader->entries = (const struct cfs_entry*)(header + 1);
+    reader->size = (size_t)st.st_size;
+    return 0;
+}
+
+/* Copy the latest values of a CPU. Returns 0 on success, -1 if the CPU is
+ * not in the table or has no sample yet. */
+static inline int cfs_read(const struct cfs_reader* reader, uint32_t cpu, struct cfs_value* out) {
+    if (cpu >= reader->header->cpu_slots) {
+        return -1;
+    }
+    const struct cfs_entry* entry = &reader->entries[cpu];
+    uint32_t before, after;
+
+    do {
+        before = __atomic_load_n(&entry->seq, __ATOMIC_ACQUIRE);
+        out->timestamp_ns = __atomic_load_n(&entry->timestamp_ns, __ATOMIC_RELAXED);
+        out->freq_khz = __atomic_load_n(&entry->freq_khz, __ATOMIC_RELAXED);
+        out->temp_mdegc = __atomic_load_n(&entry->temp_mdegc, __ATOMIC_RELAXED);
+        out->package_power_mw = __atomic_load_n(&entry->package_power_mw, __ATOMIC_RELAXED);
+        out->package_id = __atomic_load_n(&entry->package_id, __ATOMIC_RELAXED);
+        __atomic_thread_fence(__ATOMIC_ACQUIRE);
+        after = __atomic_load_n(&entry->seq, __ATOMIC_RELAXED);
+    } while ((before & 1u) != 0 || before != after);
+
+    return (__atomic_load_n(&entry->present, __ATOMIC_RELAXED) && out->timestamp_ns != 0) ? 0 : -1;
+}
+
+static inline void cfs_close(struct cfs_reader* reader) {
+    if (reader->header != NULL) {
+        munmap((void*)reader->header, reader->size);
+    }
+    memset(reader, 0, sizeof(*reader));
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* CPUFREQ_SHM_H */
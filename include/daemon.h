@@ -0,0 +1,18 @@
+#pragma once
+
+#include <string>
+
+#include "cpufreq_shm.h"
+
+struct DaemonOptions {
+    std::string shm_name = CFS_DEFAULT_NAME;
+    int interval_ms = 10;
+    bool force = false;        // Replace a segment published by a running daemon
+};
+
+// Sample every usable CPU at a fixed rate and publish frequency, temperature
+// and package power into the shared-memory table described in
+// cpufreq_shm.h. Refuses to take over a segment whose daemon is still running
+// unless forced. Runs until SIGINT or SIGTERM, then removes the segment.
+// Returns the process exit code.
+int run_daemon(const DaemonOptions& options);
@@ -0,0 +1,17 @@
+#pragma once
+
+#include <string>
+
+// Where the exporter listens: "unix:/path/to.sock", "PORT" or
+// "localhost:PORT" / "127.0.0.1:PORT". TCP is only ever bound to loopback.
+struct ExporterOptions {
+    std::string listen = "unix:/tmp/cpu_instr_freq.sock";
+    int interval_ms = 1000;
+    double window_sec = 60.0;   // Samples kept per core for the quantiles
+};
+
+// Serve OpenMetrics text over HTTP until SIGINT or SIGTERM. A sampler thread
+// reads the sources and renders the complete exposition into a preallocated
+// buffer after every tick; a scrape only copies the latest rendering, so it
+// never touches sysfs and never allocates. Returns the process exit code.
+int run_exporter(const ExporterOptions& options);
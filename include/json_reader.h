@@ -0,0 +1,45 @@
+#pragma once
+
+#include <istream>
+#include <string>
+#include <utility>
+#include <vector>
+
+// Parsed JSON document, the reading counterpart of JsonWriter. Small and
+// tree based: meant for result files this tool wrote itself, not for
+// arbitrary large inputs. Objects keep their members in file order.
+class JsonValue {
+public:
+    enum class Type { NUL, BOOL, NUMBER, STRING, ARRAY, OBJECT };
+
+    Type type() const { return type_; }
+    bool is_null() const { return type_ == Type::NUL; }
+    bool is_object() const { return type_ == Type::OBJECT; }
+    bool is_array() const { return type_ == Type::ARRAY; }
+
+    // Typed access; throws std::runtime_error on a type mismatch
+    bool as_bool() const;
+    double as_number() const;
+    const std::string& as_string() const;
+    const std::vector<JsonValue>& as_array() const;
+
+    // Object member by name, nullptr if absent or not an object
+    const JsonValue* find(const std::string& name) const;
+    // Object member by name; throws std::runtime_error if absent
+    const JsonValue& at(const std::string& name) const;
+
+    // Parse one complete document. Throws std::runtime_error with the byte
+    // offset of the first error.
+    static JsonValue parse(std::istream& in);
+    static JsonValue parse(const std::string& text);
+
+private:
+    friend class JsonParser;
+
+    Type type_ = Type::NUL;
+    bool bool_ = false;
+    double number_ = 0.0;
+    std::string string_;
+    std::vector<JsonValue> array_;
+    std::vector<std::pair<std::string, JsonValue>> members_;
+};
@@ -0,0 +1,55 @@
+#pragma once
+
+#include <ostream>
+#include <string>
+#include <vector>
+
+// Minimal streaming JSON writer. Values are written straight to the stream,
+// so large documents never have to be built in memory. Commas and nesting
+// are tracked internally; the caller only has to balance begin/end calls.
+class JsonWriter {
+public:
+    explicit JsonWriter(std::ostream& out, bool pretty = true);
+
+    JsonWriter& begin_object();
+    JsonWriter& end_object();
+    // A single-line array keeps all of its elements on one line even in
+    // pretty mode; useful for small tuples such as [time, value]
+    JsonWriter& begin_array(bool single_line = false);
+    JsonWriter& end_array();
+
+    // Name the next value inside an object
+    JsonWriter& key(const std::string& name);
+
+    JsonWriter& value(const std::string& v);
+    JsonWriter& value(const char* v);
+    JsonWriter& value(double v);
+    JsonWriter& value(long long v);
+    JsonWriter& value(unsigned long long v);
+    JsonWriter& value(int v) { return value(static_cast<long long>(v)); }
+    JsonWriter& value(size_t v) { return value(static_cast<unsigned long long>(v)); }
+    JsonWriter& value(bool v);
+    JsonWriter& null();
+
+    // Shorthand for key(name).value(v)
+    template <typename T>
+    JsonWriter& field(const std::string& name, const T& v) {
+        key(name);
+        return value(v);
+    }
+
+private:
+    void before_value();
+    void newline();
+    void write_string(const std::string& s);
+
+    std::ostream& out_;
+    bool pretty_;
+    std::vector<bool> first_;   // Per open container: no element written yet
+    size_t single_line_depth_ = 0; // Depth of the outermost open single-line array, 0 if none
+    bool after_key_ = false;
+};
+
+// Escape s for use between the quotes of a JSON string. Shared by JsonWriter
+// and the printf-style Chrome trace writer, so both produce the same text.
+std::string json_escape(const std::string& s);
@@ -0,0 +1,25 @@
+#pragma once
+
+#include <cstddef>
+
+#include "avx_benchmark.h"
+
+// Benchmark kernels. Each ISA lives in its own translation unit under
+// src/kernels/ and is compiled with only the flags it needs, so nothing
+// outside these files can pick up AVX code by accident.
+extern "C" {
+void benchmark_sse(size_t iterations);
+void benchmark_avx128(size_t iterations);
+void benchmark_avx256(size_t iterations);
+void benchmark_avx512(size_t iterations);
+void benchmark_amx(size_t iterations);
+void benchmark_basic_add(size_t iterations);
+}
+
+// Signature shared by all kernels
+using KernelFn = void (*)(size_t iterations);
+
+// Return the kernel to run for an instruction set on this CPU, or nullptr
+// if the CPU cannot execute it. The table is built once from the cached
+// CPU features.
+KernelFn get_kernel(InstructionSet instr_set);
@@ -0,0 +1,81 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Latest state of one benchmark core. The kernel loop and the frequency
+// monitor of a run publish here with relaxed stores; a live view only loads
+// these, so drawing never touches sysfs and never blocks a benchmark thread.
+struct alignas(64) LiveCoreSlot {
+    std::atomic<int> instr{-1};             // InstructionSet of the running kernel, -1 when idle
+    std::atomic<uint32_t> freq_khz{0};      // Latest monitor sample
+    std::atomic<uint64_t> iterations{0};    // Kernel iterations so far in the current run
+};
+
+// One slot per CPU, each on its own cache line
+class LiveBoard {
+public:
+    explicit LiveBoard(const std::vector<int>& cpus);
+
+    const std::vector<int>& cpus() const { return cpus_; }
+    LiveCoreSlot* slot(int cpu);             // nullptr if the CPU is not on the board
+    const LiveCoreSlot& slot_at(size_t index) const { return slots_[index]; }
+
+private:
+    std::vector<int> cpus_;
+    std::unique_ptr<LiveCoreSlot[]> slots_;
+    std::map<int, size_t> index_of_cpu_;
+};
+
+// Full-screen dashboard drawn from a LiveBoard at a fixed rate: a frequency
+// heat map with one cell per core, then frequency and throughput per running
+// kernel. Each frame is diffed against the previous one and only changed
+// cells and lines are sent, in a single write().
+class LiveView {
+public:
+    LiveView(const LiveBoard& board, int refresh_ms);
+    ~LiveView();
+
+    LiveView(const LiveView&) = delete;
+    LiveView& operator=(const LiveView&) = delete;
+
+    // Switch to the alternate screen and start drawing; false if stdout is not a terminal.
+    // SIGINT/SIGTERM are caught while the view runs: the screen is restored
+    // first, then the signal ends the process as usual. The layout follows
+    // SIGWINCH.
+    bool start();
+    // Stop drawing and restore the screen
+    void stop();
+
+private:
+    void run();
+    void layout();
+    void restore_screen();
+    void render_frame(double elapsed_sec, double frame_sec);
+    void put_line(int row, const std::string& text);
+
+    const LiveBoard& board_;
+    int refresh_ms_;
+    int columns_ = 80;
+    int cells_per_row_ = 64;
+
+    std::thread thread_;
+    std::atomic<bool> running_{false};
+    std::atomic<bool> screen_active_{false}; // On the alternate screen
+
+    // Previous frame, for differential updates
+    std::vector<int> prev_cells_;            // Palette index per core, -2 before the first frame
+    std::vector<std::string> prev_lines_;    // Text lines below the heat map, by row
+    std::vector<uint64_t> prev_iterations_;
+    std::vector<double> rates_;              // Iterations per second per core
+    double max_khz_seen_ = 0.0;
+
+    std::string frame_;                      // Reused output buffer
+    double last_render_us_ = 0.0;
+    size_t last_frame_bytes_ = 0;
+};
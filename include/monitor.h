@@ -0,0 +1,40 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+enum class TraceFormat {
+    CSV,
+    BINARY,
+    CHROME      // Chrome trace-event JSON: frequency and package power counter tracks
+};
+
+struct MonitorOptions {
+    std::vector<int> cpus;        // Empty: every benchmark CPU
+    int interval_ms = 1000;
+    TraceFormat format = TraceFormat::CSV;
+    std::string output_path;      // Empty: cpu_frequencies_<date>_<time>.csv/.bin/.json
+    uint64_t rotate_bytes = 0;    // Start a new file after this many bytes, 0 to disable
+    int rotate_sec = 0;           // Start a new file after this many seconds, 0 to disable
+};
+
+// Binary trace layout (native byte order, packed). Every file, including
+// each rotated one, starts with this header followed by cpu_count uint32_t CPU
+// ids; then one record per tick: uint64_t monotonic timestamp in ns followed
+// by cpu_count uint32_t frequencies in kHz (0 when unreadable).
+struct TraceFileHeader {
+    char magic[8];                // "CIFTRACE"
+    uint32_t version;             // 1
+    uint32_t cpu_count;
+    uint64_t interval_ns;
+    int64_t start_realtime_ns;    // CLOCK_REALTIME when the file was opened
+    uint64_t start_monotonic_ns;  // CLOCK_MONOTONIC at the same moment
+};
+
+// Record CPU frequencies continuously until SIGINT or SIGTERM. Frequencies are
+// read through cached descriptors; rows go to a large buffer that is written
+// out when full or once a second. Returns the process exit code.
+int run_monitor(const MonitorOptions& options);
+
+TraceFormat string_to_trace_format(const std::string& name);   // Throws std::invalid_argument
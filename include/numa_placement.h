@@ -0,0 +1,114 @@
+#pragma once
+
+#include <cstddef>
+#include <cstring>
+#include <map>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+// Where a benchmark worker's memory is placed relative to its CPU
+enum class MemoryPlacement {
+    LOCAL,     // The node of the benchmark CPU (the default)
+    REMOTE     // The nearest other node, to measure cross-node cost
+};
+
+MemoryPlacement string_to_memory_placement(const std::string& str); // Throws std::invalid_argument
+std::string get_memory_placement_name(MemoryPlacement placement);
+
+// Online NUMA nodes from /sys/devices/system/node/online; {0} without NUMA
+std::vector<int> get_numa_nodes();
+
+// Node of a CPU from its cpuN/nodeM link; 0 without NUMA
+int get_cpu_node(int cpu);
+
+// Node the placement asks for when benchmarking cpu. REMOTE picks the other
+// node with the smallest SLIT distance; -1 if there is no other node.
+int choose_memory_node(int cpu, MemoryPlacement placement);
+
+// Bind every page the calling thread faults in from now on to node, using
+// set_mempolicy(MPOL_BIND). Threads it creates afterwards inherit the
+// binding. node < 0 restores the default first-touch policy. False if the
+// kernel refused.
+bool bind_thread_memory(int node);
+
+// Anonymous mapping whose pages are bound to one node with
+// mbind(MPOL_BIND, MPOL_MF_MOVE | MPOL_MF_STRICT) and faulted in right away,
+// so the placement does not depend on which heap pages malloc reuses
+class NodeBuffer {
+public:
+    NodeBuffer() = default;
+    ~NodeBuffer();
+    NodeBuffer(NodeBuffer&& other) noexcept;
+    NodeBuffer& operator=(NodeBuffer&& other) noexcept;
+    NodeBuffer(const NodeBuffer&) = delete;
+    NodeBuffer& operator=(const NodeBuffer&) = delete;
+
+    // Map at least bytes (rounded up to whole pages), bind them to node and
+    // touch every page. node < 0 leaves placement to first touch by the
+    // calling thread. False if the mapping fails; a refused binding is not an
+    // error, page_nodes() shows where the pages went.
+    bool allocate(size_t bytes, int node);
+
+    void* data() const { return data_; }
+    size_t size() const { return size_; }
+
+    // Pages per node, from move_pages() over every page of the mapping; -1
+    // counts pages whose node the kernel could not report
+    std::map<int, size_t> page_nodes() const;
+
+private:
+    void release();
+
+    void* data_ = nullptr;
+    size_t size_ = 0;
+};
+
+// Append-only array of trivially copyable values in a NodeBuffer. Growing
+// maps a larger buffer on the same node and copies, so every element stays
+// on the node it was created for.
+template <typename T>
+class NodeArray {
+    static_assert(std::is_trivially_copyable<T>::value, "NodeArray holds raw bytes");
+
+public:
+    explicit NodeArray(int node = -1) : node_(node) {}
+
+    bool reserve(size_t capacity) {
+        if (capacity <= capacity_) {
+            return true;
+        }
+        NodeBuffer bigger;
+        if (!bigger.allocate(capacity * sizeof(T), node_)) {
+            return false;
+        }
+        if (size_ > 0) {
+            memcpy(bigger.data(), buffer_.data(), size_ * sizeof(T));
+        }
+        buffer_ = std::move(bigger);
+        capacity_ = buffer_.size() / sizeof(T);
+        return true;
+    }
+
+    // False only if the array was full and could not grow
+    bool push_back(const T& value) {
+        if (size_ == capacity_ && !reserve(capacity_ > 0 ? capacity_ * 2 : 64)) {
+            return false;
+        }
+        data()[size_++] = value;
+        return true;
+    }
+
+    T* data() const { return static_cast<T*>(buffer_.data()); }
+    size_t size() const { return size_; }
+    const T* begin() const { return data(); }
+    const T* end() const { return data() + size_; }
+    const NodeBuffer& buffer() const { return buffer_; }
+
+private:
+    int node_;
+    NodeBuffer buffer_;
+    size_t size_ = 0;
+    size_t capacity_ = 0;
+};
@@ -0,0 +1,32 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include "avx_benchmark.h"
+
+// One run of the observer-overhead measurement: a kernel either unobserved
+// (interval_ms == 0) or with the frequency monitor sampling at interval_ms
+struct OverheadPoint {
+    InstructionSet instr_set;
+    int interval_ms = 0;
+    BenchmarkResult result;
+    double throughput = 0.0;        // Kernel iterations per second
+};
+
+// Run each ISA on one core with sampling disabled, then once per sampling
+// interval. The monitor thread shares the benchmark core, so any throughput it
+// steals shows up against the unobserved run.
+std::vector<OverheadPoint> run_observer_overhead(const std::vector<InstructionSet>& instr_sets,
+                                                 const std::vector<int>& intervals_ms,
+                                                 const BenchmarkOptions& options,
+                                                 int core_id,
+                                                 int cooldown_sec);
+
+// Parse a comma-separated list of sampling intervals in ms such as
+// "1,10,100". Throws std::invalid_argument on malformed or non-positive values.
+std::vector<int> parse_interval_list(const std::string& list);
+
+// Print throughput loss against the unobserved run, frequency against the
+// least frequently sampled run, and the sampler's own CPU and runqueue time
+void print_observer_overhead(const std::vector<OverheadPoint>& points);
@@ -0,0 +1,72 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <thread>
+#include <vector>
+
+#include "cpufreq_probe.h"
+#include "probe/sources.h"
+
+namespace cfp {
+
+// Background sampler behind the C API. One thread reads every selected CPU
+// per tick and publishes into per-CPU slots guarded by a seqlock, so readers
+// never block the sampler and never take a lock.
+class Sampler {
+public:
+    Sampler() = default;
+    ~Sampler();
+    Sampler(const Sampler&) = delete;
+    Sampler& operator=(const Sampler&) = delete;
+
+    // Open the sources. Returns a CFP_* code.
+    int open(const cfp_options& options);
+    int start();
+    int stop();
+
+    // Copy the latest sample of a CPU. Returns a CFP_* code.
+    int read(int cpu, cfp_sample& out) const;
+
+    const std::vector<int>& cpus() const { return cpus_; }
+    uint32_t interval_us() const { return interval_us_; }
+
+private:
+    // One cache line per CPU so the sampler's writes do not bounce readers of
+    // other CPUs
+    struct alignas(64) Slot {
+        std::atomic<uint32_t> seq{0};
+        std::atomic<uint64_t> timestamp_ns{0};
+        std::atomic<uint32_t> freq_khz{0};
+        std::atomic<uint64_t> sequence{0};
+    };
+
+    void run();
+    void sample_once();
+    void publish(size_t index, uint64_t timestamp_ns, uint32_t khz);
+
+    cfp_source source_ = CFP_SOURCE_AUTO;
+    uint32_t interval_us_ = 100000;
+    int sampler_cpu_ = -1;
+
+    std::vector<int> cpus_;
+    std::vector<int> slot_of_cpu_;            // CPU id -> slot index, -1 if not sampled
+    std::unique_ptr<Slot[]> slots_;
+    std::vector<SysfsFreqFile> sysfs_files_;  // Per slot; closed when the CPU uses cpuinfo
+    CpuinfoFreqReader cpuinfo_;
+    std::vector<uint32_t> cpuinfo_khz_;
+    bool need_cpuinfo_ = false;
+
+    std::thread thread_;
+    std::mutex mutex_;
+    std::condition_variable cv_;
+    bool running_ = false;
+    bool stop_requested_ = false;
+    std::optional<FsRootUse> root_use_;      // Held while the thread runs
+};
+
+} // namespace cfp
@@ -0,0 +1,203 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Frequency sources shared by the cpufreq_probe library and the CLI. None of
+// these print or exit; failures are reported through return values.
+namespace cfp {
+
+// Prefix for every sysfs and procfs path the sources open. Empty (the
+// default) reads the live system; a directory holding the same layout, such
+// as a synthetic tree, is read instead. Set it before opening any source.
+// While an FsRootUse exists the root is frozen: set_fs_root() leaves it
+// unchanged and returns false, unless the new root is the current one.
+bool set_fs_root(const std::string& root);
+std::string fs_root();
+std::string fs_path(const std::string& path);
+
+// Freezes the fs root for its lifetime. Held by whatever resolves paths from
+// a background thread or a long-running loop: a started Sampler, the daemon,
+// the exporter and the monitor.
+class FsRootUse {
+public:
+    FsRootUse();
+    ~FsRootUse();
+    FsRootUse(const FsRootUse&) = delete;
+    FsRootUse& operator=(const FsRootUse&) = delete;
+};
+
+// CLOCK_MONOTONIC in nanoseconds
+uint64_t monotonic_ns();
+
+// Fixed-rate schedule for the sampling loops. Deadlines are absolute, so the
+// rate does not drift with the cost of each tick; when a tick overruns, the
+// deadlines that already passed are skipped instead of run back to back.
+class TickSchedule {
+public:
+    explicit TickSchedule(uint64_t interval_ns);
+
+    // Sleep until the next deadline and return how many were skipped. A
+    // signal ends the sleep early so the caller can check for a stop.
+    uint64_t wait();
+    uint64_t skipped() const { return skipped_; }
+
+private:
+    uint64_t interval_ns_;
+    uint64_t next_ns_;
+    uint64_t skipped_ = 0;
+};
+
+// Pin the calling thread to one CPU. Any id the kernel accepts works; the
+// mask is allocated for the id instead of using a fixed cpu_set_t.
+bool pin_thread_to_cpu(int cpu);
+
+// Sorted CPU ids in the calling thread's affinity mask, empty on failure
+std::vector<int> thread_affinity();
+
+// Largest CPU id a CPU list may name. Far above any kernel's NR_CPUS, but
+// it keeps a range such as "0-2000000000" from allocating gigabytes.
+constexpr long kMaxCpuId = (1L << 20) - 1;
+
+// Parse a kernel CPU list such as "0-3,8,10-11" into sorted, unique ids.
+// Blanks, a trailing newline and empty items are ignored, so an empty list
+// parses to no CPUs. False on malformed input or an id above kMaxCpuId.
+bool parse_cpu_list(const std::string& text, std::vector<int>& cpus);
+
+// Online CPU ids from /sys/devices/system/cpu/online (below fs_root()). Ids
+// can be sparse. Falls back to the cpuN directories of a synthetic tree, or
+// to 0..N-1 from sysconf on the live system.
+std::vector<int> online_cpus();
+int online_cpu_count();
+
+// One-shot reads that open and close the file each time. Return 0.0 when the
+// value is not available.
+double read_cpuinfo_mhz(int cpu);
+double read_sysfs_mhz(int cpu);
+
+// scaling_cur_freq of one CPU behind a descriptor that stays open, so each
+// sample costs one pread()
+class SysfsFreqFile {
+public:
+    SysfsFreqFile() = default;
+    ~SysfsFreqFile();
+    SysfsFreqFile(const SysfsFreqFile&) = delete;
+    SysfsFreqFile& operator=(const SysfsFreqFile&) = delete;
+    SysfsFreqFile(SysfsFreqFile&& other) noexcept;
+    SysfsFreqFile& operator=(SysfsFreqFile&& other) noexcept;
+
+    bool open(int cpu);
+    bool is_open() const { return fd_ >= 0; }
+    bool read_khz(uint32_t& khz) const;
+
+private:
+    int fd_ = -1;
+};
+
+// /proc/cpuinfo behind a descriptor that stays open. One read() pass yields
+// the "cpu MHz" value of every CPU.
+class CpuinfoFreqReader {
+public:
+    CpuinfoFreqReader() = default;
+    ~CpuinfoFreqReader();
+    CpuinfoFreqReader(const CpuinfoFreqReader&) = delete;
+    CpuinfoFreqReader& operator=(const CpuinfoFreqReader&) = delete;
+
+    bool open();
+    bool is_open() const { return fd_ >= 0; }
+
+    // Fill khz_by_cpu (indexed by CPU id, 0 when missing)
+    bool read_all_khz(std::vector<uint32_t>& khz_by_cpu);
+
+private:
+    int fd_ = -1;
+    std::string buffer_;
+};
+
+// RAPL package energy counter (/sys/class/powercap/intel-rapl:N/energy_uj)
+// behind a cached descriptor. Turns successive readings into average power,
+// handling counter wrap-around.
+class RaplPackagePower {
+public:
+    RaplPackagePower() = default;
+    ~RaplPackagePower();
+    RaplPackagePower(const RaplPackagePower&) = delete;
+    RaplPackagePower& operator=(const RaplPackagePower&) = delete;
+    RaplPackagePower(RaplPackagePower&& other) noexcept;
+
+    bool open(int package_id);
+    bool is_open() const { return fd_ >= 0; }
+
+    // Average power in milliwatts since the previous call; false on the
+    // first call, on read failure, or when the counter wrapped and its range
+    // is unknown. Saturates below UINT32_MAX.
+    bool read_power_mw(uint64_t timestamp_ns, uint32_t& milliwatts);
+
+    // Raw counter value and its wrap-around range (0 if unknown)
+    bool read_energy_uj(uint64_t& energy_uj) const;
+    uint64_t max_energy_uj() const { return max_energy_uj_; }
+
+private:
+    int fd_ = -1;
+    uint64_t max_energy_uj_ = 0;
+    uint64_t last_energy_uj_ = 0;
+    uint64_t last_timestamp_ns_ = 0;
+    bool have_last_ = false;
+};
+
+// Energy consumed between two readings of a RAPL counter that wraps at
+// max_energy_uj. False if the counter went backwards and the range is unknown
+// (0) or does not fit the readings.
+bool rapl_energy_delta_uj(uint64_t previous_uj, uint64_t current_uj, uint64_t max_energy_uj, uint64_t& delta_uj);
+
+// Temperatures from the coretemp hwmon driver: one sensor per physical core
+// plus one per package, all behind cached descriptors
+class CoreTemperatures {
+public:
+    CoreTemperatures() = default;
+    ~CoreTemperatures();
+    CoreTemperatures(const CoreTemperatures&) = delete;
+    CoreTemperatures& operator=(const CoreTemperatures&) = delete;
+
+    // Discover every coretemp sensor. False if there are none.
+    bool open();
+
+    // Millidegrees Celsius of a physical core, falling back to its package.
+    // False if neither is available.
+    bool read_mdegc(int package_id, int core_id, int32_t& mdegc) const;
+
+private:
+    struct Sensor {
+        int package_id;
+        int core_id;     // -1 for the package sensor
+        int fd;
+    };
+    std::vector<Sensor> sensors_;
+};
+
+// Thermal throttle event counters of one CPU
+// (/sys/devices/system/cpu/cpuN/thermal_throttle/{core,package}_throttle_count)
+// behind cached descriptors. Either counter may be missing.
+class ThermalThrottleCounters {
+public:
+    ThermalThrottleCounters() = default;
+    ~ThermalThrottleCounters();
+    ThermalThrottleCounters(const ThermalThrottleCounters&) = delete;
+    ThermalThrottleCounters& operator=(const ThermalThrottleCounters&) = delete;
+    ThermalThrottleCounters(ThermalThrottleCounters&& other) noexcept;
+
+    // False if neither counter exists
+    bool open(int cpu);
+    bool has_core() const { return core_fd_ >= 0; }
+    bool has_package() const { return package_fd_ >= 0; }
+
+    bool read_core(uint64_t& count) const;
+    bool read_package(uint64_t& count) const;
+
+private:
+    int core_fd_ = -1;
+    int package_fd_ = -1;
+};
+
+} // namespace cfp
@@ -0,0 +1,100 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Event-driven frequency capture from the power:cpu_frequency and
+// power:cpu_idle tracepoints. Events are decoded straight from the per-CPU
+// ring-buffer pages in tracefs (per_cpu/cpuN/trace_pipe_raw), so nothing is
+// polled while the frequency is stable.
+namespace cfp {
+
+struct TraceEvent {
+    enum Kind : uint8_t {
+        FREQUENCY,   // value: new frequency in kHz
+        IDLE         // value: idle state entered, kIdleExit when leaving idle
+    };
+
+    uint64_t timestamp_ns;   // Trace clock (CLOCK_MONOTONIC when the source set it to "mono")
+    uint32_t cpu;            // CPU the event is about (cpu_id field)
+    uint32_t value;
+    Kind kind;
+};
+
+constexpr uint32_t kIdleExit = 0xFFFFFFFFu;   // PWR_EVENT_EXIT
+
+struct TracepointOptions {
+    // Empty: /sys/kernel/tracing, then /sys/kernel/debug/tracing, under
+    // cfp::fs_root(). Any other directory with the same layout (events/,
+    // per_cpu/) works; if it is not a mounted tracefs it is replayed as
+    // captured buffers and left untouched.
+    std::string tracefs_root;
+    bool idle_events = true;
+};
+
+class TracepointSource {
+public:
+    TracepointSource() = default;
+    ~TracepointSource();
+    TracepointSource(const TracepointSource&) = delete;
+    TracepointSource& operator=(const TracepointSource&) = delete;
+
+    // Resolve event ids and layouts, open the per-CPU buffers of `cpus`
+    // (all present when empty) and, on a live tracefs, switch the trace clock
+    // to "mono" and enable the events. On failure returns false and sets error.
+    bool open(const TracepointOptions& options, const std::vector<int>& cpus, std::string& error);
+
+    // Disable the events and restore the trace clock if open() changed them
+    void close();
+
+    // Wait up to timeout_ms for the kernel's buffer_percent watermark, then
+    // append every event that is available. Timestamps come from the ring
+    // buffer, so batching delays delivery but not accuracy. Returns false
+    // once a replayed capture is exhausted or on error.
+    bool read(std::vector<TraceEvent>& out, int timeout_ms);
+
+    bool is_live() const { return live_; }
+    const std::string& root() const { return root_; }
+    const std::string& clock() const { return clock_; }
+    uint64_t lost_events() const { return lost_events_; }
+
+private:
+    struct CpuBuffer {
+        int cpu;
+        int fd;
+        bool exhausted;
+    };
+
+    struct EventLayout {
+        int id = -1;
+        uint32_t state_offset = 0;
+        uint32_t cpu_offset = 0;
+    };
+
+    bool load_layout(const std::string& event, EventLayout& layout, std::string& error) const;
+    bool set_event_enabled(const std::string& event, bool enabled) const;
+    void decode_page(const uint8_t* page, size_t length, std::vector<TraceEvent>& out);
+    void decode_record(const uint8_t* data, size_t length, uint64_t timestamp, std::vector<TraceEvent>& out) const;
+
+    std::string root_;
+    bool live_ = false;
+    bool idle_events_ = true;
+    std::string clock_;
+    std::string saved_clock_;
+    bool enabled_frequency_ = false;
+    bool enabled_idle_ = false;
+
+    EventLayout frequency_;
+    EventLayout idle_;
+    size_t page_size_ = 4096;
+    size_t commit_offset_ = 8;
+    size_t commit_size_ = 8;
+    size_t data_offset_ = 16;
+
+    std::vector<CpuBuffer> buffers_;
+    std::vector<uint8_t> page_;
+    uint64_t lost_events_ = 0;
+};
+
+} // namespace cfp
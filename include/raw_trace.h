@@ -0,0 +1,56 @@
+#pragma once
+
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <vector>
+
+#include "avx_benchmark.h"
+
+struct RawFrequencyReading {
+    double time_sec;     // Seconds since the monitor started
+    double mhz;          // Value as returned by the frequency source
+};
+
+struct RawEnergyReading {
+    double time_sec;     // Same time base as the frequency readings
+    uint64_t energy_uj;  // RAPL package counter, not yet unwrapped
+};
+
+// Everything one benchmark run read, before any statistics. Filled by
+// run_benchmark_with_result() when BenchmarkOptions::raw_trace points here.
+struct RawTrace {
+    InstructionSet instr_set = InstructionSet::AVX256;
+    int core_id = 0;
+    BenchmarkOptions options;          // Barrier and recorder pointers are cleared
+    double tsc_hz = 0.0;
+    size_t batch_iterations = 0;
+    unsigned long long start_tsc = 0;
+    unsigned long long deadline_tsc = 0;
+    uint64_t max_energy_uj = 0;        // RAPL counter range, 0 if unknown
+
+    std::vector<RawFrequencyReading> frequencies;
+    std::vector<RawEnergyReading> energy;
+    std::vector<unsigned long long> batch_end_tsc;   // TSC after every kernel batch
+};
+
+// Text format, one reading per line; throws std::runtime_error on I/O failure
+void save_raw_trace(const std::string& path, const RawTrace& trace);
+
+// Throws std::runtime_error naming file and line on malformed input
+RawTrace load_raw_trace(const std::string& path);
+
+// Rebuild the BenchmarkResult of a recorded run from its raw readings,
+// through the same statistics as a live run. Runs as fast as it can read.
+BenchmarkResult replay_raw_trace(const RawTrace& trace);
+
+// Mean package power over energy readings, -1 with fewer than two
+double average_package_power_w(const std::vector<RawEnergyReading>& energy, uint64_t max_energy_uj);
+
+// Power of each interval between consecutive energy readings, stamped at the
+// interval's end. Intervals across a wrap of unknown range are left out.
+void package_power_series(const std::vector<RawEnergyReading>& energy, uint64_t max_energy_uj,
+                          std::vector<double>& times, std::vector<double>& watts);
+
+// JSON result of a replayed trace: its options and the rebuilt per-core result
+void write_replay_report(std::ostream& out, const RawTrace& trace, const BenchmarkResult& result);
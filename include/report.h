@@ -0,0 +1,22 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include "avx_benchmark.h"
+#include "json_writer.h"
+
+// Structured (JSON) output shared by every mode that writes a result file.
+// Each helper writes one complete JSON value at the writer's position.
+
+// Host description: CPU model, CPU count and detected features
+void write_host_json(JsonWriter& json);
+
+// One per-core run, including the timestamped frequency samples
+void write_benchmark_result_json(JsonWriter& json, InstructionSet instr_set, const BenchmarkResult& result);
+
+// Aggregate of several cores that ran together
+void write_summary_json(JsonWriter& json, const ResultSummary& summary);
+
+// The subset of options that defines how a run was measured
+void write_options_json(JsonWriter& json, const BenchmarkOptions& options);
@@ -0,0 +1,52 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <vector>
+
+// Fixed-capacity ring of recent samples. Storage is allocated once; when full,
+// push() overwrites the oldest sample. Not thread-safe: owned by whichever
+// thread samples.
+template <typename T>
+class SampleRing {
+public:
+    SampleRing() = default;
+    explicit SampleRing(size_t capacity) : data_(std::max<size_t>(capacity, 1)) {}
+
+    size_t capacity() const { return data_.size(); }
+    size_t size() const { return size_; }
+    bool empty() const { return size_ == 0; }
+
+    void push(const T& value) {
+        data_[next_] = value;
+        next_ = next_ + 1 == data_.size() ? 0 : next_ + 1;
+        if (size_ < data_.size()) {
+            size_++;
+        }
+    }
+
+    // Remove the oldest sample; false if the ring is empty
+    bool pop(T& value) {
+        if (size_ == 0) {
+            return false;
+        }
+        size_t oldest = next_ >= size_ ? next_ - size_ : next_ + data_.size() - size_;
+        value = data_[oldest];
+        size_--;
+        return true;
+    }
+
+    // Copy the held samples to out, oldest first; returns how many
+    size_t copy_to(T* out) const {
+        size_t oldest = next_ >= size_ ? next_ - size_ : next_ + data_.size() - size_;
+        size_t first = std::min(size_, data_.size() - oldest);
+        std::copy(data_.begin() + oldest, data_.begin() + oldest + first, out);
+        std::copy(data_.begin(), data_.begin() + (size_ - first), out + first);
+        return size_;
+    }
+
+private:
+    std::vector<T> data_;
+    size_t next_ = 0;    // Slot the next push writes
+    size_t size_ = 0;
+};
@@ -0,0 +1,34 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include "avx_benchmark.h"
+#include "worker_pool.h"
+
+// A set of CPUs that all run the same kernel
+struct WorkloadGroup {
+    InstructionSet instr_set;
+    std::vector<int> cpus;
+};
+
+// Parse "ISA:CPULIST", for example "avx512:0-15" or "basic_add:16-31,48".
+// Throws std::invalid_argument on malformed input.
+WorkloadGroup parse_workload_group(const std::string& spec);
+
+// Outcome of one group: alone on the machine, and next to all other groups
+struct GroupOutcome {
+    WorkloadGroup group;
+    ResultSummary alone;
+    ResultSummary mixed;
+};
+
+// Run each group alone as a baseline, then all groups at once with a
+// synchronized start. Groups must not share CPUs.
+std::vector<GroupOutcome> run_mixed_workload(WorkerPool& pool,
+                                             const std::vector<WorkloadGroup>& groups,
+                                             const BenchmarkOptions& options,
+                                             int cooldown_sec);
+
+// Print per-group frequency and throughput, mixed versus alone
+void print_mixed_workload(const std::vector<GroupOutcome>& outcomes);
@@ -0,0 +1,58 @@
+#pragma once
+
+#include <ostream>
+#include <string>
+#include <vector>
+
+#include "avx_benchmark.h"
+#include "scenario.h"
+#include "worker_pool.h"
+
+// One phase of a scenario: which kernel runs on which CPUs, how long and how
+// it is sampled, and how long to idle afterwards
+struct ScenarioPhase {
+    std::string name;
+    std::vector<WorkloadGroup> groups;
+    BenchmarkOptions options;
+    int cooldown_sec = 0;
+};
+
+// A multi-phase benchmark plan loaded from a scenario file.
+//
+// The format is line based. '#' starts a comment. "[phase NAME]" opens a
+// phase; "key = value" lines before the first phase (or in a "[defaults]"
+// section) set defaults for the phases that follow. Keys:
+//
+//   group    = ISA:CPULIST       (repeatable, at least one per phase)
+//   duration = SECONDS | adaptive
+//   min_time = SECONDS           (adaptive bounds)
+//   max_time = SECONDS
+//   ci       = MHZ               (adaptive CI target)
+//   source   = auto | cpuinfo | sysfs
+//   rate_ms  = MILLISECONDS      (sampling interval)
+//   cooldown = SECONDS           (idle time after the phase)
+//
+// duration, rate_ms and cooldown take whole numbers.
+struct Scenario {
+    std::string path;
+    std::vector<ScenarioPhase> phases;
+};
+
+// Parse a scenario file. Throws std::runtime_error naming the file and line
+// on any error.
+Scenario load_scenario_file(const std::string& path);
+
+// Every CPU used by any phase, sorted
+std::vector<int> scenario_cpus(const Scenario& scenario);
+
+// Results of one executed phase, in assignment order
+struct PhaseResult {
+    std::vector<CoreAssignment> assignments;
+    std::vector<BenchmarkResult> results;
+};
+
+// Execute all phases in order on the pool
+std::vector<PhaseResult> run_scenario(WorkerPool& pool, const Scenario& scenario);
+
+// Write the whole run as one JSON document
+void write_scenario_report(std::ostream& out, const Scenario& scenario, const std::vector<PhaseResult>& phase_results);
@@ -0,0 +1,60 @@
+#pragma once
+
+#include <ostream>
+#include <string>
+#include <vector>
+
+#include "avx_benchmark.h"
+#include "topology.h"
+#include "worker_pool.h"
+
+// How kernels are placed on the hyperthreads of each physical core
+enum class SmtPolicy {
+    ONE_PER_CORE,   // First thread of every core runs the primary kernel, siblings idle
+    SAME_KERNEL,    // Every thread of every core runs the primary kernel
+    MIXED_KERNELS   // First thread runs the primary kernel, its siblings the secondary one
+};
+
+// Primary and secondary kernels and the policies to compare
+struct SmtOptions {
+    InstructionSet primary = InstructionSet::AVX512;
+    InstructionSet secondary = InstructionSet::BASIC_ADD;
+    std::vector<SmtPolicy> policies;
+    BenchmarkOptions options;
+    int cooldown_sec = 0;           // Idle time between policies
+};
+
+// One physical core under one policy. threads and results are in the same
+// order, first hyperthread first.
+struct SmtCore {
+    int package_id = 0;
+    int core_id = 0;
+    std::vector<CoreAssignment> threads;
+    std::vector<BenchmarkResult> results;
+};
+
+struct SmtRun {
+    SmtPolicy policy;
+    std::vector<SmtCore> cores;
+};
+
+// Parse "one-per-core,same,mixed". Throws std::invalid_argument.
+std::vector<SmtPolicy> parse_smt_policy_list(const std::string& list);
+
+std::string get_smt_policy_name(SmtPolicy policy);
+
+// Physical cores of the pool with at least two usable hyperthreads, each as
+// its CPUs in sibling order. Cores without a usable sibling cannot show SMT
+// effects and are left out of every policy.
+std::vector<std::vector<CpuTopology>> find_smt_cores(const WorkerPool& pool);
+
+// Run each policy on all SMT cores at once, released by a spin barrier.
+// Empty if the pool has no SMT core.
+std::vector<SmtRun> run_smt_experiment(WorkerPool& pool, const SmtOptions& smt);
+
+// Per-thread and per-core frequency and throughput, then one summary line per
+// policy with the primary kernel's per-core throughput relative to one-per-core
+void print_smt_report(const SmtOptions& smt, const std::vector<SmtRun>& runs);
+
+// The whole experiment as one JSON document
+void write_smt_report(std::ostream& out, const SmtOptions& smt, const std::vector<SmtRun>& runs);
@@ -0,0 +1,50 @@
+#pragma once
+
+#include <atomic>
+#include <thread>
+
+#if defined(__x86_64__) || defined(__i386)
+#include <immintrin.h>
+#endif
+
+// Reusable barrier that busy-waits instead of sleeping, so all waiters are
+// released within the cache-line transfer latency of each other. Only use it
+// when every participant has a core of its own.
+class SpinBarrier {
+public:
+    explicit SpinBarrier(int count) : count_(count) {}
+
+    SpinBarrier(const SpinBarrier&) = delete;
+    SpinBarrier& operator=(const SpinBarrier&) = delete;
+
+    void arrive_and_wait() {
+        int generation = generation_.load(std::memory_order_acquire);
+
+        if (waiting_.fetch_add(1, std::memory_order_acq_rel) == count_ - 1) {
+            // Last to arrive: reset and release everyone
+            waiting_.store(0, std::memory_order_relaxed);
+            generation_.fetch_add(1, std::memory_order_release);
+            return;
+        }
+
+        unsigned long spins = 0;
+        while (generation_.load(std::memory_order_acquire) == generation) {
+            cpu_relax();
+            // Back off if we are sharing a core with another participant
+            if (++spins % (1UL << 20) == 0) {
+                std::this_thread::yield();
+            }
+        }
+    }
+
+private:
+    static void cpu_relax() {
+#if defined(__x86_64__) || defined(__i386)
+        _mm_pause();
+#endif
+    }
+
+    const int count_;
+    std::atomic<int> waiting_{0};
+    std::atomic<int> generation_{0};
+};
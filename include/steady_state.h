@@ -0,0 +1,78 @@
+#pragma once
+
+#include <cstddef>
+#include <deque>
+#include <string>
+#include <vector>
+
+// Phases of a benchmark run as seen from the frequency sample stream
+enum class RunPhase {
+    WARMUP,      // Frequency still moving (turbo ramp, initial transients)
+    STEADY,      // Frequency settled within tolerance
+    THROTTLING   // Sustained drop below the previous steady level
+};
+
+// Tuning for adaptive run duration
+struct SteadyStateOptions {
+    double min_sec = 2.0;              // Never stop before this
+    double max_sec = 60.0;             // Always stop at this
+    double ci_target_mhz = 5.0;        // Stop once the 95% CI half-width of the steady mean is below this
+    size_t window = 10;                // Samples in the rolling stability window
+    double stable_tolerance = 0.01;    // Max relative spread of the window to call it stable
+    double throttle_drop = 0.03;       // Relative drop below the steady mean that counts as throttling
+    size_t throttle_samples = 3;       // Consecutive low samples needed to enter THROTTLING
+};
+
+// A contiguous span of one phase, in seconds since the first sample
+struct PhaseSpan {
+    RunPhase phase;
+    double start_sec;
+    double end_sec;
+};
+
+// Online phase detector. Feed samples as they arrive; it tracks the current
+// phase and the running mean of the latest steady phase. Not thread-safe:
+// owned by the monitor thread while the benchmark runs.
+class SteadyStateDetector {
+public:
+    explicit SteadyStateDetector(const SteadyStateOptions& options);
+
+    void add_sample(double time_sec, double freq_mhz);
+
+    RunPhase phase() const { return phase_; }
+
+    // True when the steady mean is known to within ci_target_mhz
+    bool converged() const;
+
+    double steady_mean() const { return steady_mean_; }
+    double ci_half_width() const;
+    size_t steady_samples() const { return steady_count_; }
+    double warmup_sec() const { return warmup_sec_; }  // -1 if never settled
+    int throttle_events() const { return throttle_events_; }
+
+    // All phases seen so far, the last one still open
+    std::vector<PhaseSpan> phases() const;
+
+private:
+    void enter_phase(RunPhase phase, double time_sec);
+    bool window_stable() const;
+    void reset_steady_stats();
+    void add_steady_sample(double freq_mhz);
+
+    SteadyStateOptions options_;
+    RunPhase phase_ = RunPhase::WARMUP;
+    std::deque<double> window_;
+    std::vector<PhaseSpan> closed_phases_;
+    double phase_start_sec_ = 0.0;
+    double last_time_sec_ = 0.0;
+    double warmup_sec_ = -1.0;
+    int throttle_events_ = 0;
+    size_t low_run_ = 0;
+
+    // Welford accumulators for the current steady phase
+    size_t steady_count_ = 0;
+    double steady_mean_ = 0.0;
+    double steady_m2_ = 0.0;
+};
+
+std::string run_phase_name(RunPhase phase);
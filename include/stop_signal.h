@@ -0,0 +1,12 @@
+#pragma once
+
+// SIGINT/SIGTERM handling for the long-running modes (daemon, exporter,
+// monitor) and the live view. The handler only sets a flag; loops poll
+// stop_requested().
+void install_stop_handlers();
+bool stop_requested();
+
+// Put SIGINT/SIGTERM back to their default action. If one arrived while the
+// handlers were installed, it is raised again so the process ends the way
+// it would have without them.
+void restore_stop_handlers();
@@ -0,0 +1,50 @@
+#pragma once
+
+#include <ostream>
+#include <string>
+#include <vector>
+
+#include "avx_benchmark.h"
+#include "worker_pool.h"
+
+// How the CPUs of one suite entry run
+enum class SuitePlacement {
+    SINGLE,         // One CPU alone
+    PARALLEL,       // Every CPU at once, released by a spin barrier
+    SEQUENTIAL      // Every CPU alone, one after another
+};
+
+// The ISA x placement matrix run by --suite
+struct SuiteOptions {
+    std::vector<InstructionSet> instr_sets;
+    std::vector<SuitePlacement> placements;
+    std::vector<int> single_cpus;   // CPUs for SINGLE; empty picks one per package
+    BenchmarkOptions options;
+    int cooldown_sec = 0;           // Idle time between entries
+};
+
+// Outcome of one cell of the matrix
+struct SuiteEntry {
+    InstructionSet instr_set;
+    SuitePlacement placement;
+    std::vector<int> cpus;
+    bool supported = true;          // False: skipped, the CPU cannot run the kernel
+    std::vector<BenchmarkResult> results;   // In cpus order
+    double wall_sec = 0.0;
+};
+
+// Parse "single,parallel,sequential". Throws std::invalid_argument.
+std::vector<SuitePlacement> parse_placement_list(const std::string& list);
+
+std::string get_placement_name(SuitePlacement placement);
+
+// Run every entry of the matrix on the pool, ISA by ISA. Unsupported ISAs
+// are recorded as skipped without running.
+std::vector<SuiteEntry> run_suite(WorkerPool& pool, const SuiteOptions& suite);
+
+// One line per entry: placement, CPUs, frequency and throughput
+void print_suite_summary(const std::vector<SuiteEntry>& entries);
+
+// The whole suite as one JSON document
+void write_suite_report(std::ostream& out, const SuiteOptions& suite,
+                        const std::vector<SuiteEntry>& entries, double wall_sec);
@@ -0,0 +1,27 @@
+#pragma once
+
+#include <vector>
+
+#include "avx_benchmark.h"
+#include "worker_pool.h"
+
+// One cell of the active-core sweep: an ISA running on `active_cores` CPUs at once
+struct SweepPoint {
+    InstructionSet instr_set;
+    int active_cores = 0;
+    std::vector<int> cpus;
+    bool success = false;
+    double avg_freq = 0.0;          // Mean of the per-core averages
+    double min_core_freq = 0.0;     // Slowest core's average
+    double throughput = 0.0;        // Total kernel iterations per second across all active cores
+};
+
+// Run each ISA on 1, 2, 4 ... N cores of the pool at once. CPUs are spread
+// evenly across packages and physical cores using the sysfs topology.
+std::vector<SweepPoint> run_active_core_sweep(WorkerPool& pool,
+                                              const std::vector<InstructionSet>& instr_sets,
+                                              const BenchmarkOptions& options,
+                                              int cooldown_sec);
+
+// Print the measured frequency table: one row per active-core count, one column per ISA
+void print_sweep_table(const std::vector<SweepPoint>& points);
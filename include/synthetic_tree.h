@@ -0,0 +1,38 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Shape of a synthetic sysfs/procfs tree. CPUs are numbered like Linux does:
+// the first thread of every physical core first, then the siblings.
+struct SyntheticTreeOptions {
+    std::string root;
+    int cpus = 8;
+    int packages = 1;
+    int threads_per_core = 1;
+    uint32_t base_khz = 3000000;   // Frequency of every CPU before the timeline starts
+    std::string timeline_path;     // Empty: build a static tree and return
+};
+
+// One line of a timeline file: at time_sec, set these CPUs to khz
+struct TimelineStep {
+    double time_sec = 0.0;
+    std::vector<int> cpus;         // Empty: every CPU
+    uint32_t khz = 0;
+};
+
+// Parse a timeline file. Each non-comment line is "SECONDS CPUS KHZ", where
+// CPUS is a CPU list such as 0-3,8 or "all". Steps are sorted by time.
+// Throws std::runtime_error naming file and line on malformed input.
+std::vector<TimelineStep> load_timeline(const std::string& path);
+
+// Create the tree: cpufreq, topology and online files under sys/, plus
+// proc/cpuinfo. Throws std::runtime_error on I/O failure.
+void build_synthetic_tree(const SyntheticTreeOptions& options);
+
+// Build the tree, then play the timeline in real time by rewriting the
+// frequency files in place (readers with cached descriptors see each
+// change). Holds the last step until SIGINT or SIGTERM. Returns the process
+// exit code.
+int run_synthetic_tree(const SyntheticTreeOptions& options);
@@ -0,0 +1,31 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+// Placement of one logical CPU, read from /sys/devices/system/cpu/cpuN/topology
+struct CpuTopology {
+    int cpu = -1;
+    int package_id = 0;
+    int core_id = 0;     // Physical core id, unique within a package
+    int smt_index = 0;   // Position among the hyperthreads of its physical core
+};
+
+// Topology of the given CPUs. Missing sysfs entries default to package 0 and
+// one physical core per CPU.
+std::vector<CpuTopology> get_cpu_topology(const std::vector<int>& cpus);
+
+// Choose `count` CPUs spread evenly across packages, using distinct physical
+// cores before any hyperthread siblings
+std::vector<int> spread_cpus(const std::vector<CpuTopology>& topology, int count);
+
+// Active-core counts for a sweep: 1, 2, 4, ... plus max_count itself
+std::vector<int> sweep_core_counts(int max_count);
+
+// Parse a kernel-style CPU list such as "0-15,32,40-47" into sorted, unique
+// ids (see cfp::parse_cpu_list). Throws std::invalid_argument on malformed
+// input or an id above cfp::kMaxCpuId.
+std::vector<int> parse_cpu_list(const std::string& list);
+
+// Inverse of parse_cpu_list: sorted ids as a compact list such as "0-3,8"
+std::string format_cpu_list(const std::vector<int>& cpus);
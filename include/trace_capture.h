@@ -0,0 +1,16 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+struct TraceCaptureOptions {
+    std::string tracefs_root;     // Empty: the mounted tracefs
+    std::vector<int> cpus;        // Only report events about these CPUs; empty for all
+    std::string output_path;      // CSV of every event; empty for none
+    bool idle_events = true;
+};
+
+// Record every power:cpu_frequency (and power:cpu_idle) event until SIGINT or
+// SIGTERM, or until a replayed capture is exhausted, then print per-CPU
+// transition statistics. Returns the process exit code.
+int run_trace_capture(const TraceCaptureOptions& options);
@@ -0,0 +1,69 @@
+#pragma once
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <future>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "avx_benchmark.h"
+
+// Long-lived pool with one worker thread per CPU. Each worker is pinned once
+// when the pool starts and then runs jobs from its own FIFO queue, so a
+// sweep of many benchmarks reuses the same pinned threads instead of
+// creating and re-pinning a thread per run.
+class WorkerPool {
+public:
+    explicit WorkerPool(const std::vector<int>& cpus);
+    ~WorkerPool();
+
+    WorkerPool(const WorkerPool&) = delete;
+    WorkerPool& operator=(const WorkerPool&) = delete;
+
+    const std::vector<int>& cpus() const { return cpus_; }
+    bool has_cpu(int cpu) const { return workers_.count(cpu) != 0; }
+
+    // False if the worker for this CPU could not be pinned
+    bool is_pinned(int cpu) const;
+
+    // Queue a job on the worker for this CPU
+    std::future<void> submit(int cpu, std::function<void()> job);
+
+    // Queue a benchmark run on the worker for this CPU. The worker is already
+    // pinned, so the run does not pin again. Returns an unsuccessful result
+    // if the worker could not be pinned.
+    std::future<BenchmarkResult> submit_benchmark(int cpu, InstructionSet instr_set, const BenchmarkOptions& options);
+
+private:
+    struct Worker {
+        int cpu = -1;
+        bool pinned = false;
+        std::promise<void> ready;      // Fulfilled once pinning was attempted
+        std::mutex mutex;
+        std::condition_variable cv;
+        std::deque<std::function<void()>> queue;
+        bool stopping = false;
+        std::thread thread;
+    };
+
+    static void worker_loop(Worker& worker);
+
+    std::vector<int> cpus_;
+    std::map<int, std::unique_ptr<Worker>> workers_;
+};
+
+// One benchmark placement: which kernel runs on which CPU
+struct CoreAssignment {
+    int cpu;
+    InstructionSet instr_set;
+};
+
+// Run all assignments at once on their pool workers, released together by a
+// spin barrier. Results are returned in assignment order. Throws
+// std::invalid_argument, before anything is queued, if a CPU has no worker
+// in the pool or is assigned twice.
+std::vector<BenchmarkResult> run_synchronized(WorkerPool& pool, const std::vector<CoreAssignment>& assignments, const BenchmarkOptions& options);
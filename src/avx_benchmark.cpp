@@ -1,5 +1,11 @@
 #include "avx_benchmark.h"
 #include "cpu_utils.h"
+#include "kernels.h"
+#include "spin_barrier.h"
+#include "raw_trace.h"
+#include "live_view.h"
+#include "topology.h"
+#include "probe/sources.h"
 
 #include <iostream>
 #include <thread>
@@ -12,9 +18,9 @@
 #include <sstream>
 #include <mutex>
 #include <iomanip>
-
-// Global variable to control benchmark execution
-std::atomic<bool> g_running(false);
+#include <stdexcept>
+#include <fstream>
+#include <sys/resource.h>
 
 // Mutex for thread-safe console output
 std::mutex g_console_mutex;
@@ -37,6 +43,31 @@ std::string get_instruction_set_name(InstructionSet instr_set) {
     }
 }
 
+// All instruction sets, in the order they are reported
+std::vector<InstructionSet> all_instruction_sets() {
+    return {
+        InstructionSet::BASIC_ADD,
+        InstructionSet::AVX128,
+        InstructionSet::AVX256,
+        InstructionSet::AVX512,
+        InstructionSet::AMX
+    };
+}
+
+// Parse a comma-separated list of instruction sets
+std::vector<InstructionSet> string_to_instruction_set_list(const std::string& str) {
+    std::vector<InstructionSet> instr_sets;
+    std::stringstream ss(str);
+    std::string item;
+    
+    while (std::getline(ss, item, ',')) {
+        if (!item.empty()) {
+            instr_sets.push_back(string_to_instruction_set(item));
+        }
+    }
+    return instr_sets;
+}
+
 // Convert string to instruction set enum
 InstructionSet string_to_instruction_set(const std::string& str) {
     std::string lower_str = str;
@@ -53,247 +84,139 @@ InstructionSet string_to_instruction_set(const std::string& str) {
     } else if (lower_str == "basic_add" || lower_str == "add" || lower_str == "basic") {
         return InstructionSet::BASIC_ADD;
     } else {
-        std::cerr << "Unknown instruction set: " << str << std::endl;
-        std::cerr << "Available options: avx128, avx256, avx512, amx, basic_add" << std::endl;
-        exit(1);
+        throw std::invalid_argument("Unknown instruction set: " + str +
+                                    " (available options: avx128, avx256, avx512, amx, basic_add)");
     }
 }
 
-// SSE benchmark function (safe for most x86 CPUs, using SSE instructions)
-extern "C" void benchmark_sse(size_t iterations) {
-    asm volatile(
-        "movq %0, %%rcx\n"     // Move iterations to rcx register
-        
-        // Initialize xmm registers with data
-        "movq $0x3f800000, %%rax\n"    // 1.0f in IEEE-754
-        "movd %%eax, %%xmm0\n"
-        "pshufd $0, %%xmm0, %%xmm0\n"  // Replicate to all elements
-        
-        "movq $0x40000000, %%rax\n"    // 2.0f in IEEE-754
-        "movd %%eax, %%xmm1\n"
-        "pshufd $0, %%xmm1, %%xmm1\n"  // Replicate to all elements
-        
-        "1:\n"                 // Label for loop
-        
-        // SSE instructions (128-bit)
-        "movaps %%xmm0, %%xmm2\n"
-        "addps %%xmm1, %%xmm2\n"
-        "mulps %%xmm1, %%xmm2\n"
-        "movaps %%xmm2, %%xmm3\n"
-        "addps %%xmm0, %%xmm3\n"
-        "mulps %%xmm1, %%xmm3\n"
-        "movaps %%xmm3, %%xmm4\n"
-        "addps %%xmm0, %%xmm4\n"
-        "mulps %%xmm4, %%xmm0\n"
-        
-        "decq %%rcx\n"         // Decrement counter
-        "jnz 1b\n"             // Jump back to label 1 if rcx != 0
-        
-        : // No outputs
-        : "r"(iterations)      // Input constraint: iterations in a register
-        : "rax", "rcx", "xmm0", "xmm1", "xmm2", "xmm3", "xmm4" // Clobbered registers
-    );
-}
-
-// AVX-128/SSE benchmark function
-extern "C" void benchmark_avx128(size_t iterations) {
-    // First try AVX if available
-    if (has_avx()) {
-        asm volatile(
-            "movq %0, %%rcx\n"     // Move iterations to rcx register
-            
-            // Initialize xmm registers with data
-            "vxorps %%xmm0, %%xmm0, %%xmm0\n"
-            "vxorps %%xmm1, %%xmm1, %%xmm1\n"
-            "vaddps %%xmm0, %%xmm1, %%xmm0\n"
-            
-            "1:\n"                 // Label for loop
-            
-            // AVX-128 instructions
-            "vmovaps %%xmm0, %%xmm1\n"
-            "vaddps %%xmm1, %%xmm0, %%xmm0\n"
-            "vmulps %%xmm1, %%xmm0, %%xmm0\n"
-            "vshufps $0x1B, %%xmm0, %%xmm0, %%xmm1\n"
-            "vaddps %%xmm1, %%xmm0, %%xmm0\n"
-            "vmovaps %%xmm0, %%xmm2\n"
-            "vmovaps %%xmm0, %%xmm3\n"
-            "vaddps %%xmm2, %%xmm3, %%xmm3\n"
-            "vmovaps %%xmm3, %%xmm4\n"
-            "vmovaps %%xmm4, %%xmm5\n"
-            "vaddps %%xmm4, %%xmm5, %%xmm5\n"
-            "vmulps %%xmm3, %%xmm5, %%xmm5\n"
-            "vaddps %%xmm5, %%xmm0, %%xmm0\n"
-            
-            "decq %%rcx\n"         // Decrement counter
-            "jnz 1b\n"             // Jump back to label 1 if rcx != 0
-            
-            : // No outputs
-            : "r"(iterations)      // Input constraint: iterations in a register
-            : "rcx", "xmm0", "xmm1", "xmm2", "xmm3", "xmm4", "xmm5" // Clobbered registers
-        );
-    }
-    // Fallback to SSE if AVX is not available
-    else if (has_sse2()) {
-        benchmark_sse(iterations);
+// Pick an iteration count so one call to the kernel takes about target_ms
+size_t calibrate_batch_iterations(InstructionSet instr_set, double target_ms) {
+    KernelFn kernel = get_kernel(instr_set);
+    if (kernel == nullptr) {
+        return 0;
+    }
+    
+    const double target_ticks = target_ms * 1e-3 * get_tsc_hz();
+    
+    // Grow a probe batch until it runs long enough to time reliably
+    size_t probe_iterations = 1000;
+    unsigned long long probe_ticks = 0;
+    while (true) {
+        unsigned long long start_tsc = read_tsc();
+        kernel(probe_iterations);
+        probe_ticks = read_tsc() - start_tsc;
+        if (probe_ticks >= target_ticks / 8 || probe_iterations >= (size_t(1) << 40)) {
+            break;
+        }
+        probe_iterations *= 2;
     }
+    
+    // Keep the fastest of a few repeats so an interrupt cannot inflate the estimate
+    for (int i = 0; i < 3; i++) {
+        unsigned long long start_tsc = read_tsc();
+        kernel(probe_iterations);
+        probe_ticks = std::min(probe_ticks, read_tsc() - start_tsc);
+    }
+    
+    double iterations = probe_iterations * target_ticks / std::max(probe_ticks, 1ULL);
+    return std::max<size_t>(1, static_cast<size_t>(iterations));
 }
 
-// AVX-256 benchmark function
-extern "C" void benchmark_avx256(size_t iterations) {
-    asm volatile(
-        "movq %0, %%rcx\n"     // Move iterations to rcx register
-        
-        // Initialize ymm registers with data
-        "vxorps %%ymm0, %%ymm0, %%ymm0\n"
-        "vxorps %%ymm1, %%ymm1, %%ymm1\n"
-        
-        "1:\n"                 // Label for loop
-        
-        // AVX2 instructions (256-bit)
-        "vmovaps %%ymm0, %%ymm1\n"
-        "vaddps %%ymm1, %%ymm0, %%ymm0\n"
-        "vmulps %%ymm1, %%ymm0, %%ymm0\n"
-        "vpermpd $0x1B, %%ymm0, %%ymm2\n"
-        "vaddps %%ymm2, %%ymm0, %%ymm0\n"
-        "vmovaps %%ymm0, %%ymm3\n"
-        "vaddps %%ymm3, %%ymm0, %%ymm0\n"
-        "vmulps %%ymm3, %%ymm0, %%ymm0\n"
-        "vaddps %%ymm1, %%ymm0, %%ymm0\n"
-        
-        "decq %%rcx\n"         // Decrement counter
-        "jnz 1b\n"             // Jump back to label 1 if rcx != 0
-        
-        "vzeroupper\n"         // Zero upper bits of YMM registers
-        
-        : // No outputs
-        : "r"(iterations)      // Input constraint: iterations in a register
-        : "rcx", "ymm0", "ymm1", "ymm2", "ymm3" // Clobbered registers
-    );
-}
+// Everything a run appends to while the kernel is running, in NodeArrays
+// bound to the run's memory node. Copied into the result and raw trace once
+// the run has ended.
+struct RunStorage {
+    explicit RunStorage(int node)
+        : frequencies(node), sample_times(node), raw_frequencies(node), raw_energy(node), batch_end_tsc(node) {}
 
-// AVX-512 benchmark function
-extern "C" void benchmark_avx512(size_t iterations) {
-    asm volatile(
-        "movq %0, %%rcx\n"     // Move iterations to rcx register
-        
-        // Initialize zmm registers with data
-        "vpxorq %%zmm0, %%zmm0, %%zmm0\n"
-        "vpxorq %%zmm1, %%zmm1, %%zmm1\n"
-        
-        "1:\n"                 // Label for loop
-        
-        // AVX-512 instructions (512-bit)
-        "vmovaps %%zmm0, %%zmm1\n"
-        "vaddps %%zmm1, %%zmm0, %%zmm0\n"
-        "vmulps %%zmm1, %%zmm0, %%zmm0\n"
-        "vaddps %%zmm1, %%zmm0, %%zmm2\n"
-        "vfmadd132ps %%zmm0, %%zmm1, %%zmm2\n"
-        "vmovaps %%zmm2, %%zmm3\n"
-        "vfmadd213ps %%zmm0, %%zmm1, %%zmm3\n"
-        "vaddps %%zmm3, %%zmm0, %%zmm0\n"
-        "vmulps %%zmm3, %%zmm0, %%zmm0\n"
-        
-        "decq %%rcx\n"         // Decrement counter
-        "jnz 1b\n"             // Jump back to label 1 if rcx != 0
-        
-        "vzeroupper\n"         // Zero upper bits of ZMM registers
-        
-        : // No outputs
-        : "r"(iterations)      // Input constraint: iterations in a register
-        : "rcx", "zmm0", "zmm1", "zmm2", "zmm3" // Clobbered registers
-    );
-}
+    NodeArray<double> frequencies;
+    NodeArray<double> sample_times;
+    NodeArray<RawFrequencyReading> raw_frequencies;
+    NodeArray<RawEnergyReading> raw_energy;
+    NodeArray<unsigned long long> batch_end_tsc;
 
-// AMX benchmark function
-extern "C" void benchmark_amx(size_t iterations) {
-    // AMX requires specific setup with LDTILECFG instruction first
-    // This is a placeholder that demonstrates AMX usage pattern
-    // In a real implementation, we would use proper tile configuration and operations
-    
-    asm volatile(
-        "movq %0, %%rcx\n"     // Move iterations to rcx register
-        "1:\n"                 // Label for loop
-        
-        // AMX operation simulation with basic instructions
-        // In reality, we would use tdpbf16ps, tdpbssd, tilezero, tileloadd, tilestored, etc.
-        "xor %%rax, %%rax\n"
-        "xor %%rbx, %%rbx\n"
-        "xor %%rdx, %%rdx\n"
-        "inc %%rax\n"
-        "inc %%rbx\n"
-        "inc %%rdx\n"
-        
-        "decq %%rcx\n"         // Decrement counter
-        "jnz 1b\n"             // Jump back to label 1 if rcx != 0
-        
-        : // No outputs
-        : "r"(iterations)      // Input constraint: iterations in a register
-        : "rax", "rbx", "rcx", "rdx" // Clobbered registers
-    );
-}
+    // Pages per node over every buffer
+    std::map<int, size_t> page_nodes() const {
+        std::map<int, size_t> nodes;
+        for (const NodeBuffer* buffer : {&frequencies.buffer(), &sample_times.buffer(), &raw_frequencies.buffer(),
+                                         &raw_energy.buffer(), &batch_end_tsc.buffer()}) {
+            for (const auto& [node, pages] : buffer->page_nodes()) {
+                nodes[node] += pages;
+            }
+        }
+        return nodes;
+    }
+};
 
-// Basic integer ADD benchmark function
-extern "C" void benchmark_basic_add(size_t iterations) {
-    asm volatile(
-        "movq %0, %%rcx\n"     // Move iterations to rcx register
-        
-        // Initialize registers with data
-        "movq $1, %%rax\n"
-        "movq $2, %%rbx\n"
-        
-        "1:\n"                 // Label for loop
+// State shared between a benchmark run and its monitor thread
+struct MonitorContext {
+    int core_id;
+    int sampling_interval_ms;
+    FrequencySource source;
+    std::atomic<bool> running{true};
+    std::atomic<bool> converged{false};    // Set when the adaptive stop condition is met
+    SteadyStateDetector* detector = nullptr; // Only touched by the monitor thread while running
+    BenchmarkResult* result = nullptr;
+    RawTrace* raw_trace = nullptr;          // Set when recording; readings go to storage first
+    bool sample_power = false;              // Read the package energy counter with each sample
+    int package_id = -1;                    // Set by the monitor thread when sampling power
+    uint64_t max_energy_uj = 0;             // RAPL counter range, 0 if unknown
+    RunStorage* storage = nullptr;
+    LiveCoreSlot* live = nullptr;           // Latest sample is published here for a live view
+};
+
+// Thread function to monitor CPU frequency
+void monitor_thread_func(MonitorContext& ctx) {
+    // Package power is read next to each sample when recording or tracing
+    cfp::RaplPackagePower rapl;
+    if (ctx.sample_power) {
+        ctx.package_id = get_cpu_topology({ctx.core_id})[0].package_id;
+        if (rapl.open(ctx.package_id)) {
+            ctx.max_energy_uj = rapl.max_energy_uj();
+        }
+    }
+    
+    auto start_time = std::chrono::steady_clock::now();
+    ctx.result->monitor_start_tsc = read_tsc();
+    
+    while (ctx.running) {
+        double freq = get_cpu_freq_mhz(ctx.core_id, ctx.source);
+        double time_sec = std::chrono::duration<double>(std::chrono::steady_clock::now() - start_time).count();
+        ctx.storage->frequencies.push_back(freq);
+        ctx.storage->sample_times.push_back(time_sec);
+        if (ctx.live != nullptr) {
+            ctx.live->freq_khz.store(static_cast<uint32_t>(freq * 1000.0), std::memory_order_relaxed);
+        }
         
-        // Basic integer add instructions
-        "addq %%rbx, %%rax\n"
-        "addq %%rax, %%rbx\n"
-        "addq %%rbx, %%rax\n"
-        "addq %%rax, %%rbx\n"
-        "addq %%rbx, %%rax\n"
-        "addq %%rax, %%rbx\n"
-        "addq %%rbx, %%rax\n"
-        "addq %%rax, %%rbx\n"
-        "addq %%rbx, %%rax\n"
-        "addq %%rax, %%rbx\n"
+        if (ctx.raw_trace != nullptr) {
+            ctx.storage->raw_frequencies.push_back({time_sec, freq});
+        }
+        uint64_t energy_uj = 0;
+        if (rapl.is_open() && rapl.read_energy_uj(energy_uj)) {
+            ctx.storage->raw_energy.push_back({time_sec, energy_uj});
+        }
         
-        "decq %%rcx\n"         // Decrement counter
-        "jnz 1b\n"             // Jump back to label 1 if rcx != 0
+        if (ctx.detector != nullptr) {
+            ctx.detector->add_sample(time_sec, freq);
+            if (ctx.detector->converged()) {
+                ctx.converged = true;
+            }
+        }
         
-        : // No outputs
-        : "r"(iterations)      // Input constraint: iterations in a register
-        : "rax", "rbx", "rcx"  // Clobbered registers
-    );
-}
-
-// Thread function to run benchmarks
-void benchmark_thread_func(InstructionSet instr_set, size_t iterations) {
-    // Run appropriate benchmark based on instruction set
-    switch(instr_set) {
-        case InstructionSet::AVX128:
-            benchmark_avx128(iterations);
-            break;
-        case InstructionSet::AVX256:
-            benchmark_avx256(iterations);
-            break;
-        case InstructionSet::AVX512:
-            benchmark_avx512(iterations);
-            break;
-        case InstructionSet::AMX:
-            benchmark_amx(iterations);
-            break;
-        case InstructionSet::BASIC_ADD:
-            benchmark_basic_add(iterations);
-            break;
+        std::this_thread::sleep_for(std::chrono::milliseconds(ctx.sampling_interval_ms));
     }
-}
-
-// Thread function to monitor CPU frequency
-void monitor_thread_func(int core_id, std::vector<double>& frequencies) {
-    const int sampling_interval_ms = 100; // Sample every 100ms
     
-    while (g_running) {
-        double freq = get_cpu_freq_mhz(core_id);
-        frequencies.push_back(freq);
-        std::this_thread::sleep_for(std::chrono::milliseconds(sampling_interval_ms));
+    // What observing cost: this thread's own CPU time and how long it sat on
+    // the runqueue waiting for the benchmark core
+    struct rusage usage;
+    if (getrusage(RUSAGE_THREAD, &usage) == 0) {
+        ctx.result->sampler_cpu_sec = usage.ru_utime.tv_sec + usage.ru_utime.tv_usec / 1e6
+                                    + usage.ru_stime.tv_sec + usage.ru_stime.tv_usec / 1e6;
+    }
+    std::ifstream schedstat("/proc/thread-self/schedstat");
+    unsigned long long run_ns = 0, wait_ns = 0;
+    if (schedstat >> run_ns >> wait_ns) {
+        ctx.result->sampler_wait_sec = wait_ns / 1e9;
     }
 }
 
@@ -307,6 +230,42 @@ void print_benchmark_result(const BenchmarkResult& result, const std::string& in
     std::cout << "    Minimum: " << std::fixed << std::setprecision(2) << result.min_freq << " MHz" << std::endl;
     std::cout << "    Maximum: " << std::fixed << std::setprecision(2) << result.max_freq << " MHz" << std::endl;
     std::cout << "    Average: " << std::fixed << std::setprecision(2) << result.avg_freq << " MHz" << std::endl;
+    std::cout << "  Run Loop:" << std::endl;
+    std::cout << "    Duration:   " << std::fixed << std::setprecision(3) << result.elapsed_sec << " s" << std::endl;
+    std::cout << "    Batch size: " << result.batch_iterations << " iterations" << std::endl;
+    std::cout << "    Overrun:    " << std::fixed << std::setprecision(1) << result.overrun_us << " us" << std::endl;
+    if (result.elapsed_sec > 0.0) {
+        std::cout << "    Throughput: " << std::fixed << std::setprecision(2)
+                  << result.total_iterations / result.elapsed_sec / 1e6 << " M iterations/s" << std::endl;
+    }
+    if (result.avg_package_power_w >= 0.0) {
+        std::cout << "    Package:    " << std::fixed << std::setprecision(2) << result.avg_package_power_w << " W" << std::endl;
+    }
+    if (result.memory_pages > 0) {
+        std::cout << "  Memory: " << result.memory_pages << " page(s) bound to node " << result.memory_node
+                  << ", CPU on node " << result.cpu_node
+                  << (result.memory_node == result.cpu_node ? " (local)" : " (remote)") << std::endl;
+        if (result.memory_pages_off_node > 0) {
+            std::cout << "    Warning: " << result.memory_pages_off_node << " page(s) are not on node "
+                      << result.memory_node << std::endl;
+        }
+    }
+    if (result.adaptive) {
+        std::cout << "  Adaptive Run:" << std::endl;
+        std::cout << "    Stopped:     " << (result.converged ? "steady state reached" : "max time reached") << std::endl;
+        if (result.warmup_sec >= 0.0) {
+            std::cout << "    Warm-up:     " << std::fixed << std::setprecision(2) << result.warmup_sec << " s" << std::endl;
+            std::cout << "    Steady mean: " << std::fixed << std::setprecision(2) << result.steady_mean
+                      << " MHz +/- " << result.ci_half_width << " MHz (95% CI)" << std::endl;
+        } else {
+            std::cout << "    Warm-up:     never settled" << std::endl;
+        }
+        std::cout << "    Throttling:  " << result.throttle_events << " event(s)" << std::endl;
+        for (const auto& span : result.phases) {
+            std::cout << "      " << std::fixed << std::setprecision(2) << std::setw(8) << span.start_sec
+                      << " - " << std::setw(8) << span.end_sec << " s  " << run_phase_name(span.phase) << std::endl;
+        }
+    }
     
     // Print frequency timeline only if verbose output is needed
     /*
@@ -331,118 +290,400 @@ void print_benchmark_result(const BenchmarkResult& result, const std::string& in
     */
 }
 
+// Aggregate per-core results that ran together
+ResultSummary summarize_results(const std::vector<BenchmarkResult>& results) {
+    ResultSummary summary;
+    summary.cores = static_cast<int>(results.size());
+    double freq_sum = 0.0;
+    
+    for (const auto& result : results) {
+        if (!result.success) {
+            continue;
+        }
+        freq_sum += result.avg_freq;
+        if (summary.succeeded == 0 || result.avg_freq < summary.min_core_freq) {
+            summary.min_core_freq = result.avg_freq;
+        }
+        if (result.elapsed_sec > 0.0) {
+            summary.throughput += result.total_iterations / result.elapsed_sec;
+        }
+        summary.succeeded++;
+    }
+    
+    if (summary.succeeded > 0) {
+        summary.avg_freq = freq_sum / summary.succeeded;
+    }
+    return summary;
+}
+
+// Measure how closely the cores started and how long they all ran together
+// Shared by the vector and per-CPU map overloads; get() yields the result of an element
+template <typename Container, typename Get>
+static StartAlignment start_alignment_of(const Container& results, Get get) {
+    StartAlignment alignment;
+    unsigned long long first_start = ~0ULL, last_start = 0, first_end = ~0ULL;
+    
+    for (const auto& element : results) {
+        const BenchmarkResult& result = get(element);
+        if (!result.success) {
+            continue;
+        }
+        first_start = std::min(first_start, result.start_tsc);
+        last_start = std::max(last_start, result.start_tsc);
+        first_end = std::min(first_end, result.end_tsc);
+        alignment.cores++;
+    }
+    
+    if (alignment.cores > 0) {
+        double tsc_hz = get_tsc_hz();
+        alignment.skew_us = (last_start - first_start) / tsc_hz * 1e6;
+        alignment.overlap_sec = first_end > last_start ? (first_end - last_start) / tsc_hz : 0.0;
+    }
+    return alignment;
+}
+
+StartAlignment compute_start_alignment(const std::vector<BenchmarkResult>& results) {
+    return start_alignment_of(results, [](const BenchmarkResult& result) -> const BenchmarkResult& { return result; });
+}
+
+StartAlignment compute_start_alignment(const CoreResults& results) {
+    return start_alignment_of(results, [](const CoreResults::value_type& entry) -> const BenchmarkResult& {
+        return entry.second;
+    });
+}
+
+// Report how closely the cores started and how long they all ran together
+static void print_start_alignment(const StartAlignment& alignment) {
+    if (alignment.cores < 2) {
+        return;
+    }
+    
+    std::lock_guard<std::mutex> lock(g_console_mutex);
+    std::cout << "\nStart skew across " << alignment.cores << " cores: "
+              << std::fixed << std::setprecision(1) << alignment.skew_us << " us" << std::endl;
+    std::cout << "Fully-overlapped window: " << std::fixed << std::setprecision(3) << alignment.overlap_sec << " s" << std::endl;
+}
+
+void print_start_alignment(const std::vector<BenchmarkResult>& results) {
+    print_start_alignment(compute_start_alignment(results));
+}
+
+void print_start_alignment(const CoreResults& results) {
+    print_start_alignment(compute_start_alignment(results));
+}
+
 // Run the benchmark with specified instruction set and return results
 BenchmarkResult run_benchmark_with_result(InstructionSet instr_set, int duration_sec, int core_id) {
+    BenchmarkOptions options;
+    options.duration_sec = duration_sec;
+    return run_benchmark_with_result(instr_set, options, core_id);
+}
+
+// Stops and joins the monitor thread on every way out of a run, so an
+// exception never destroys a joinable std::thread
+struct MonitorJoiner {
+    MonitorContext& ctx;
+    std::thread& thread;
+    ~MonitorJoiner() {
+        ctx.running = false;
+        if (thread.joinable()) {
+            thread.join();
+        }
+    }
+};
+
+// The run itself. Sets arrived once it has passed options.start_barrier.
+static BenchmarkResult run_benchmark_body(InstructionSet instr_set, const BenchmarkOptions& options, int core_id,
+                                          bool& arrived) {
     BenchmarkResult result;
     result.core_id = core_id;
     result.success = false;
+    result.adaptive = options.adaptive;
     
     // Check if the CPU supports the requested instruction set
-    bool supported = true;
-    
-    switch(instr_set) {
-        case InstructionSet::AVX128:
-            supported = has_sse2();  // Minimum requirement for AVX128 fallback
-            break;
-        case InstructionSet::AVX256:
-            supported = has_avx2();
-            break;
-        case InstructionSet::AVX512:
-            supported = has_avx512f();
-            break;
-        case InstructionSet::AMX:
-            supported = has_amx();
-            break;
-        case InstructionSet::BASIC_ADD:
-            supported = true; // Basic integer add is supported on all CPUs
-            break;
+    KernelFn kernel = get_kernel(instr_set);
+    if (kernel == nullptr) {
+        result.failure = BenchmarkFailure::UNSUPPORTED_ISA;
+    } else if (options.pin_thread && !pin_to_core(core_id)) {
+        // A CPU we may not run on is skipped, not fatal
+        result.failure = BenchmarkFailure::NOT_PINNABLE;
     }
-    
-    if (!supported) {
+    if (result.failure != BenchmarkFailure::NONE) {
+        // Still release the other participants of a synchronized start
+        if (options.start_barrier != nullptr) {
+            options.start_barrier->arrive_and_wait();
+            arrived = true;
+        }
         // Don't print anything here, just return the result indicating failure
         return result;
     }
     
-    // Pin to specified core
-    pin_to_core(core_id);
-    
-    // Start the benchmark thread
-    g_running = true;
-    result.frequencies.clear();
+    // Now that we run on the target core, place the run's sample and trace
+    // storage on the chosen node. Those buffers are mapped, bound and faulted
+    // in here, because heap pages malloc reuses keep whatever node they were
+    // first touched on. The thread binding covers buffers a kernel allocates.
+    result.cpu_node = get_cpu_node(core_id);
+    int memory_node = choose_memory_node(core_id, options.memory_placement);
+    bool memory_bound = memory_node >= 0 && bind_thread_memory(memory_node);
+    double run_sec = options.adaptive ? options.steady_state.max_sec : options.duration_sec;
+    size_t expected_samples = static_cast<size_t>(run_sec * 1000.0 / std::max(1, options.sampling_interval_ms)) + 16;
+    RunStorage storage(memory_node);
+    if (options.sample_frequency) {
+        storage.frequencies.reserve(expected_samples);
+        storage.sample_times.reserve(expected_samples);
+    }
+    bool sample_power = options.sample_package_power || options.raw_trace != nullptr;
+    if (sample_power) {
+        storage.raw_energy.reserve(expected_samples);
+    }
+    if (options.raw_trace != nullptr) {
+        storage.raw_frequencies.reserve(expected_samples);
+        storage.batch_end_tsc.reserve(static_cast<size_t>(run_sec * 1000.0 / kTargetBatchMs) + 16);
+    }
     
-    // Create a monitoring thread
-    std::thread monitor(monitor_thread_func, core_id, std::ref(result.frequencies));
+    // Size batches on the target core before monitoring starts
+    result.batch_iterations = calibrate_batch_iterations(instr_set, kTargetBatchMs);
     
-    // Give monitor thread a chance to start
-    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    // Create a monitoring thread unless the run is unobserved
+    SteadyStateDetector detector(options.steady_state);
+    MonitorContext ctx;
+    ctx.core_id = core_id;
+    ctx.sampling_interval_ms = options.sampling_interval_ms;
+    ctx.source = options.source;
+    ctx.detector = options.adaptive ? &detector : nullptr;
+    ctx.result = &result;
+    ctx.raw_trace = options.raw_trace;
+    ctx.sample_power = sample_power;
+    ctx.storage = &storage;
+    LiveCoreSlot* live = options.live_board != nullptr ? options.live_board->slot(core_id) : nullptr;
+    ctx.live = live;
+    std::thread monitor;
+    MonitorJoiner monitor_joiner{ctx, monitor};
+    if (options.sample_frequency) {
+        monitor = std::thread(monitor_thread_func, std::ref(ctx));
+        result.sampled = true;
+        
+        // Give monitor thread a chance to start
+        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    }
     
-    {
+    // A live view owns the terminal while it runs
+    if (live == nullptr) {
         std::lock_guard<std::mutex> lock(g_console_mutex);
         std::cout << "Running " << get_instruction_set_name(instr_set) 
                   << " benchmark on core " << core_id << "..." << std::endl;
     }
     
-    // Start benchmark
-    const size_t iterations_per_batch = 10000000; // 10 million iterations per batch
-    auto start_time = std::chrono::steady_clock::now();
-    auto end_time = start_time + std::chrono::seconds(duration_sec);
+    // Start benchmark. Batches are sized to kTargetBatchMs, and the deadline
+    // is checked against the TSC between batches. In adaptive mode the run
+    // ends at the first batch after min_sec where the monitor reports
+    // convergence, or at max_sec.
+    const double tsc_hz = get_tsc_hz();
+    if (options.start_barrier != nullptr) {
+        options.start_barrier->arrive_and_wait();
+        arrived = true;
+    }
+    double min_sec = options.adaptive ? options.steady_state.min_sec : run_sec;
+    struct rusage usage_before;
+    getrusage(RUSAGE_THREAD, &usage_before);
+    unsigned long long start_tsc = read_tsc();
+    unsigned long long deadline_tsc = start_tsc + static_cast<unsigned long long>(run_sec * tsc_hz);
+    unsigned long long min_deadline_tsc = start_tsc + static_cast<unsigned long long>(min_sec * tsc_hz);
+    unsigned long long now_tsc = start_tsc;
+    if (live != nullptr) {
+        live->iterations.store(0, std::memory_order_relaxed);
+        live->instr.store(static_cast<int>(instr_set), std::memory_order_relaxed);
+    }
+    NodeArray<unsigned long long>* batch_stamps = options.raw_trace != nullptr ? &storage.batch_end_tsc : nullptr;
+    
+    while (now_tsc < deadline_tsc) {
+        kernel(result.batch_iterations);
+        result.total_iterations += result.batch_iterations;
+        now_tsc = read_tsc();
+        if (batch_stamps != nullptr) {
+            batch_stamps->push_back(now_tsc);
+        }
+        if (live != nullptr) {
+            live->iterations.store(result.total_iterations, std::memory_order_relaxed);
+        }
+        
+        if (options.adaptive && now_tsc >= min_deadline_tsc && ctx.converged) {
+            result.converged = true;
+            break;
+        }
+    }
     
-    while (std::chrono::steady_clock::now() < end_time) {
-        benchmark_thread_func(instr_set, iterations_per_batch);
+    if (live != nullptr) {
+        live->instr.store(-1, std::memory_order_relaxed);
     }
+    result.start_tsc = start_tsc;
+    result.end_tsc = now_tsc;
+    result.elapsed_sec = (now_tsc - start_tsc) / tsc_hz;
+    result.overrun_us = now_tsc > deadline_tsc ? (now_tsc - deadline_tsc) / tsc_hz * 1e6 : 0.0;
+    struct rusage usage_after;
+    getrusage(RUSAGE_THREAD, &usage_after);
+    result.kernel_preemptions = usage_after.ru_nivcsw - usage_before.ru_nivcsw;
     
     // Stop the monitor thread
-    g_running = false;
+    ctx.running = false;
     if (monitor.joinable()) {
         monitor.join();
     }
+    if (memory_bound) {
+        bind_thread_memory(-1);
+    }
+    
+    // Check every page of the run's storage, not just the first
+    result.memory_node = memory_node;
+    for (const auto& [node, pages] : storage.page_nodes()) {
+        result.memory_pages += pages;
+        if (node != memory_node) {
+            result.memory_pages_off_node += pages;
+        }
+    }
+    result.frequencies.assign(storage.frequencies.begin(), storage.frequencies.end());
+    result.sample_times.assign(storage.sample_times.begin(), storage.sample_times.end());
+    
+    // An unobserved run only measures throughput
+    if (!options.sample_frequency) {
+        result.success = true;
+        return result;
+    }
+    
+    if (options.raw_trace != nullptr) {
+        RawTrace& trace = *options.raw_trace;
+        trace.frequencies.assign(storage.raw_frequencies.begin(), storage.raw_frequencies.end());
+        trace.energy.assign(storage.raw_energy.begin(), storage.raw_energy.end());
+        trace.batch_end_tsc.assign(storage.batch_end_tsc.begin(), storage.batch_end_tsc.end());
+        trace.instr_set = instr_set;
+        trace.core_id = core_id;
+        trace.options = options;
+        trace.options.start_barrier = nullptr;
+        trace.options.raw_trace = nullptr;
+        trace.options.live_board = nullptr;
+        trace.tsc_hz = tsc_hz;
+        trace.batch_iterations = result.batch_iterations;
+        trace.start_tsc = start_tsc;
+        trace.deadline_tsc = deadline_tsc;
+        trace.max_energy_uj = ctx.max_energy_uj;
+    }
+    if (sample_power) {
+        std::vector<RawEnergyReading> energy(storage.raw_energy.begin(), storage.raw_energy.end());
+        result.package_id = ctx.package_id;
+        result.avg_package_power_w = average_package_power_w(energy, ctx.max_energy_uj);
+        package_power_series(energy, ctx.max_energy_uj, result.power_times, result.package_power_w);
+    }
     
-    // Calculate statistics
     if (result.frequencies.empty()) {
+        result.failure = BenchmarkFailure::NO_SAMPLES;
         return result;  // Return with success = false
     }
     
+    finalize_benchmark_result(result, options, detector);
+    return result;
+}
+
+BenchmarkResult run_benchmark_with_result(InstructionSet instr_set, const BenchmarkOptions& options, int core_id) {
+    bool arrived = false;
+    try {
+        return run_benchmark_body(instr_set, options, core_id, arrived);
+    } catch (const std::exception& e) {
+        // A run that threw (e.g. std::bad_alloc) still releases the other
+        // participants of a synchronized start and reports a failed result
+        bind_thread_memory(-1);
+        if (options.start_barrier != nullptr && !arrived) {
+            options.start_barrier->arrive_and_wait();
+        }
+        BenchmarkResult result;
+        result.core_id = core_id;
+        result.success = false;
+        result.failure = BenchmarkFailure::ERROR;
+        result.error = e.what();
+        return result;
+    }
+}
+
+void finalize_benchmark_result(BenchmarkResult& result, const BenchmarkOptions& options,
+                               const SteadyStateDetector& detector) {
+    if (result.frequencies.empty()) {
+        result.failure = BenchmarkFailure::NO_SAMPLES;
+        return;
+    }
+    
     result.min_freq = *std::min_element(result.frequencies.begin(), result.frequencies.end());
     result.max_freq = *std::max_element(result.frequencies.begin(), result.frequencies.end());
     result.avg_freq = std::accumulate(result.frequencies.begin(), result.frequencies.end(), 0.0) / result.frequencies.size();
-    result.success = true;
     
-    return result;
+    if (options.adaptive) {
+        result.warmup_sec = detector.warmup_sec();
+        result.steady_mean = detector.steady_mean();
+        result.ci_half_width = detector.ci_half_width();
+        result.throttle_events = detector.throttle_events();
+        result.phases = detector.phases();
+    }
+    
+    result.success = true;
+}
+
+std::string get_benchmark_failure_message(const BenchmarkResult& result, InstructionSet instr_set) {
+    switch(result.failure) {
+        case BenchmarkFailure::UNSUPPORTED_ISA:
+            return "The CPU does not support " + get_instruction_set_name(instr_set) + " instructions";
+        case BenchmarkFailure::NOT_PINNABLE:
+            return "Cannot run on core " + std::to_string(result.core_id) + " (thread could not be pinned)";
+        case BenchmarkFailure::NO_SAMPLES:
+            return "No frequency sample was read on core " + std::to_string(result.core_id);
+        case BenchmarkFailure::ERROR:
+            return "The benchmark on core " + std::to_string(result.core_id) + " failed: " + result.error;
+        case BenchmarkFailure::NONE:
+            break;
+    }
+    return "The benchmark on core " + std::to_string(result.core_id) + " did not produce a result";
 }
 
 // Main benchmark runner function (for backward compatibility)
 void run_benchmark(InstructionSet instr_set, int duration_sec, int core_id) {
-    BenchmarkResult result = run_benchmark_with_result(instr_set, duration_sec, core_id);
+    BenchmarkOptions options;
+    options.duration_sec = duration_sec;
+    run_benchmark(instr_set, options, core_id);
+}
+
+void run_benchmark(InstructionSet instr_set, const BenchmarkOptions& options, int core_id) {
+    BenchmarkResult result = run_benchmark_with_result(instr_set, options, core_id);
     
     if (!result.success) {
-        std::string instr_name = get_instruction_set_name(instr_set);
-        
         std::lock_guard<std::mutex> lock(g_console_mutex);
-        std::cerr << "The CPU does not support " << instr_name << " instructions." << std::endl;
+        std::cerr << get_benchmark_failure_message(result, instr_set) << "." << std::endl;
         std::cerr << "Skipping this benchmark." << std::endl;
         return;
     }
     
     print_benchmark_result(result, get_instruction_set_name(instr_set));
-    
-    // Print all frequency measurements if requested (legacy detailed output)
+    print_frequency_timeline(result);
+}
+
+void print_frequency_timeline(const BenchmarkResult& result) {
     std::lock_guard<std::mutex> lock(g_console_mutex);
-    std::cout << "\n  Frequency Timeline (100ms intervals):" << std::endl;
-    const int max_samples_to_show = 50; // Limit the number of samples to show
+    std::cout << "\n  Frequency Timeline:" << std::endl;
+    const size_t max_samples_to_show = 50; // Limit the number of samples to show
+    
+    auto print_sample = [&result](size_t i) {
+        std::cout << "    " << std::fixed << std::setprecision(0) << (result.sample_times[i] * 1000.0) << "ms: "
+                  << std::setprecision(2) << result.frequencies[i] << " MHz" << std::endl;
+    };
     
     if (result.frequencies.size() <= max_samples_to_show) {
         // Show all samples
         for (size_t i = 0; i < result.frequencies.size(); i++) {
-            std::cout << "    " << (i * 100) << "ms: " << result.frequencies[i] << " MHz" << std::endl;
+            print_sample(i);
         }
     } else {
         // Show a subset of samples
         size_t step = result.frequencies.size() / max_samples_to_show;
         for (size_t i = 0; i < result.frequencies.size(); i += step) {
-            std::cout << "    " << (i * 100) << "ms: " << result.frequencies[i] << " MHz" << std::endl;
+            print_sample(i);
         }
         // Always show the last sample
-        std::cout << "    " << ((result.frequencies.size() - 1) * 100) << "ms: " 
-                  << result.frequencies[result.frequencies.size() - 1] << " MHz" << std::endl;
+        print_sample(result.frequencies.size() - 1);
     }
 }
\ No newline at end of file
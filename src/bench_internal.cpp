@@ -0,0 +1,234 @@
+// Microbenchmarks of the tool's own hot paths: frequency reads, feature
+// checks, sample storage and statistics. Each case is timed in repetitions
+// of a calibrated batch and reported as ns/op with its spread, against the
+// live system and against a generated synthetic sysfs/procfs tree.
+
+#include "cpu_utils.h"
+#include "cpufreq_probe.h"
+#include "sample_ring.h"
+#include "steady_state.h"
+#include "synthetic_tree.h"
+#include "probe/sources.h"
+
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <ftw.h>
+#include <functional>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <unistd.h>
+#include <vector>
+
+struct BenchOptions {
+    int repetitions = 15;
+    double min_rep_ms = 20.0;       // Each repetition runs at least this long
+    std::string root;               // Empty: the live system
+    bool synthetic = true;
+    int synth_cpus = 64;
+};
+
+// Keeps results alive so the compiler cannot drop the measured call
+static volatile double g_sink;
+
+struct BenchStat {
+    double mean_ns = 0.0;
+    double stddev_ns = 0.0;
+    double min_ns = 0.0;
+    double max_ns = 0.0;
+};
+
+// Time `op` in batches of n calls; returns ns per call
+static double time_batch(const std::function<void()>& op, size_t n) {
+    auto start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < n; i++) {
+        op();
+    }
+    return std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / n;
+}
+
+static BenchStat measure(const BenchOptions& options, const std::function<void()>& op) {
+    // Grow the batch until one repetition reaches the target time
+    size_t batch = 1;
+    while (true) {
+        double ns = time_batch(op, batch);
+        if (ns * batch >= options.min_rep_ms * 1e6 || batch >= (1u << 30)) {
+            break;
+        }
+        double scale = ns > 0.0 ? options.min_rep_ms * 1e6 / (ns * batch) : 10.0;
+        batch = static_cast<size_t>(batch * std::min(10.0, std::max(2.0, scale * 1.1)));
+    }
+
+    std::vector<double> reps;
+    for (int r = 0; r < options.repetitions; r++) {
+        reps.push_back(time_batch(op, batch));
+    }
+
+    BenchStat stat;
+    stat.min_ns = reps[0];
+    stat.max_ns = reps[0];
+    for (double ns : reps) {
+        stat.mean_ns += ns;
+        stat.min_ns = std::min(stat.min_ns, ns);
+        stat.max_ns = std::max(stat.max_ns, ns);
+    }
+    stat.mean_ns /= reps.size();
+    for (double ns : reps) {
+        stat.stddev_ns += (ns - stat.mean_ns) * (ns - stat.mean_ns);
+    }
+    stat.stddev_ns = reps.size() > 1 ? std::sqrt(stat.stddev_ns / (reps.size() - 1)) : 0.0;
+    return stat;
+}
+
+static void print_header(const std::string& title) {
+    std::cout << "\n========== " << title << " ==========\n" << std::endl;
+    printf("%-40s %12s %10s %7s %12s %12s\n", "Case", "ns/op", "stddev", "CV", "min", "max");
+}
+
+static void report(const BenchOptions& options, const std::string& name, const std::function<void()>& op) {
+    BenchStat stat = measure(options, op);
+    printf("%-40s %12.1f %10.1f %6.2f%% %12.1f %12.1f\n", name.c_str(), stat.mean_ns, stat.stddev_ns,
+           stat.mean_ns > 0.0 ? stat.stddev_ns / stat.mean_ns * 100.0 : 0.0, stat.min_ns, stat.max_ns);
+}
+
+// Everything that reads sysfs/procfs, below the current filesystem root
+static void bench_readers(const BenchOptions& options, const std::string& title) {
+    int cpus = static_cast<int>(get_benchmark_cpus().size());
+    print_header(title + " (" + std::to_string(cpus) + " CPUs)");
+
+    report(options, "get_cpu_freq_mhz(0)", [] { g_sink = get_cpu_freq_mhz(0); });
+    report(options, "get_cpu_freq_mhz(0, cpuinfo)", [] { g_sink = get_cpu_freq_mhz(0, FrequencySource::CPUINFO); });
+    report(options, "get_cpu_freq_mhz(0, sysfs)", [] { g_sink = get_cpu_freq_mhz(0, FrequencySource::SYSFS); });
+    report(options, "get_cpu_freq_mhz(last)", [cpus] { g_sink = get_cpu_freq_mhz(cpus - 1); });
+    report(options, "get_all_core_frequencies()", [] { g_sink = get_all_core_frequencies().size(); });
+    report(options, "check_cpu_flag(avx512f)", [] { g_sink = check_cpu_flag("avx512f"); });
+
+    // Reader side of the embeddable sampler: a seqlock copy, no system calls
+    cfp_options probe_options;
+    cfp_options_init(&probe_options);
+    probe_options.interval_us = 1000;
+    cfp_probe* probe = nullptr;
+    if (cfp_open(&probe_options, &probe) == CFP_OK && cfp_start(probe) == CFP_OK) {
+        report(options, "cfp_read(0), sampler at 1 ms", [probe] {
+            cfp_sample sample;
+            cfp_read(probe, 0, &sample);
+            g_sink = sample.freq_khz;
+        });
+    } else {
+        printf("%-40s %12s\n", "cfp_read(0), sampler at 1 ms", "unavailable");
+    }
+    if (probe != nullptr) {
+        cfp_close(probe);
+    }
+}
+
+// In-memory sample storage and statistics, independent of the root
+static void bench_storage(const BenchOptions& options) {
+    print_header("Sample storage and statistics");
+
+    SampleRing<uint32_t> ring(600);
+    uint32_t khz = 3000000;
+    report(options, "SampleRing push (full, 600)", [&ring, &khz] { ring.push(khz++); });
+    report(options, "SampleRing push + pop", [&ring, &khz] {
+        uint32_t value = 0;
+        ring.push(khz++);
+        ring.pop(value);
+        g_sink = value;
+    });
+    while (ring.size() < ring.capacity()) {
+        ring.push(khz++);
+    }
+    std::vector<uint32_t> scratch(ring.capacity());
+    report(options, "SampleRing copy_to (600 samples)", [&ring, &scratch] { g_sink = ring.copy_to(scratch.data()); });
+
+    // What the benchmark monitor thread does per sample
+    std::vector<double> frequencies;
+    std::vector<double> times;
+    double t = 0.0;
+    report(options, "result sample push_back", [&frequencies, &times, &t] {
+        if (frequencies.size() == 1u << 20) {
+            frequencies.clear();
+            times.clear();
+        }
+        frequencies.push_back(3000.0);
+        times.push_back(t += 0.1);
+    });
+
+    SteadyStateOptions steady;
+    SteadyStateDetector detector(steady);
+    double time_sec = 0.0;
+    uint64_t n = 0;
+    report(options, "SteadyStateDetector::add_sample", [&detector, &time_sec, &n] {
+        // A small ripple keeps the detector in its steady path
+        detector.add_sample(time_sec += 0.1, 3000.0 + static_cast<double>(n++ % 5));
+    });
+}
+
+static int remove_entry(const char* path, const struct stat*, int, struct FTW*) {
+    return ::remove(path);
+}
+
+static void print_usage(const char* program_name) {
+    std::cout << "Usage: " << program_name << " [options]" << std::endl;
+    std::cout << "Options:" << std::endl;
+    std::cout << "  --help             Show this help message" << std::endl;
+    std::cout << "  --reps=N           Timed repetitions per case (default: 15)" << std::endl;
+    std::cout << "  --min-ms=MS        Minimum length of one repetition (default: 20)" << std::endl;
+    std::cout << "  --root=DIR         Benchmark the readers below DIR instead of the live system" << std::endl;
+    std::cout << "  --synth-cpus=N     CPUs in the generated synthetic tree (default: 64)" << std::endl;
+    std::cout << "  --no-synth         Skip the synthetic tree" << std::endl;
+}
+
+int main(int argc, char** argv) {
+    BenchOptions options;
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "--help" || arg == "-h") {
+            print_usage(argv[0]);
+            return 0;
+        } else if (arg.find("--reps=") == 0) {
+            options.repetitions = std::max(2, std::atoi(arg.substr(7).c_str()));
+        } else if (arg.find("--min-ms=") == 0) {
+            options.min_rep_ms = std::max(1.0, std::atof(arg.substr(9).c_str()));
+        } else if (arg.find("--root=") == 0) {
+            options.root = arg.substr(7);
+        } else if (arg.find("--synth-cpus=") == 0) {
+            options.synth_cpus = std::max(1, std::atoi(arg.substr(13).c_str()));
+        } else if (arg == "--no-synth") {
+            options.synthetic = false;
+        } else {
+            std::cerr << "Unknown option: " << arg << std::endl;
+            print_usage(argv[0]);
+            return 1;
+        }
+    }
+
+    bench_storage(options);
+
+    cfp::set_fs_root(options.root);
+    bench_readers(options, options.root.empty() ? "Live system" : "Root " + options.root);
+
+    if (options.synthetic) {
+        char dir[] = "/tmp/bench_internal.XXXXXX";
+        if (mkdtemp(dir) == nullptr) {
+            std::cerr << "Error: cannot create a directory for the synthetic tree" << std::endl;
+            return 1;
+        }
+        SyntheticTreeOptions tree;
+        tree.root = dir;
+        tree.cpus = options.synth_cpus;
+        try {
+            build_synthetic_tree(tree);
+            cfp::set_fs_root(dir);
+            bench_readers(options, "Synthetic tree");
+        } catch (const std::exception& e) {
+            std::cerr << "Error: " << e.what() << std::endl;
+        }
+        cfp::set_fs_root("");
+        nftw(dir, remove_entry, 16, FTW_DEPTH | FTW_PHYS);
+    }
+    return 0;
+}
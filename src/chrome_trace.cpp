@@ -0,0 +1,190 @@
+#include "chrome_trace.h"
+#include "cpu_utils.h"
+#include "json_writer.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdarg>
+#include <cstdio>
+#include <cstring>
+#include <map>
+#include <set>
+#include <stdexcept>
+
+void ChromeTraceWriter::begin() {
+    sink_("[", 1);
+    first_ = true;
+}
+
+void ChromeTraceWriter::end() {
+    sink_("\n]\n", 3);
+}
+
+void ChromeTraceWriter::emit(const char* format, ...) {
+    // Format into the reused buffer, growing it once if the event does not fit;
+    // an event is either written whole or not at all
+    if (event_.size() < 256) {
+        event_.resize(256);
+    }
+    va_list args;
+    va_start(args, format);
+    va_list retry;
+    va_copy(retry, args);
+    int n = vsnprintf(&event_[0], event_.size(), format, args);
+    va_end(args);
+    if (n >= 0 && static_cast<size_t>(n) >= event_.size()) {
+        event_.resize(static_cast<size_t>(n) + 1);
+        n = vsnprintf(&event_[0], event_.size(), format, retry);
+    }
+    va_end(retry);
+    if (n < 0) {
+        return;
+    }
+
+    if (first_) {
+        sink_("\n", 1);
+        first_ = false;
+    } else {
+        sink_(",\n", 2);
+    }
+    sink_(event_.data(), static_cast<size_t>(n));
+}
+
+void ChromeTraceWriter::process_name(int pid, const std::string& name) {
+    emit("{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":%d,\"args\":{\"name\":\"%s\"}}",
+         pid, json_escape(name).c_str());
+}
+
+void ChromeTraceWriter::process_sort_index(int pid, int index) {
+    emit("{\"name\":\"process_sort_index\",\"ph\":\"M\",\"pid\":%d,\"args\":{\"sort_index\":%d}}",
+         pid, index);
+}
+
+void ChromeTraceWriter::thread_name(int pid, int tid, const std::string& name) {
+    emit("{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":%d,\"tid\":%d,\"args\":{\"name\":\"%s\"}}",
+         pid, tid, json_escape(name).c_str());
+}
+
+void ChromeTraceWriter::counter(int pid, const char* name, double ts_us, const char* series, double value) {
+    emit("{\"name\":\"%s\",\"ph\":\"C\",\"pid\":%d,\"ts\":%.3f,\"args\":{\"%s\":%.3f}}",
+         json_escape(name).c_str(), pid, ts_us, json_escape(series).c_str(), value);
+}
+
+void ChromeTraceWriter::complete(int pid, int tid, const std::string& name, const char* category,
+                                 double ts_us, double dur_us, const std::string& detail) {
+    if (detail.empty()) {
+        emit("{\"name\":\"%s\",\"cat\":\"%s\",\"ph\":\"X\",\"pid\":%d,\"tid\":%d,\"ts\":%.3f,\"dur\":%.3f}",
+             json_escape(name).c_str(), category, pid, tid, ts_us, dur_us);
+    } else {
+        emit("{\"name\":\"%s\",\"cat\":\"%s\",\"ph\":\"X\",\"pid\":%d,\"tid\":%d,\"ts\":%.3f,\"dur\":%.3f,"
+             "\"args\":{\"detail\":\"%s\"}}",
+             json_escape(name).c_str(), category, pid, tid, ts_us, dur_us, json_escape(detail).c_str());
+    }
+}
+
+void ChromeTraceWriter::instant(int pid, int tid, const std::string& name, double ts_us) {
+    emit("{\"name\":\"%s\",\"ph\":\"i\",\"s\":\"t\",\"pid\":%d,\"tid\":%d,\"ts\":%.3f}",
+         json_escape(name).c_str(), pid, tid, ts_us);
+}
+
+// Track layout of a benchmark trace: one process per CPU, and one per
+// package for its power, numbered as in a --monitor trace
+static const int kKernelTid = 1;
+static const int kPhaseTid = 2;
+
+static int cpu_pid(int cpu) {
+    return cpu + 1;   // pid 0 is reserved in the viewer
+}
+
+static int package_pid(int package) {
+    return 1000000 + package;
+}
+
+void write_chrome_trace(const std::string& path, const std::vector<TraceRun>& runs) {
+    FILE* file = fopen(path.c_str(), "w");
+    if (file == nullptr) {
+        throw std::runtime_error("cannot write " + path + ": " + strerror(errno));
+    }
+    setvbuf(file, nullptr, _IOFBF, 256 * 1024);
+    ChromeTraceWriter trace([file](const char* data, size_t length) { fwrite(data, 1, length, file); });
+
+    // Common origin: the earliest TSC any run or its monitor saw
+    double tsc_hz = get_tsc_hz();
+    unsigned long long origin = ~0ULL;
+    std::set<int> cpus;
+    std::set<int> packages;
+    for (const auto& run : runs) {
+        const BenchmarkResult& result = *run.result;
+        if (result.start_tsc == 0) {
+            continue;
+        }
+        origin = std::min(origin, result.start_tsc);
+        if (result.monitor_start_tsc != 0) {
+            origin = std::min(origin, result.monitor_start_tsc);
+        }
+        cpus.insert(result.core_id);
+        if (!result.package_power_w.empty()) {
+            packages.insert(result.package_id);
+        }
+    }
+    auto to_us = [tsc_hz, origin](unsigned long long tsc) {
+        return tsc >= origin ? (tsc - origin) / tsc_hz * 1e6 : -((origin - tsc) / tsc_hz * 1e6);
+    };
+
+    trace.begin();
+    for (int cpu : cpus) {
+        trace.process_name(cpu_pid(cpu), "CPU " + std::to_string(cpu));
+        trace.process_sort_index(cpu_pid(cpu), cpu);
+        trace.thread_name(cpu_pid(cpu), kKernelTid, "Kernel");
+        trace.thread_name(cpu_pid(cpu), kPhaseTid, "Run phase");
+    }
+    for (int package : packages) {
+        trace.process_name(package_pid(package), "Package " + std::to_string(package));
+        trace.process_sort_index(package_pid(package), -1000 + package);
+    }
+
+    // Runs on one package at the same time read the same counter; only the
+    // first of them feeds the package's power track
+    std::map<int, double> power_end_us;
+
+    for (const auto& run : runs) {
+        const BenchmarkResult& result = *run.result;
+        if (result.start_tsc == 0) {
+            continue;   // Never started (unpinned worker, unsupported ISA)
+        }
+        int pid = cpu_pid(result.core_id);
+        double start_us = to_us(result.start_tsc);
+        double end_us = to_us(result.end_tsc);
+        trace.complete(pid, kKernelTid, get_instruction_set_name(run.instr_set), "kernel",
+                       start_us, end_us - start_us, run.label);
+
+        // Sample times are seconds since the run's monitor started
+        double monitor_us = result.monitor_start_tsc != 0 ? to_us(result.monitor_start_tsc) : start_us;
+        for (const auto& span : result.phases) {
+            trace.complete(pid, kPhaseTid, run_phase_name(span.phase), "phase",
+                           monitor_us + span.start_sec * 1e6, (span.end_sec - span.start_sec) * 1e6);
+        }
+        for (size_t i = 0; i < result.frequencies.size(); i++) {
+            trace.counter(pid, "Frequency", monitor_us + result.sample_times[i] * 1e6, "MHz", result.frequencies[i]);
+        }
+
+        if (!result.package_power_w.empty()) {
+            auto covered = power_end_us.find(result.package_id);
+            double first_us = monitor_us + result.power_times.front() * 1e6;
+            if (covered == power_end_us.end() || first_us >= covered->second) {
+                for (size_t i = 0; i < result.package_power_w.size(); i++) {
+                    trace.counter(package_pid(result.package_id), "Power", monitor_us + result.power_times[i] * 1e6,
+                                  "W", result.package_power_w[i]);
+                }
+                power_end_us[result.package_id] = monitor_us + result.power_times.back() * 1e6;
+            }
+        }
+    }
+    trace.end();
+
+    bool ok = ferror(file) == 0;
+    ok = fclose(file) == 0 && ok;
+    if (!ok) {
+        throw std::runtime_error("error writing " + path);
+    }
+}
@@ -0,0 +1,299 @@
+#include "compare.h"
+#include "compare_stats.h"
+#include "json_reader.h"
+#include "json_writer.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <random>
+#include <stdexcept>
+
+CompareTest string_to_compare_test(const std::string& str) {
+    if (str == "mwu" || str == "mann-whitney") {
+        return CompareTest::MANN_WHITNEY;
+    } else if (str == "bootstrap") {
+        return CompareTest::BOOTSTRAP;
+    }
+    throw std::invalid_argument("Unknown comparison test: " + str + " (expected mwu or bootstrap)");
+}
+
+static const char* compare_test_name(CompareTest test) {
+    switch(test) {
+        case CompareTest::MANN_WHITNEY:
+            return "mann-whitney";
+        case CompareTest::BOOTSTRAP:
+            return "bootstrap";
+    }
+    return "unknown";
+}
+
+// Frequencies of one stored per-core result, without an adaptive warm-up
+static BaselineCore parse_baseline_core(const JsonValue& core) {
+    BaselineCore parsed;
+    parsed.cpu = static_cast<int>(core.at("cpu").as_number());
+    parsed.instr = core.at("instr").as_string();
+    parsed.success = core.at("success").as_bool();
+    if (!parsed.success) {
+        return parsed;
+    }
+
+    double elapsed = core.at("elapsed_sec").as_number();
+    if (elapsed > 0.0) {
+        parsed.throughput = core.at("iterations").as_number() / elapsed;
+    }
+    double warmup_sec = 0.0;
+    if (const JsonValue* adaptive = core.find("adaptive")) {
+        warmup_sec = std::max(0.0, adaptive->at("warmup_sec").as_number());
+    }
+    for (const JsonValue& sample : core.at("samples").as_array()) {
+        const std::vector<JsonValue>& pair = sample.as_array();
+        if (pair.size() != 2) {
+            throw std::runtime_error("sample is not a [seconds, MHz] pair");
+        }
+        if (pair[0].as_number() >= warmup_sec) {
+            parsed.frequencies.push_back(pair[1].as_number());
+        }
+    }
+    return parsed;
+}
+
+BaselineReport load_baseline_report(const std::string& path) {
+    std::ifstream file(path);
+    if (!file.is_open()) {
+        throw std::runtime_error("cannot open baseline " + path);
+    }
+
+    BaselineReport report;
+    try {
+        JsonValue root = JsonValue::parse(file);
+        report.scenario_path = root.at("scenario").as_string();
+        for (const JsonValue& phase : root.at("phases").as_array()) {
+            BaselinePhase parsed;
+            parsed.name = phase.at("name").as_string();
+            for (const JsonValue& core : phase.at("cores").as_array()) {
+                parsed.cores.push_back(parse_baseline_core(core));
+            }
+            report.phases.push_back(std::move(parsed));
+        }
+    } catch (const std::exception& e) {
+        throw std::runtime_error(path + ": " + e.what());
+    }
+    return report;
+}
+
+static double median(std::vector<double> values) {
+    std::sort(values.begin(), values.end());
+    size_t mid = values.size() / 2;
+    return values.size() % 2 == 1 ? values[mid] : (values[mid - 1] + values[mid]) / 2.0;
+}
+
+static double mean(const std::vector<double>& values) {
+    double sum = 0.0;
+    for (double v : values) {
+        sum += v;
+    }
+    return sum / values.size();
+}
+
+static CoreComparison compare_core(const BaselineCore& baseline, const std::vector<double>& current,
+                                   double current_throughput, const CompareOptions& options) {
+    CoreComparison comparison;
+    comparison.cpu = baseline.cpu;
+    comparison.instr = baseline.instr;
+    comparison.baseline_samples = baseline.frequencies.size();
+    comparison.current_samples = current.size();
+    if (baseline.throughput > 0.0 && current_throughput > 0.0) {
+        comparison.throughput_change_pct = (current_throughput / baseline.throughput - 1.0) * 100.0;
+    }
+    if (current.empty()) {
+        comparison.missing = true;
+        comparison.regression = true;
+        return comparison;
+    }
+    if (baseline.frequencies.empty()) {
+        comparison.no_baseline = true;  // Nothing to test against
+        return comparison;
+    }
+
+    switch(options.test) {
+        case CompareTest::MANN_WHITNEY:
+            comparison.baseline_mhz = median(baseline.frequencies);
+            comparison.current_mhz = median(current);
+            comparison.p_value = mann_whitney_p_value(baseline.frequencies, current);
+            comparison.significant = comparison.p_value < options.alpha;
+            break;
+        case CompareTest::BOOTSTRAP:
+            comparison.baseline_mhz = mean(baseline.frequencies);
+            comparison.current_mhz = mean(current);
+            bootstrap_change_ci(baseline.frequencies, current, options.alpha, options.bootstrap_rounds,
+                                comparison.ci_low_pct, comparison.ci_high_pct);
+            comparison.significant = comparison.ci_low_pct > 0.0 || comparison.ci_high_pct < 0.0;
+            break;
+    }
+    if (comparison.baseline_mhz > 0.0) {
+        comparison.change_pct = (comparison.current_mhz / comparison.baseline_mhz - 1.0) * 100.0;
+    }
+    comparison.regression = comparison.significant && comparison.change_pct < -options.threshold_pct;
+    return comparison;
+}
+
+std::vector<CoreComparison> compare_with_baseline(const BaselineReport& baseline,
+                                                  const Scenario& scenario,
+                                                  const std::vector<PhaseResult>& phase_results,
+                                                  const CompareOptions& options) {
+    if (baseline.phases.size() != phase_results.size()) {
+        throw std::runtime_error("baseline has " + std::to_string(baseline.phases.size()) +
+                                 " phases but the scenario has " + std::to_string(phase_results.size()));
+    }
+
+    std::vector<CoreComparison> comparisons;
+    for (size_t i = 0; i < phase_results.size(); i++) {
+        const BaselinePhase& baseline_phase = baseline.phases[i];
+        const PhaseResult& phase_result = phase_results[i];
+        if (baseline_phase.name != scenario.phases[i].name) {
+            throw std::runtime_error("phase " + std::to_string(i + 1) + " is '" + scenario.phases[i].name +
+                                     "' but the baseline has '" + baseline_phase.name + "'");
+        }
+
+        for (const BaselineCore& baseline_core : baseline_phase.cores) {
+            if (!baseline_core.success) {
+                continue;   // Nothing to regress from
+            }
+
+            std::vector<double> current;
+            double current_throughput = 0.0;
+            for (size_t j = 0; j < phase_result.results.size(); j++) {
+                const BenchmarkResult& result = phase_result.results[j];
+                if (result.core_id != baseline_core.cpu || !result.success ||
+                    get_instruction_set_name(phase_result.assignments[j].instr_set) != baseline_core.instr) {
+                    continue;
+                }
+                double warmup_sec = result.adaptive ? std::max(0.0, result.warmup_sec) : 0.0;
+                for (size_t k = 0; k < result.frequencies.size(); k++) {
+                    if (result.sample_times[k] >= warmup_sec) {
+                        current.push_back(result.frequencies[k]);
+                    }
+                }
+                if (result.elapsed_sec > 0.0) {
+                    current_throughput = result.total_iterations / result.elapsed_sec;
+                }
+            }
+
+            CoreComparison comparison = compare_core(baseline_core, current, current_throughput, options);
+            comparison.phase = baseline_phase.name;
+            comparisons.push_back(std::move(comparison));
+        }
+    }
+    return comparisons;
+}
+
+void print_comparison(const std::vector<CoreComparison>& comparisons, const CompareOptions& options) {
+    std::cout << "\n========== Comparison with " << options.baseline_path << " ==========\n" << std::endl;
+    printf("%-20s %5s %-12s %12s %12s %9s %18s %9s  %s\n",
+           "Phase", "CPU", "ISA", "Base MHz", "Now MHz", "Change",
+           options.test == CompareTest::MANN_WHITNEY ? "p-value" : "CI", "dIter", "Verdict");
+
+    int regressions = 0;
+    for (const auto& comparison : comparisons) {
+        if (comparison.missing) {
+            printf("%-20.20s %5d %-12s %12s %12s %9s %18s %9s  %s\n",
+                   comparison.phase.c_str(), comparison.cpu, comparison.instr.c_str(),
+                   "-", "-", "-", "-", "-", "REGRESSION (no result)");
+            regressions++;
+            continue;
+        }
+        if (comparison.no_baseline) {
+            printf("%-20.20s %5d %-12s %12s %12s %9s %18s %9s  %s\n",
+                   comparison.phase.c_str(), comparison.cpu, comparison.instr.c_str(),
+                   "-", "-", "-", "-", "-", "no baseline samples");
+            continue;
+        }
+
+        char test_value[32];
+        if (options.test == CompareTest::MANN_WHITNEY) {
+            snprintf(test_value, sizeof(test_value), "%.4g", comparison.p_value);
+        } else {
+            snprintf(test_value, sizeof(test_value), "[%+.2f%%, %+.2f%%]", comparison.ci_low_pct, comparison.ci_high_pct);
+        }
+        char change[16];
+        snprintf(change, sizeof(change), "%+.2f%%", comparison.change_pct);
+        char throughput_change[16];
+        snprintf(throughput_change, sizeof(throughput_change), "%+.2f%%", comparison.throughput_change_pct);
+
+        const char* verdict = "ok";
+        if (comparison.regression) {
+            verdict = "REGRESSION";
+            regressions++;
+        } else if (comparison.significant && comparison.change_pct < 0.0) {
+            verdict = "slower, within threshold";
+        } else if (comparison.significant && comparison.change_pct > 0.0) {
+            verdict = "faster";
+        }
+
+        printf("%-20.20s %5d %-12s %12.2f %12.2f %9s %18s %9s  %s\n",
+               comparison.phase.c_str(), comparison.cpu, comparison.instr.c_str(),
+               comparison.baseline_mhz, comparison.current_mhz, change, test_value, throughput_change, verdict);
+    }
+
+    std::cout << "\nMHz is the " << (options.test == CompareTest::MANN_WHITNEY ? "median" : "mean")
+              << " frequency after warm-up; a regression is a significant drop (alpha "
+              << options.alpha << ") of more than " << options.threshold_pct << "%." << std::endl;
+    std::cout << "dIter is the change in kernel throughput and is not tested." << std::endl;
+    std::cout << regressions << " regression(s) in " << comparisons.size() << " comparison(s)" << std::endl;
+}
+
+void write_comparison_report(std::ostream& out, const std::vector<CoreComparison>& comparisons,
+                             const CompareOptions& options, const std::string& scenario_path) {
+    JsonWriter json(out);
+
+    int regressions = 0;
+    for (const auto& comparison : comparisons) {
+        regressions += comparison.regression ? 1 : 0;
+    }
+
+    json.begin_object();
+    json.field("tool", "cpu_instr_freq");
+    json.field("baseline", options.baseline_path);
+    json.field("scenario", scenario_path);
+    json.field("test", compare_test_name(options.test));
+    json.field("alpha", options.alpha);
+    json.field("threshold_pct", options.threshold_pct);
+    json.field("regressions", regressions);
+
+    json.key("comparisons").begin_array();
+    for (const auto& comparison : comparisons) {
+        json.begin_object();
+        json.field("phase", comparison.phase);
+        json.field("cpu", comparison.cpu);
+        json.field("instr", comparison.instr);
+        json.field("regression", comparison.regression);
+        if (comparison.missing) {
+            json.field("missing", true);
+            json.end_object();
+            continue;
+        }
+        json.field("baseline_samples", comparison.baseline_samples);
+        json.field("current_samples", comparison.current_samples);
+        if (comparison.no_baseline) {
+            json.field("no_baseline_samples", true);
+            json.end_object();
+            continue;
+        }
+        json.field("baseline_mhz", comparison.baseline_mhz);
+        json.field("current_mhz", comparison.current_mhz);
+        json.field("change_pct", comparison.change_pct);
+        if (options.test == CompareTest::MANN_WHITNEY) {
+            json.field("p_value", comparison.p_value);
+        } else {
+            json.key("ci_pct").begin_array(true).value(comparison.ci_low_pct).value(comparison.ci_high_pct).end_array();
+        }
+        json.field("significant", comparison.significant);
+        json.field("throughput_change_pct", comparison.throughput_change_pct);
+        json.end_object();
+    }
+    json.end_array();
+    json.end_object();
+}
@@ -0,0 +1,91 @@
+#include "compare_stats.h"
+
+#include <algorithm>
+#include <cmath>
+#include <random>
+
+double mann_whitney_p_value(const std::vector<double>& a, const std::vector<double>& b) {
+    size_t n1 = a.size();
+    size_t n2 = b.size();
+    if (n1 == 0 || n2 == 0) {
+        return 1.0;
+    }
+
+    // Rank the pooled samples, ties get their average rank
+    std::vector<std::pair<double, int>> pooled;
+    pooled.reserve(n1 + n2);
+    for (double v : a) {
+        pooled.push_back({v, 0});
+    }
+    for (double v : b) {
+        pooled.push_back({v, 1});
+    }
+    std::sort(pooled.begin(), pooled.end());
+
+    double rank_sum_a = 0.0;
+    double tie_term = 0.0;          // Sum of t^3 - t over tie groups
+    size_t i = 0;
+    while (i < pooled.size()) {
+        size_t j = i;
+        while (j < pooled.size() && pooled[j].first == pooled[i].first) {
+            j++;
+        }
+        double average_rank = (i + 1 + j) / 2.0;
+        for (size_t k = i; k < j; k++) {
+            if (pooled[k].second == 0) {
+                rank_sum_a += average_rank;
+            }
+        }
+        double t = static_cast<double>(j - i);
+        tie_term += t * t * t - t;
+        i = j;
+    }
+
+    double n = static_cast<double>(n1 + n2);
+    double u = rank_sum_a - n1 * (n1 + 1) / 2.0;
+    double mean_u = n1 * n2 / 2.0;
+    double var_u = n1 * n2 / 12.0 * ((n + 1) - tie_term / (n * (n - 1)));
+    if (var_u <= 0.0) {
+        return 1.0;                 // Every sample identical
+    }
+    // Continuity-corrected normal approximation
+    double z = (std::fabs(u - mean_u) - 0.5) / std::sqrt(var_u);
+    if (z < 0.0) {
+        z = 0.0;
+    }
+    return std::erfc(z / std::sqrt(2.0));
+}
+
+void bootstrap_change_ci(const std::vector<double>& baseline, const std::vector<double>& current,
+                         double alpha, int rounds, double& low_pct, double& high_pct) {
+    low_pct = 0.0;
+    high_pct = 0.0;
+    if (baseline.empty() || current.empty()) {
+        return;
+    }
+
+    std::mt19937_64 rng(0x5eedULL);
+    std::uniform_int_distribution<size_t> pick_baseline(0, baseline.size() - 1);
+    std::uniform_int_distribution<size_t> pick_current(0, current.size() - 1);
+
+    rounds = std::max(rounds, 100);
+    std::vector<double> changes(rounds);
+    for (int r = 0; r < rounds; r++) {
+        double baseline_sum = 0.0;
+        for (size_t k = 0; k < baseline.size(); k++) {
+            baseline_sum += baseline[pick_baseline(rng)];
+        }
+        double current_sum = 0.0;
+        for (size_t k = 0; k < current.size(); k++) {
+            current_sum += current[pick_current(rng)];
+        }
+        double baseline_mean = baseline_sum / baseline.size();
+        double current_mean = current_sum / current.size();
+        changes[r] = baseline_mean > 0.0 ? (current_mean / baseline_mean - 1.0) * 100.0 : 0.0;
+    }
+    std::sort(changes.begin(), changes.end());
+    size_t low = static_cast<size_t>(std::floor(alpha / 2.0 * (rounds - 1)));
+    size_t high = static_cast<size_t>(std::ceil((1.0 - alpha / 2.0) * (rounds - 1)));
+    low_pct = changes[low];
+    high_pct = changes[std::min(high, changes.size() - 1)];
+}
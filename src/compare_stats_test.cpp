@@ -0,0 +1,107 @@
+// Checks the statistics behind --compare on inputs with a known answer:
+// identical samples, a clear shift, and tie-heavy samples quantized to the
+// 100 MHz steps real frequency readings come in. Exits non-zero on failure.
+
+#include "compare_stats.h"
+
+#include <cmath>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+static int g_failures = 0;
+
+static void check(bool ok, const char* what, double value) {
+    printf("%-4s %-60s %g\n", ok ? "ok" : "FAIL", what, value);
+    if (!ok) {
+        g_failures++;
+    }
+}
+
+// n normal samples around mean_mhz, rounded to step_mhz (0: not rounded).
+// Box-Muller on the raw engine output, since the standard distributions may
+// differ between standard libraries and the expectations rely on the draws.
+static std::vector<double> samples(unsigned seed, size_t n, double mean_mhz, double stddev_mhz, double step_mhz) {
+    const double pi = 3.14159265358979323846;
+    std::mt19937_64 rng(seed);
+    auto uniform = [&rng]() { return ((rng() >> 11) + 0.5) * 0x1.0p-53; };
+    std::vector<double> values(n);
+    for (double& v : values) {
+        v = mean_mhz + stddev_mhz * std::sqrt(-2.0 * std::log(uniform())) * std::cos(2.0 * pi * uniform());
+        if (step_mhz > 0.0) {
+            v = std::round(v / step_mhz) * step_mhz;
+        }
+    }
+    return values;
+}
+
+int main() {
+    const double alpha = 0.05;
+    const int rounds = 2000;
+    double low = 0.0;
+    double high = 0.0;
+
+    std::vector<double> base = samples(1, 200, 3000.0, 20.0, 0.0);
+    std::vector<double> shifted = samples(2, 200, 2900.0, 20.0, 0.0);
+    std::vector<double> same_dist = samples(3, 200, 3000.0, 20.0, 0.0);
+
+    double p = mann_whitney_p_value(base, base);
+    check(p == 1.0, "mwu: identical samples give p = 1", p);
+
+    std::vector<double> flat(50, 3000.0);
+    p = mann_whitney_p_value(flat, flat);
+    check(p == 1.0, "mwu: identical constant samples give p = 1", p);
+
+    p = mann_whitney_p_value(base, {});
+    check(p == 1.0, "mwu: an empty side gives p = 1", p);
+
+    p = mann_whitney_p_value(base, shifted);
+    check(p < alpha, "mwu: a 100 MHz shift is significant", p);
+    check(mann_whitney_p_value(shifted, base) == p, "mwu: the test is symmetric", p);
+
+    p = mann_whitney_p_value(base, same_dist);
+    check(p > alpha, "mwu: two draws of one distribution are not significant", p);
+
+    // Mostly one or two distinct values: the tie correction carries the test
+    std::vector<double> ties_base = samples(4, 300, 3000.0, 60.0, 100.0);
+    std::vector<double> ties_shifted = samples(5, 300, 2900.0, 60.0, 100.0);
+    std::vector<double> ties_same = samples(6, 300, 3000.0, 60.0, 100.0);
+    p = mann_whitney_p_value(ties_base, ties_shifted);
+    check(p < alpha, "mwu: a shift of quantized samples is significant", p);
+    p = mann_whitney_p_value(ties_base, ties_same);
+    check(p > alpha && p <= 1.0, "mwu: quantized draws of one distribution are not", p);
+
+    std::vector<double> two_levels_a(100);
+    std::vector<double> two_levels_b(100);
+    for (size_t i = 0; i < 100; i++) {
+        two_levels_a[i] = i < 90 ? 3000.0 : 2900.0;
+        two_levels_b[i] = i < 10 ? 3000.0 : 2900.0;
+    }
+    p = mann_whitney_p_value(two_levels_a, two_levels_b);
+    check(p < alpha && std::isfinite(p), "mwu: two-level samples with opposite majorities", p);
+
+    bootstrap_change_ci(base, base, alpha, rounds, low, high);
+    check(low <= 0.0 && high >= 0.0, "bootstrap: identical samples, CI holds 0 (low)", low);
+    check(high - low < 0.5, "bootstrap: identical samples, CI is narrow (width)", high - low);
+
+    bootstrap_change_ci(base, shifted, alpha, rounds, low, high);
+    check(high < 0.0, "bootstrap: a 100 MHz drop lies below 0 (high)", high);
+    check(low > -4.0 && high < -2.5, "bootstrap: the CI lies near the true -3.3% (low)", low);
+
+    bootstrap_change_ci(ties_base, ties_shifted, alpha, rounds, low, high);
+    check(high < 0.0, "bootstrap: a drop of quantized samples lies below 0 (high)", high);
+
+    double repeat_low = 0.0;
+    double repeat_high = 0.0;
+    bootstrap_change_ci(ties_base, ties_shifted, alpha, rounds, repeat_low, repeat_high);
+    check(repeat_low == low && repeat_high == high, "bootstrap: seeded, so repeatable", repeat_low);
+
+    bootstrap_change_ci(base, {}, alpha, rounds, low, high);
+    check(low == 0.0 && high == 0.0, "bootstrap: an empty side gives [0, 0]", low);
+
+    if (g_failures > 0) {
+        printf("%d check(s) failed\n", g_failures);
+        return 1;
+    }
+    return 0;
+}
@@ -1,4 +1,6 @@
 #include "cpu_utils.h"
+#include "topology.h"
+#include "probe/sources.h"
 
 #include <iostream>
 #include <fstream>
@@ -7,15 +9,18 @@
 #include <chrono>
 #include <vector>
 #include <string>
-#include <regex>
-#include <pthread.h>
 #include <map>
 #include <mutex>
 #include <functional>
+#include <stdexcept>
+#include <algorithm>
+#include <dirent.h>
+#include <unistd.h>
 
 // Use a more cautious approach for cpuid
 #if defined(__x86_64__) || defined(_M_X64) || defined(__i386) || defined(_M_IX86)
 #include <cpuid.h>
+#include <x86intrin.h>
 #define HAS_CPUID 1
 #else
 #define HAS_CPUID 0
@@ -45,65 +50,280 @@ void safe_cpuid(unsigned int leaf, unsigned int subleaf, unsigned int* eax, unsi
 #endif
 }
 
-void pin_to_core(int core_id) {
-    cpu_set_t cpuset;
-    CPU_ZERO(&cpuset);
-    CPU_SET(core_id, &cpuset);
-    
-    pthread_t current_thread = pthread_self();
-    int result = pthread_setaffinity_np(current_thread, sizeof(cpu_set_t), &cpuset);
-    
-    if (result != 0) {
+unsigned long long read_tsc() {
+#if HAS_CPUID
+    return __rdtsc();
+#else
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+#endif
+}
+
+static double calibrate_tsc_hz() {
+#if HAS_CPUID
+    // Measure TSC ticks against steady_clock over a short window
+    const auto window = std::chrono::milliseconds(50);
+    auto start_time = std::chrono::steady_clock::now();
+    unsigned long long start_tsc = read_tsc();
+    std::this_thread::sleep_for(window);
+    unsigned long long end_tsc = read_tsc();
+    auto end_time = std::chrono::steady_clock::now();
+
+    double elapsed_sec = std::chrono::duration<double>(end_time - start_time).count();
+    return (end_tsc - start_tsc) / elapsed_sec;
+#else
+    return 1e9;
+#endif
+}
+
+double get_tsc_hz() {
+    static const double tsc_hz = calibrate_tsc_hz();
+    return tsc_hz;
+}
+
+bool try_pin_to_core(int core_id) {
+    return cfp::pin_thread_to_cpu(core_id);
+}
+
+bool pin_to_core(int core_id) {
+    if (!try_pin_to_core(core_id)) {
         std::cerr << "Error pinning thread to core " << core_id << std::endl;
-        exit(1);
+        return false;
     }
     
     std::cout << "Pinned to core " << core_id << std::endl;
+    return true;
 }
 
 int get_core_count() {
-    return std::thread::hardware_concurrency();
+    return static_cast<int>(get_benchmark_cpus().size());
 }
 
 int get_max_core_id() {
-    return get_core_count() - 1;
+    std::vector<int> cpus = get_benchmark_cpus();
+    return cpus.empty() ? -1 : cpus.back();
 }
 
-// Read CPU frequency from /proc/cpuinfo for a specific core
-double get_cpu_freq_mhz(int core_id) {
-    std::ifstream cpuinfo("/proc/cpuinfo");
+
+std::string get_cpu_status_name(CpuStatus status) {
+    switch (status) {
+        case CpuStatus::USABLE:
+            return "usable";
+        case CpuStatus::OFFLINE:
+            return "offline";
+        case CpuStatus::OUTSIDE_CPUSET:
+            return "outside cgroup cpuset";
+        case CpuStatus::OUTSIDE_AFFINITY:
+            return "outside affinity mask";
+    }
+    return "unknown";
+}
+
+// Parse a sysfs/cgroupfs CPU list file; false if it is missing, empty or malformed
+static bool read_cpu_list_file(const std::string& path, std::vector<int>& cpus) {
+    std::ifstream file(path);
+    std::string line;
+    if (!std::getline(file, line) || line.find_first_not_of(" \t\n") == std::string::npos) {
+        return false;
+    }
+    try {
+        cpus = parse_cpu_list(line);
+    } catch (const std::invalid_argument&) {
+        return false;
+    }
+    return true;
+}
+
+// Every CPU the kernel could bring up: the possible list, else the cpuN
+// directories, else one per hardware thread
+static std::vector<int> read_possible_cpus() {
+    std::vector<int> cpus;
+    if (read_cpu_list_file(cfp::fs_path("/sys/devices/system/cpu/possible"), cpus)) {
+        return cpus;
+    }
+    if (DIR* dir = opendir(cfp::fs_path("/sys/devices/system/cpu").c_str())) {
+        while (struct dirent* entry = readdir(dir)) {
+            int cpu;
+            char tail;
+            if (sscanf(entry->d_name, "cpu%d%c", &cpu, &tail) == 1) {
+                cpus.push_back(cpu);
+            }
+        }
+        closedir(dir);
+        std::sort(cpus.begin(), cpus.end());
+    }
+    if (cpus.empty()) {
+        int count = std::max(1u, std::thread::hardware_concurrency());
+        for (int cpu = 0; cpu < count; cpu++) {
+            cpus.push_back(cpu);
+        }
+    }
+    return cpus;
+}
+
+// Effective cpuset of the cgroup this process lives in, from /proc/self/cgroup.
+// Handles the unified (v2) hierarchy and the v1 cpuset controller.
+static bool read_cgroup_cpuset(std::vector<int>& cpus) {
+    std::ifstream cgroup(cfp::fs_path("/proc/self/cgroup"));
     std::string line;
-    std::regex cpu_mhz_regex("^cpu MHz\\s+:\\s+([0-9]+\\.[0-9]+)$");
-    std::smatch match;
+    while (std::getline(cgroup, line)) {
+        size_t first = line.find(':');
+        size_t second = line.find(':', first + 1);
+        if (first == std::string::npos || second == std::string::npos) {
+            continue;
+        }
+        std::string controllers = "," + line.substr(first + 1, second - first - 1) + ",";
+        std::string path = line.substr(second + 1);
+        if (path == "/") {
+            path.clear();
+        }
 
-    int current_core = -1;
-    double frequency = 0.0;
+        if (controllers == ",,") {
+            if (read_cpu_list_file(cfp::fs_path("/sys/fs/cgroup" + path + "/cpuset.cpus.effective"), cpus)) {
+                return true;
+            }
+        } else if (controllers.find(",cpuset,") != std::string::npos) {
+            std::string dir = cfp::fs_path("/sys/fs/cgroup/cpuset" + path);
+            if (read_cpu_list_file(dir + "/cpuset.effective_cpus", cpus) ||
+                read_cpu_list_file(dir + "/cpuset.cpus", cpus)) {
+                return true;
+            }
+        }
+    }
+    return false;
+}
 
-    while (std::getline(cpuinfo, line)) {
-        if (line.find("processor") != std::string::npos) {
-            std::string core_str = line.substr(line.find(":") + 1);
-            core_str.erase(0, core_str.find_first_not_of(" \t"));
-            current_core = std::stoi(core_str);
+// Affinity of the process as it was started (e.g. by taskset). Captured once,
+// before any benchmark pins the main thread to a single CPU.
+static const std::vector<int>& startup_affinity() {
+    static const std::vector<int> cpus = cfp::thread_affinity();
+    return cpus;
+}
+
+static std::map<int, CpuStatus> read_cpu_availability() {
+    std::map<int, CpuStatus> availability;
+    std::vector<int> possible = read_possible_cpus();
+    for (int cpu : possible) {
+        availability[cpu] = CpuStatus::USABLE;
+    }
+
+    // Each filter only marks CPUs still usable, so a CPU reports the first
+    // reason it was excluded
+    auto exclude_missing = [&availability](const std::vector<int>& allowed, CpuStatus status) {
+        for (auto& [cpu, current] : availability) {
+            if (current == CpuStatus::USABLE && !std::binary_search(allowed.begin(), allowed.end(), cpu)) {
+                current = status;
+            }
         }
-        
-        if (current_core == core_id && std::regex_search(line, match, cpu_mhz_regex)) {
-            frequency = std::stod(match[1]);
-            break;
+    };
+
+    std::vector<int> allowed;
+    if (read_cpu_list_file(cfp::fs_path("/sys/devices/system/cpu/online"), allowed)) {
+        exclude_missing(allowed, CpuStatus::OFFLINE);
+    }
+    if (read_cgroup_cpuset(allowed)) {
+        exclude_missing(allowed, CpuStatus::OUTSIDE_CPUSET);
+    }
+    // A synthetic tree describes its own CPUs; the host's mask does not apply
+    if (cfp::fs_root().empty() && !startup_affinity().empty()) {
+        exclude_missing(startup_affinity(), CpuStatus::OUTSIDE_AFFINITY);
+    }
+    return availability;
+}
+
+// Availability is read once per fs root: the online list, cpuset and affinity
+// do not change under a run, and callers such as the all-core samplers ask
+// for the CPU list on every pass
+struct CpuAvailabilityCache {
+    std::mutex mutex;
+    bool valid = false;
+    std::string root;
+    std::map<int, CpuStatus> availability;
+    std::vector<int> usable;
+};
+
+static CpuAvailabilityCache& cpu_availability_cache() {
+    static CpuAvailabilityCache cache;
+    std::string root = cfp::fs_root();
+    std::lock_guard<std::mutex> lock(cache.mutex);
+    if (!cache.valid || cache.root != root) {
+        cache.availability = read_cpu_availability();
+        cache.usable.clear();
+        for (const auto& [cpu, status] : cache.availability) {
+            if (status == CpuStatus::USABLE) {
+                cache.usable.push_back(cpu);
+            }
         }
+        cache.root = root;
+        cache.valid = true;
+    }
+    return cache;
+}
+
+std::map<int, CpuStatus> get_cpu_availability() {
+    CpuAvailabilityCache& cache = cpu_availability_cache();
+    std::lock_guard<std::mutex> lock(cache.mutex);
+    return cache.availability;
+}
+
+std::vector<int> get_benchmark_cpus() {
+    CpuAvailabilityCache& cache = cpu_availability_cache();
+    std::lock_guard<std::mutex> lock(cache.mutex);
+    return cache.usable;
+}
+
+FrequencySource string_to_frequency_source(const std::string& str) {
+    if (str == "auto") {
+        return FrequencySource::AUTO;
+    } else if (str == "cpuinfo") {
+        return FrequencySource::CPUINFO;
+    } else if (str == "sysfs") {
+        return FrequencySource::SYSFS;
+    }
+    throw std::invalid_argument("Unknown frequency source: " + str + " (expected auto, cpuinfo or sysfs)");
+}
+
+std::string get_frequency_source_name(FrequencySource source) {
+    switch(source) {
+        case FrequencySource::AUTO:
+            return "auto";
+        case FrequencySource::CPUINFO:
+            return "cpuinfo";
+        case FrequencySource::SYSFS:
+            return "sysfs";
+    }
+    return "unknown";
+}
+
+// Read CPU frequency from /proc/cpuinfo for a specific core
+static double read_cpuinfo_freq_mhz(int core_id) {
+    return cfp::read_cpuinfo_mhz(core_id);
+}
+
+// Read /sys/devices/system/cpu/cpu<core_id>/cpufreq/scaling_cur_freq
+static double read_sysfs_freq_mhz(int core_id) {
+    return cfp::read_sysfs_mhz(core_id);
+}
+
+double get_cpu_freq_mhz(int core_id) {
+    return get_cpu_freq_mhz(core_id, FrequencySource::AUTO);
+}
+
+double get_cpu_freq_mhz(int core_id, FrequencySource source) {
+    switch(source) {
+        case FrequencySource::CPUINFO:
+            return read_cpuinfo_freq_mhz(core_id);
+        case FrequencySource::SYSFS:
+            return read_sysfs_freq_mhz(core_id);
+        case FrequencySource::AUTO:
+            break;
     }
     
+    double frequency = read_cpuinfo_freq_mhz(core_id);
+    
     // If we couldn't find the frequency, try an alternative method
     if (frequency == 0.0) {
-        // Try to read from /sys/devices/system/cpu/cpu<core_id>/cpufreq/scaling_cur_freq
-        std::stringstream path;
-        path << "/sys/devices/system/cpu/cpu" << core_id << "/cpufreq/scaling_cur_freq";
-        
-        std::ifstream freqFile(path.str());
-        if (freqFile.is_open()) {
-            long freqKHz;
-            freqFile >> freqKHz;
-            frequency = freqKHz / 1000.0; // Convert from KHz to MHz
-        }
+        frequency = read_sysfs_freq_mhz(core_id);
     }
     
     return frequency;
@@ -123,9 +343,10 @@ std::vector<double> monitor_cpu_freq(int core_id, int duration_ms, int sampling_
 }
 
 // A safer, alternative way to check for CPU features on Linux 
-// by reading /proc/cpuinfo directly instead of executing CPUID
+// by reading /proc/cpuinfo directly instead of executing CPUID.
+// Used as the feature source when CPUID is not available.
 bool check_cpu_flag(const std::string& flag) {
-    std::ifstream cpuinfo("/proc/cpuinfo");
+    std::ifstream cpuinfo(cfp::fs_path("/proc/cpuinfo"));
     std::string line;
     
     while (std::getline(cpuinfo, line)) {
@@ -136,37 +357,99 @@ bool check_cpu_flag(const std::string& flag) {
     return false;
 }
 
-// CPU feature detection using alternative methods
+#if HAS_CPUID
+// Read an extended control register. Emitted as raw bytes so this file
+// does not need -mxsave.
+static unsigned long long read_xcr0() {
+    unsigned int eax = 0, edx = 0;
+    asm volatile(".byte 0x0f, 0x01, 0xd0" : "=a"(eax), "=d"(edx) : "c"(0));
+    return (static_cast<unsigned long long>(edx) << 32) | eax;
+}
+#endif
+
+static CpuFeatures detect_cpu_features() {
+    CpuFeatures features;
+
+#if HAS_CPUID
+    unsigned int eax, ebx, ecx, edx;
+
+    safe_cpuid(1, 0, &eax, &ebx, &ecx, &edx);
+    features.sse = (edx >> 25) & 1;
+    features.sse2 = (edx >> 26) & 1;
+    bool osxsave = (ecx >> 27) & 1;
+    bool cpu_avx = (ecx >> 28) & 1;
+    bool cpu_fma = (ecx >> 12) & 1;
+
+    safe_cpuid(7, 0, &eax, &ebx, &ecx, &edx);
+    bool cpu_avx2 = (ebx >> 5) & 1;
+    bool cpu_avx512f = (ebx >> 16) & 1;
+    bool cpu_amx_bf16 = (edx >> 22) & 1;
+    bool cpu_amx_tile = (edx >> 24) & 1;
+
+    // The OS must also save the wider register state on context switch
+    unsigned long long xcr0 = osxsave ? read_xcr0() : 0;
+    bool os_avx = (xcr0 & 0x6) == 0x6;              // XMM | YMM
+    bool os_avx512 = (xcr0 & 0xe6) == 0xe6;         // + opmask | ZMM_Hi256 | Hi16_ZMM
+    bool os_amx = (xcr0 & 0x60000) == 0x60000;      // XTILECFG | XTILEDATA
+
+    features.avx = cpu_avx && os_avx;
+    features.fma = cpu_fma && os_avx;
+    features.avx2 = cpu_avx2 && os_avx;
+    features.avx512f = cpu_avx512f && os_avx512;
+    features.amx_tile = cpu_amx_tile && os_amx;
+    features.amx_bf16 = cpu_amx_bf16 && os_amx;
+#else
+    features.sse = check_cpu_flag("sse");
+    features.sse2 = check_cpu_flag("sse2");
+    features.avx = check_cpu_flag("avx");
+    features.avx2 = check_cpu_flag("avx2");
+    features.fma = check_cpu_flag("fma");
+    features.avx512f = check_cpu_flag("avx512f");
+    features.amx_tile = check_cpu_flag("amx_tile");
+    features.amx_bf16 = check_cpu_flag("amx_bf16");
+#endif
+
+    return features;
+}
+
+const CpuFeatures& get_cpu_features() {
+    static const CpuFeatures features = detect_cpu_features();
+    return features;
+}
+
+// CPU feature detection backed by the cached feature set
 bool has_sse() {
-    return check_cpu_flag("sse");
+    return get_cpu_features().sse;
 }
 
 bool has_sse2() {
-    return check_cpu_flag("sse2");
+    return get_cpu_features().sse2;
 }
 
 bool has_avx() {
-    return check_cpu_flag("avx");
+    return get_cpu_features().avx;
 }
 
 bool has_avx2() {
-    return check_cpu_flag("avx2");
+    return get_cpu_features().avx2;
 }
 
 bool has_avx512f() {
-    return check_cpu_flag("avx512f");
+    return get_cpu_features().avx512f;
 }
 
 bool has_amx() {
-    return check_cpu_flag("amx_bf16") || check_cpu_flag("amx_tile");
+    return get_cpu_features().amx_bf16 || get_cpu_features().amx_tile;
 }
 
 // Collect frequencies from all available cores
 std::map<int, double> get_all_core_frequencies() {
+    return get_all_core_frequencies(get_benchmark_cpus());
+}
+
+std::map<int, double> get_all_core_frequencies(const std::vector<int>& cpus) {
     std::map<int, double> all_frequencies;
-    int core_count = get_core_count();
-    
-    for (int core_id = 0; core_id < core_count; core_id++) {
+    for (int core_id : cpus) {
         all_frequencies[core_id] = get_cpu_freq_mhz(core_id);
     }
     
@@ -176,11 +459,11 @@ std::map<int, double> get_all_core_frequencies() {
 // Monitor frequencies of all cores over time
 std::map<int, std::vector<double>> monitor_all_cpu_freq(int duration_ms, int sampling_interval_ms) {
     std::map<int, std::vector<double>> all_frequencies;
-    int core_count = get_core_count();
+    std::vector<int> cpus = get_benchmark_cpus();
     int samples = duration_ms / sampling_interval_ms;
     
     for (int i = 0; i < samples; i++) {
-        for (int core_id = 0; core_id < core_count; core_id++) {
+        for (int core_id : cpus) {
             double freq = get_cpu_freq_mhz(core_id);
             all_frequencies[core_id].push_back(freq);
         }
@@ -193,8 +476,9 @@ std::map<int, std::vector<double>> monitor_all_cpu_freq(int duration_ms, int sam
 // Run a function on a specific core
 void run_on_core(int core_id, const std::function<void()>& func) {
     std::thread t([core_id, &func]() {
-        pin_to_core(core_id);
-        func();
+        if (pin_to_core(core_id)) {
+            func();
+        }
     });
     
     t.join();
@@ -202,13 +486,13 @@ void run_on_core(int core_id, const std::function<void()>& func) {
 
 // Run a function on all cores in parallel
 void run_on_all_cores(const std::function<void()>& func) {
-    int core_count = get_core_count();
     std::vector<std::thread> threads;
     
-    for (int core_id = 0; core_id < core_count; core_id++) {
+    for (int core_id : get_benchmark_cpus()) {
         threads.emplace_back([core_id, &func]() {
-            pin_to_core(core_id);
-            func();
+            if (pin_to_core(core_id)) {
+                func();
+            }
         });
     }
     
@@ -219,9 +503,7 @@ void run_on_all_cores(const std::function<void()>& func) {
 
 // Run a function on all cores sequentially
 void run_on_all_cores_sequential(const std::function<void(int)>& func) {
-    int core_count = get_core_count();
-    
-    for (int core_id = 0; core_id < core_count; core_id++) {
+    for (int core_id : get_benchmark_cpus()) {
         run_on_core(core_id, [core_id, &func]() {
             func(core_id);
         });
@@ -237,10 +519,9 @@ void print_all_core_frequencies() {
     }
 }
 
-void print_cpu_info() {
-    // Get CPU name
+std::string get_cpu_model_name() {
     std::string cpu_name = "Unknown";
-    std::ifstream cpuinfo("/proc/cpuinfo");
+    std::ifstream cpuinfo(cfp::fs_path("/proc/cpuinfo"));
     std::string line;
     
     while (std::getline(cpuinfo, line)) {
@@ -251,10 +532,32 @@ void print_cpu_info() {
             break;
         }
     }
+    return cpu_name;
+}
+
+// Usable CPUs, and the skipped ones grouped by reason
+void print_cpu_availability() {
+    std::map<CpuStatus, std::vector<int>> by_status;
+    for (const auto& [cpu, status] : get_cpu_availability()) {
+        by_status[status].push_back(cpu);
+    }
+    
+    std::vector<int>& usable = by_status[CpuStatus::USABLE];
+    std::cout << "  Cores: " << usable.size() << " usable (" << format_cpu_list(usable) << ")" << std::endl;
+    for (const auto& [status, cpus] : by_status) {
+        if (status != CpuStatus::USABLE) {
+            std::cout << "  Skipped " << get_cpu_status_name(status) << ": " << format_cpu_list(cpus) << std::endl;
+        }
+    }
+}
+
+void print_cpu_info() {
+    // Get CPU name
+    std::string cpu_name = get_cpu_model_name();
     
     std::cout << "CPU Information:" << std::endl;
     std::cout << "  Model: " << cpu_name << std::endl;
-    std::cout << "  Cores: " << get_core_count() << std::endl;
+    print_cpu_availability();
     std::cout << "  Instruction Set Support:" << std::endl;
     std::cout << "    SSE:     " << (has_sse() ? "Yes" : "No") << std::endl;
     std::cout << "    SSE2:    " << (has_sse2() ? "Yes" : "No") << std::endl;
@@ -273,22 +576,11 @@ void print_cpu_info() {
 
 void print_single_core_info(int core_id) {
     // Get CPU name
-    std::string cpu_name = "Unknown";
-    std::ifstream cpuinfo("/proc/cpuinfo");
-    std::string line;
-    
-    while (std::getline(cpuinfo, line)) {
-        if (line.find("model name") != std::string::npos) {
-            cpu_name = line.substr(line.find(":") + 1);
-            // Trim leading whitespace
-            cpu_name.erase(0, cpu_name.find_first_not_of(" \t"));
-            break;
-        }
-    }
+    std::string cpu_name = get_cpu_model_name();
     
     std::cout << "CPU Information:" << std::endl;
     std::cout << "  Model: " << cpu_name << std::endl;
-    std::cout << "  Cores: " << get_core_count() << std::endl;
+    print_cpu_availability();
     std::cout << "  Instruction Set Support:" << std::endl;
     std::cout << "    SSE:     " << (has_sse() ? "Yes" : "No") << std::endl;
     std::cout << "    SSE2:    " << (has_sse2() ? "Yes" : "No") << std::endl;
@@ -0,0 +1,236 @@
+#include "daemon.h"
+#include "cpu_utils.h"
+#include "topology.h"
+#include "stop_signal.h"
+#include "probe/sources.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <ctime>
+#include <fcntl.h>
+#include <iostream>
+#include <map>
+#include <signal.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <vector>
+
+static_assert(sizeof(cfs_header) == 64, "cfs_header layout changed");
+static_assert(sizeof(cfs_entry) == 64, "cfs_entry layout changed");
+
+// Write one entry under its seqlock
+static void publish_entry(cfs_entry& entry, uint64_t timestamp_ns, uint32_t freq_khz,
+                          int32_t temp_mdegc, uint32_t power_mw) {
+    uint32_t seq = __atomic_load_n(&entry.seq, __ATOMIC_RELAXED);
+    __atomic_store_n(&entry.seq, seq + 1, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+    __atomic_store_n(&entry.timestamp_ns, timestamp_ns, __ATOMIC_RELAXED);
+    __atomic_store_n(&entry.freq_khz, freq_khz, __ATOMIC_RELAXED);
+    __atomic_store_n(&entry.temp_mdegc, temp_mdegc, __ATOMIC_RELAXED);
+    __atomic_store_n(&entry.package_power_mw, power_mw, __ATOMIC_RELAXED);
+    __atomic_store_n(&entry.seq, seq + 2, __ATOMIC_RELEASE);
+}
+
+// Read the publishing pid from an existing segment. Returns false if the
+// segment is missing or does not hold a cpu_instr_freq table.
+static bool read_segment_pid(const std::string& name, pid_t& pid) {
+    int fd = shm_open(name.c_str(), O_RDONLY, 0);
+    if (fd < 0) {
+        return false;
+    }
+    struct stat st;
+    if (fstat(fd, &st) != 0 || static_cast<size_t>(st.st_size) < sizeof(cfs_header)) {
+        close(fd);
+        return false;
+    }
+    void* map = mmap(nullptr, sizeof(cfs_header), PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (map == MAP_FAILED) {
+        return false;
+    }
+    const auto* header = static_cast<const cfs_header*>(map);
+    bool valid = __atomic_load_n(&header->magic, __ATOMIC_ACQUIRE) == CFS_MAGIC;
+    pid = static_cast<pid_t>(header->daemon_pid);
+    munmap(map, sizeof(cfs_header));
+    return valid;
+}
+
+static bool process_alive(pid_t pid) {
+    return pid > 0 && (kill(pid, 0) == 0 || errno == EPERM);
+}
+
+// Create the segment exclusively so it is only ever sized by its creator. An
+// existing table is replaced when its daemon has exited, or with --force.
+// Replacing unlinks the name instead of truncating the object, so readers that
+// still map the old table keep valid (if stale) memory until they reopen.
+// Returns the descriptor, or -1 after reporting the error.
+static int create_segment(const DaemonOptions& options) {
+    const char* name = options.shm_name.c_str();
+    int fd = shm_open(name, O_CREAT | O_EXCL | O_RDWR, 0644);
+    if (fd < 0 && errno == EEXIST) {
+        pid_t owner = 0;
+        bool ours = read_segment_pid(options.shm_name, owner);
+        if (!options.force) {
+            if (!ours) {
+                std::cerr << "Error: " << options.shm_name << " exists and is not a cpu_instr_freq table"
+                          << " (use --force to replace it)" << std::endl;
+                return -1;
+            }
+            if (process_alive(owner)) {
+                std::cerr << "Error: " << options.shm_name << " is published by running daemon pid " << owner
+                          << " (use --force to replace it)" << std::endl;
+                return -1;
+            }
+        }
+        std::cout << "Replacing " << options.shm_name
+                  << (ours && !process_alive(owner) ? " left by exited daemon pid " : " published by pid ")
+                  << owner << std::endl;
+        shm_unlink(name);
+        fd = shm_open(name, O_CREAT | O_EXCL | O_RDWR, 0644);
+    }
+    if (fd < 0) {
+        std::cerr << "Error: shm_open(" << options.shm_name << ") failed: " << strerror(errno) << std::endl;
+    }
+    return fd;
+}
+
+int run_daemon(const DaemonOptions& options) {
+    if (options.interval_ms <= 0) {
+        std::cerr << "Error: daemon interval must be greater than 0" << std::endl;
+        return 1;
+    }
+
+    // Keep the fs root fixed while sources are open
+    cfp::FsRootUse root_use;
+
+    std::vector<int> cpus = get_benchmark_cpus();
+    if (cpus.empty()) {
+        std::cerr << "Error: no usable CPUs to sample" << std::endl;
+        return 1;
+    }
+    std::vector<CpuTopology> topology = get_cpu_topology(cpus);
+    int max_cpu = *std::max_element(cpus.begin(), cpus.end());
+
+    // Sources: cached sysfs descriptors, cpuinfo for CPUs without cpufreq
+    std::vector<cfp::SysfsFreqFile> freq_files(cpus.size());
+    bool need_cpuinfo = false;
+    for (size_t i = 0; i < cpus.size(); i++) {
+        if (!freq_files[i].open(cpus[i])) {
+            need_cpuinfo = true;
+        }
+    }
+    cfp::CpuinfoFreqReader cpuinfo;
+    std::vector<uint32_t> cpuinfo_khz(max_cpu + 1, 0);
+    if (need_cpuinfo && !cpuinfo.open()) {
+        std::cerr << "Error: no frequency source available" << std::endl;
+        return 1;
+    }
+
+    std::map<int, cfp::RaplPackagePower> package_power;
+    std::map<int, uint32_t> package_power_mw;
+    for (const auto& entry : topology) {
+        if (package_power.count(entry.package_id) == 0) {
+            cfp::RaplPackagePower rapl;
+            if (rapl.open(entry.package_id)) {
+                package_power.emplace(entry.package_id, std::move(rapl));
+            }
+            package_power_mw[entry.package_id] = CFS_POWER_UNKNOWN;
+        }
+    }
+
+    cfp::CoreTemperatures temperatures;
+    bool have_temperatures = temperatures.open();
+
+    // Create and size the segment
+    size_t size = sizeof(cfs_header) + static_cast<size_t>(max_cpu + 1) * sizeof(cfs_entry);
+    int fd = create_segment(options);
+    if (fd < 0) {
+        return 1;
+    }
+    if (ftruncate(fd, size) != 0) {
+        std::cerr << "Error: cannot size shared memory: " << strerror(errno) << std::endl;
+        close(fd);
+        shm_unlink(options.shm_name.c_str());
+        return 1;
+    }
+    void* map = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if (map == MAP_FAILED) {
+        std::cerr << "Error: cannot map shared memory: " << strerror(errno) << std::endl;
+        shm_unlink(options.shm_name.c_str());
+        return 1;
+    }
+
+    auto* header = static_cast<cfs_header*>(map);
+    auto* entries = reinterpret_cast<cfs_entry*>(header + 1);
+    for (const auto& entry : topology) {
+        entries[entry.cpu].present = 1;
+        entries[entry.cpu].package_id = entry.package_id;
+        entries[entry.cpu].temp_mdegc = CFS_TEMP_UNKNOWN;
+        entries[entry.cpu].package_power_mw = CFS_POWER_UNKNOWN;
+    }
+    header->cpu_slots = max_cpu + 1;
+    header->entry_size = sizeof(cfs_entry);
+    header->interval_ns = static_cast<uint64_t>(options.interval_ms) * 1000000ULL;
+    header->daemon_pid = getpid();
+    header->version = CFS_VERSION;
+    // Publish the magic last so readers never see a half-initialized header
+    __atomic_store_n(&header->magic, CFS_MAGIC, __ATOMIC_RELEASE);
+
+    install_stop_handlers();
+
+    std::cout << "Publishing " << cpus.size() << " CPUs to shared memory " << options.shm_name
+              << " every " << options.interval_ms << " ms" << std::endl;
+    std::cout << "  Power:       " << (package_power.empty() ? "unavailable" : "RAPL package energy") << std::endl;
+    std::cout << "  Temperature: " << (have_temperatures ? "coretemp" : "unavailable") << std::endl;
+    std::cout << "Press Ctrl+C to stop" << std::endl;
+
+    cfp::TickSchedule schedule(static_cast<uint64_t>(options.interval_ms) * 1000000ULL);
+
+    while (!stop_requested()) {
+        uint64_t now_ns = cfp::monotonic_ns();
+
+        if (need_cpuinfo) {
+            cpuinfo.read_all_khz(cpuinfo_khz);
+        }
+        for (auto& [package_id, rapl] : package_power) {
+            uint32_t milliwatts;
+            if (rapl.read_power_mw(now_ns, milliwatts)) {
+                package_power_mw[package_id] = milliwatts;
+            }
+        }
+
+        for (size_t i = 0; i < cpus.size(); i++) {
+            const CpuTopology& place = topology[i];
+            uint32_t khz = 0;
+            if (freq_files[i].is_open()) {
+                freq_files[i].read_khz(khz);
+            } else if (place.cpu < static_cast<int>(cpuinfo_khz.size())) {
+                khz = cpuinfo_khz[place.cpu];
+            }
+
+            int32_t mdegc = CFS_TEMP_UNKNOWN;
+            if (have_temperatures) {
+                temperatures.read_mdegc(place.package_id, place.core_id, mdegc);
+            }
+
+            publish_entry(entries[place.cpu], cfp::monotonic_ns(), khz, mdegc, package_power_mw[place.package_id]);
+        }
+        __atomic_fetch_add(&header->updates, 1, __ATOMIC_RELEASE);
+
+        schedule.wait();
+    }
+
+    munmap(map, size);
+    // A daemon started with --force may have taken the name over meanwhile
+    pid_t owner = 0;
+    if (read_segment_pid(options.shm_name, owner) && owner == getpid()) {
+        shm_unlink(options.shm_name.c_str());
+        std::cout << "\nStopped, removed " << options.shm_name << std::endl;
+    } else {
+        std::cout << "\nStopped, " << options.shm_name << " was taken over and is left in place" << std::endl;
+    }
+    return 0;
+}
@@ -0,0 +1,530 @@
+#include "exporter.h"
+#include "cpu_utils.h"
+#include "topology.h"
+#include "steady_state.h"
+#include "stop_signal.h"
+#include "sample_ring.h"
+#include "probe/sources.h"
+
+#include <algorithm>
+#include <arpa/inet.h>
+#include <atomic>
+#include <cerrno>
+#include <csignal>
+#include <cstdarg>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <mutex>
+#include <netinet/in.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/uio.h>
+#include <sys/un.h>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+namespace {
+
+const double kQuantiles[] = {0.01, 0.5, 0.9, 0.99};
+const char* const kQuantileLabels[] = {"1", "50", "90", "99"};   // "quantile" is reserved for summaries
+const size_t kQuantileCount = sizeof(kQuantiles) / sizeof(kQuantiles[0]);
+
+// Upper bound of one CPU's share of the exposition, in bytes
+const size_t kBytesPerCpu = 1024;
+const size_t kBytesFixed = 4096;
+
+// Fixed-capacity text buffer. Appends that do not fit are dropped whole, so
+// the output always ends on a complete line.
+class TextBuffer {
+public:
+    explicit TextBuffer(size_t capacity) : data_(capacity) {}
+
+    void clear() { length_ = 0; }
+    const char* data() const { return data_.data(); }
+    size_t length() const { return length_; }
+
+    void append(const char* format, ...) __attribute__((format(printf, 2, 3))) {
+        va_list args;
+        va_start(args, format);
+        size_t room = data_.size() - length_;
+        int n = vsnprintf(data_.data() + length_, room, format, args);
+        va_end(args);
+        if (n > 0 && static_cast<size_t>(n) < room) {
+            length_ += n;
+        } else {
+            data_[length_] = '\0';
+        }
+    }
+
+    // Copy another buffer of the same capacity
+    void assign(const TextBuffer& other) {
+        memcpy(data_.data(), other.data_.data(), other.length_);
+        length_ = other.length_;
+    }
+
+    void swap(TextBuffer& other) {
+        data_.swap(other.data_);
+        std::swap(length_, other.length_);
+    }
+
+private:
+    std::vector<char> data_;
+    size_t length_ = 0;
+};
+
+// Everything the sampler keeps about one CPU. All storage is sized up front.
+struct CpuState {
+    CpuTopology place;
+    cfp::SysfsFreqFile freq_file;
+    cfp::ThermalThrottleCounters throttle;
+    SampleRing<uint32_t> window;    // Recent samples in kHz
+    uint32_t current_khz = 0;
+    uint64_t drops = 0;             // Samples that fell below the window median
+    uint64_t core_throttles = 0;
+    bool have_core_throttles = false;
+};
+
+class Exporter {
+public:
+    explicit Exporter(const ExporterOptions& options)
+        : options_(options), rendered_(0), published_(0), scrape_copy_(0) {}
+
+    bool open();
+    void sample_loop();
+    void serve(int listen_fd);
+
+private:
+    void sample_once();
+    void render();
+    void handle_client(int client_fd);
+
+    ExporterOptions options_;
+    std::vector<CpuState> cpus_;
+    cfp::CpuinfoFreqReader cpuinfo_;
+    std::vector<uint32_t> cpuinfo_khz_;
+    bool need_cpuinfo_ = false;
+    std::vector<uint32_t> scratch_;
+    std::vector<uint64_t> package_throttles_;   // Indexed by package id
+    std::vector<int> package_reader_;           // Package id -> index into cpus_, -1 if none
+    double drop_fraction_ = SteadyStateOptions().throttle_drop;
+
+    uint64_t samples_ = 0;
+    uint64_t skipped_ticks_ = 0;
+    uint64_t last_sample_ns_ = 0;
+    std::atomic<uint64_t> scrapes_{0};
+
+    // Rendered by the sampler into rendered_, then swapped into published_
+    // under the mutex; scrapes copy published_ into scrape_copy_
+    TextBuffer rendered_;
+    TextBuffer published_;
+    TextBuffer scrape_copy_;
+    std::mutex publish_mutex_;
+};
+
+bool Exporter::open() {
+    std::vector<int> ids = get_benchmark_cpus();
+    std::vector<CpuTopology> topology = get_cpu_topology(ids);
+
+    size_t window = std::max<size_t>(1, static_cast<size_t>(options_.window_sec * 1000.0 / options_.interval_ms));
+    int max_package = 0;
+    cpus_.resize(topology.size());
+    for (size_t i = 0; i < topology.size(); i++) {
+        CpuState& state = cpus_[i];
+        state.place = topology[i];
+        if (!state.freq_file.open(state.place.cpu)) {
+            need_cpuinfo_ = true;
+        }
+        state.throttle.open(state.place.cpu);
+        state.window = SampleRing<uint32_t>(window);
+        max_package = std::max(max_package, state.place.package_id);
+    }
+    if (need_cpuinfo_ && !cpuinfo_.open()) {
+        std::cerr << "Error: no frequency source available" << std::endl;
+        return false;
+    }
+    scratch_.resize(window);
+
+    // The package counter is the same on every CPU of a package; read it once
+    package_throttles_.assign(max_package + 1, 0);
+    package_reader_.assign(max_package + 1, -1);
+    for (size_t i = 0; i < cpus_.size(); i++) {
+        int package = cpus_[i].place.package_id;
+        if (package_reader_[package] < 0 && cpus_[i].throttle.has_package()) {
+            package_reader_[package] = static_cast<int>(i);
+        }
+    }
+
+    size_t capacity = kBytesFixed + kBytesPerCpu * cpus_.size();
+    rendered_ = TextBuffer(capacity);
+    published_ = TextBuffer(capacity);
+    scrape_copy_ = TextBuffer(capacity);
+    return true;
+}
+
+void Exporter::sample_once() {
+    if (need_cpuinfo_) {
+        cpuinfo_.read_all_khz(cpuinfo_khz_);
+    }
+
+    for (auto& state : cpus_) {
+        uint32_t khz = 0;
+        if (state.freq_file.is_open()) {
+            state.freq_file.read_khz(khz);
+        } else if (state.place.cpu < static_cast<int>(cpuinfo_khz_.size())) {
+            khz = cpuinfo_khz_[state.place.cpu];
+        }
+        state.current_khz = khz;
+
+        // Compare against the median of the window before this sample joins it
+        if (!state.window.empty()) {
+            size_t n = state.window.copy_to(scratch_.data());
+            auto middle = scratch_.begin() + n / 2;
+            std::nth_element(scratch_.begin(), middle, scratch_.begin() + n);
+            if (khz < *middle * (1.0 - drop_fraction_)) {
+                state.drops++;
+            }
+        }
+
+        state.window.push(khz);
+
+        state.have_core_throttles = state.throttle.read_core(state.core_throttles);
+    }
+
+    for (size_t package = 0; package < package_reader_.size(); package++) {
+        if (package_reader_[package] >= 0) {
+            cpus_[package_reader_[package]].throttle.read_package(package_throttles_[package]);
+        }
+    }
+
+    samples_++;
+    last_sample_ns_ = cfp::monotonic_ns();
+}
+
+void Exporter::render() {
+    TextBuffer& out = rendered_;
+    out.clear();
+
+    out.append("# TYPE cpu_frequency_hertz gauge\n"
+               "# UNIT cpu_frequency_hertz hertz\n"
+               "# HELP cpu_frequency_hertz Latest sampled frequency of each CPU.\n");
+    for (const auto& state : cpus_) {
+        out.append("cpu_frequency_hertz{cpu=\"%d\",package=\"%d\",core=\"%d\"} %llu\n",
+                   state.place.cpu, state.place.package_id, state.place.core_id,
+                   static_cast<unsigned long long>(state.current_khz) * 1000ULL);
+    }
+
+    out.append("# TYPE cpu_frequency_window_hertz gauge\n"
+               "# UNIT cpu_frequency_window_hertz hertz\n"
+               "# HELP cpu_frequency_window_hertz Frequency percentiles over the last %g seconds.\n",
+               options_.window_sec);
+    for (const auto& state : cpus_) {
+        if (state.window.empty()) {
+            continue;
+        }
+        size_t n = state.window.copy_to(scratch_.data());
+        for (size_t q = 0; q < kQuantileCount; q++) {
+            auto nth = scratch_.begin() + static_cast<size_t>(kQuantiles[q] * (n - 1) + 0.5);
+            std::nth_element(scratch_.begin(), nth, scratch_.begin() + n);
+            out.append("cpu_frequency_window_hertz{cpu=\"%d\",percentile=\"%s\"} %llu\n",
+                       state.place.cpu, kQuantileLabels[q],
+                       static_cast<unsigned long long>(*nth) * 1000ULL);
+        }
+    }
+
+    out.append("# TYPE cpu_frequency_drops counter\n"
+               "# HELP cpu_frequency_drops Samples more than %g%% below the CPU's window median.\n",
+               drop_fraction_ * 100.0);
+    for (const auto& state : cpus_) {
+        out.append("cpu_frequency_drops_total{cpu=\"%d\"} %llu\n",
+                   state.place.cpu, static_cast<unsigned long long>(state.drops));
+    }
+
+    out.append("# TYPE cpu_thermal_throttle_core counter\n"
+               "# HELP cpu_thermal_throttle_core Core thermal throttle events reported by the kernel.\n");
+    for (const auto& state : cpus_) {
+        if (state.have_core_throttles) {
+            out.append("cpu_thermal_throttle_core_total{cpu=\"%d\"} %llu\n",
+                       state.place.cpu, static_cast<unsigned long long>(state.core_throttles));
+        }
+    }
+
+    out.append("# TYPE cpu_thermal_throttle_package counter\n"
+               "# HELP cpu_thermal_throttle_package Package thermal throttle events reported by the kernel.\n");
+    for (size_t package = 0; package < package_reader_.size(); package++) {
+        if (package_reader_[package] >= 0) {
+            out.append("cpu_thermal_throttle_package_total{package=\"%zu\"} %llu\n",
+                       package, static_cast<unsigned long long>(package_throttles_[package]));
+        }
+    }
+
+    out.append("# TYPE cpu_instr_freq_samples counter\n"
+               "# HELP cpu_instr_freq_samples Sampling ticks completed by the exporter.\n"
+               "cpu_instr_freq_samples_total %llu\n"
+               "# TYPE cpu_instr_freq_skipped_ticks counter\n"
+               "# HELP cpu_instr_freq_skipped_ticks Ticks skipped because sampling fell behind.\n"
+               "cpu_instr_freq_skipped_ticks_total %llu\n"
+               "# TYPE cpu_instr_freq_scrapes counter\n"
+               "# HELP cpu_instr_freq_scrapes Scrapes served by the exporter.\n"
+               "cpu_instr_freq_scrapes_total %llu\n"
+               "# TYPE cpu_instr_freq_last_sample_seconds gauge\n"
+               "# UNIT cpu_instr_freq_last_sample_seconds seconds\n"
+               "# HELP cpu_instr_freq_last_sample_seconds CLOCK_MONOTONIC time of the latest tick.\n"
+               "cpu_instr_freq_last_sample_seconds %.6f\n"
+               "# EOF\n",
+               static_cast<unsigned long long>(samples_),
+               static_cast<unsigned long long>(skipped_ticks_),
+               static_cast<unsigned long long>(scrapes_.load(std::memory_order_relaxed)),
+               last_sample_ns_ / 1e9);
+
+    std::lock_guard<std::mutex> lock(publish_mutex_);
+    published_.swap(rendered_);
+}
+
+void Exporter::sample_loop() {
+    cfp::TickSchedule schedule(static_cast<uint64_t>(options_.interval_ms) * 1000000ULL);
+
+    while (!stop_requested()) {
+        sample_once();
+        render();
+
+        schedule.wait();
+        skipped_ticks_ = schedule.skipped();
+    }
+}
+
+static void write_all(int fd, const struct iovec* parts, int count) {
+    struct iovec local[2];
+    memcpy(local, parts, sizeof(struct iovec) * count);
+    struct iovec* iov = local;
+    while (count > 0) {
+        ssize_t n = writev(fd, iov, count);
+        if (n <= 0) {
+            if (n < 0 && errno == EINTR) {
+                continue;
+            }
+            return;
+        }
+        while (count > 0 && static_cast<size_t>(n) >= iov->iov_len) {
+            n -= iov->iov_len;
+            iov++;
+            count--;
+        }
+        if (count > 0) {
+            iov->iov_base = static_cast<char*>(iov->iov_base) + n;
+            iov->iov_len -= n;
+        }
+    }
+}
+
+void Exporter::handle_client(int client_fd) {
+    // Only the request line matters; a slow or silent client gets dropped
+    struct timeval timeout = {1, 0};
+    setsockopt(client_fd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+    setsockopt(client_fd, SOL_SOCKET, SO_SNDTIMEO, &timeout, sizeof(timeout));
+
+    char request[1024];
+    ssize_t n = recv(client_fd, request, sizeof(request) - 1, 0);
+    if (n <= 0) {
+        return;
+    }
+    request[n] = '\0';
+
+    bool is_get = strncmp(request, "GET ", 4) == 0;
+    const char* path = request + 4;
+    bool known_path = is_get && (strncmp(path, "/metrics", 8) == 0 || strncmp(path, "/ ", 2) == 0);
+    if (!known_path) {
+        static const char not_found[] =
+            "HTTP/1.1 404 Not Found\r\nContent-Length: 0\r\nConnection: close\r\n\r\n";
+        struct iovec part = {const_cast<char*>(not_found), sizeof(not_found) - 1};
+        write_all(client_fd, &part, 1);
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(publish_mutex_);
+        scrape_copy_.assign(published_);
+    }
+    scrapes_.fetch_add(1, std::memory_order_relaxed);
+
+    char header[192];
+    int header_length = snprintf(header, sizeof(header),
+                                 "HTTP/1.1 200 OK\r\n"
+                                 "Content-Type: application/openmetrics-text; version=1.0.0; charset=utf-8\r\n"
+                                 "Content-Length: %zu\r\n"
+                                 "Connection: close\r\n\r\n",
+                                 scrape_copy_.length());
+    struct iovec parts[2] = {
+        {header, static_cast<size_t>(header_length)},
+        {const_cast<char*>(scrape_copy_.data()), scrape_copy_.length()},
+    };
+    write_all(client_fd, parts, 2);
+}
+
+void Exporter::serve(int listen_fd) {
+    struct pollfd pfd = {listen_fd, POLLIN, 0};
+    while (!stop_requested()) {
+        int ready = poll(&pfd, 1, 200);
+        if (ready <= 0) {
+            continue;
+        }
+        int client_fd = accept4(listen_fd, nullptr, nullptr, SOCK_CLOEXEC);
+        if (client_fd < 0) {
+            continue;
+        }
+        handle_client(client_fd);
+        close(client_fd);
+    }
+}
+
+// Make room for a unix socket at address. Only a socket nobody accepts on
+// (left by an exporter that exited) is removed; any other file, or a socket
+// another process still listens on, is an error.
+bool remove_stale_socket(const struct sockaddr_un& address) {
+    const char* path = address.sun_path;
+    struct stat st;
+    if (lstat(path, &st) != 0) {
+        if (errno == ENOENT) {
+            return true;
+        }
+        std::cerr << "Error: cannot check " << path << ": " << strerror(errno) << std::endl;
+        return false;
+    }
+    if (!S_ISSOCK(st.st_mode)) {
+        std::cerr << "Error: " << path << " exists and is not a socket" << std::endl;
+        return false;
+    }
+
+    int probe = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (probe < 0) {
+        std::cerr << "Error: cannot check " << path << ": " << strerror(errno) << std::endl;
+        return false;
+    }
+    int connected = connect(probe, reinterpret_cast<const struct sockaddr*>(&address), sizeof(address));
+    int connect_errno = errno;
+    close(probe);
+    if (connected == 0) {
+        std::cerr << "Error: another process is listening on " << path << std::endl;
+        return false;
+    }
+    if (connect_errno != ECONNREFUSED) {
+        std::cerr << "Error: cannot check " << path << ": " << strerror(connect_errno) << std::endl;
+        return false;
+    }
+    if (unlink(path) != 0) {
+        std::cerr << "Error: cannot remove stale socket " << path << ": " << strerror(errno) << std::endl;
+        return false;
+    }
+    return true;
+}
+
+// Parse the listen address and bind. Returns the listening socket or -1.
+int open_listener(const std::string& listen, std::string& unix_path) {
+    int fd = -1;
+    if (listen.compare(0, 5, "unix:") == 0) {
+        unix_path = listen.substr(5);
+        struct sockaddr_un address;
+        memset(&address, 0, sizeof(address));
+        address.sun_family = AF_UNIX;
+        if (unix_path.empty() || unix_path.size() >= sizeof(address.sun_path)) {
+            std::cerr << "Error: invalid unix socket path '" << unix_path << "'" << std::endl;
+            return -1;
+        }
+        strcpy(address.sun_path, unix_path.c_str());
+        if (!remove_stale_socket(address)) {
+            unix_path.clear();   // Not ours to remove on exit
+            return -1;
+        }
+
+        fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+        if (fd < 0 || bind(fd, reinterpret_cast<struct sockaddr*>(&address), sizeof(address)) != 0) {
+            std::cerr << "Error: cannot bind " << unix_path << ": " << strerror(errno) << std::endl;
+            if (fd >= 0) close(fd);
+            return -1;
+        }
+    } else {
+        std::string port_text = listen;
+        size_t colon = listen.rfind(':');
+        if (colon != std::string::npos) {
+            std::string host = listen.substr(0, colon);
+            if (host != "localhost" && host != "127.0.0.1") {
+                std::cerr << "Error: the exporter only listens on localhost, not '" << host << "'" << std::endl;
+                return -1;
+            }
+            port_text = listen.substr(colon + 1);
+        }
+        char* end = nullptr;
+        long port = strtol(port_text.c_str(), &end, 10);
+        if (port_text.empty() || *end != '\0' || port <= 0 || port > 65535) {
+            std::cerr << "Error: invalid listen address '" << listen << "'" << std::endl;
+            return -1;
+        }
+
+        struct sockaddr_in address;
+        memset(&address, 0, sizeof(address));
+        address.sin_family = AF_INET;
+        address.sin_port = htons(static_cast<uint16_t>(port));
+        address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+
+        fd = socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0);
+        int reuse = 1;
+        if (fd >= 0) {
+            setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+        }
+        if (fd < 0 || bind(fd, reinterpret_cast<struct sockaddr*>(&address), sizeof(address)) != 0) {
+            std::cerr << "Error: cannot bind 127.0.0.1:" << port << ": " << strerror(errno) << std::endl;
+            if (fd >= 0) close(fd);
+            return -1;
+        }
+    }
+
+    if (::listen(fd, 16) != 0) {
+        std::cerr << "Error: listen failed: " << strerror(errno) << std::endl;
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+} // namespace
+
+int run_exporter(const ExporterOptions& options) {
+    if (options.interval_ms <= 0 || options.window_sec <= 0) {
+        std::cerr << "Error: exporter interval and window must be greater than 0" << std::endl;
+        return 1;
+    }
+
+    // Keep the fs root fixed while sources are open
+    cfp::FsRootUse root_use;
+
+    Exporter exporter(options);
+    if (!exporter.open()) {
+        return 1;
+    }
+
+    std::string unix_path;
+    int listen_fd = open_listener(options.listen, unix_path);
+    if (listen_fd < 0) {
+        return 1;
+    }
+
+    install_stop_handlers();
+    signal(SIGPIPE, SIG_IGN);
+
+    std::cout << "Serving OpenMetrics on " << options.listen << " (sampling every "
+              << options.interval_ms << " ms)" << std::endl;
+    std::cout << "Press Ctrl+C to stop" << std::endl;
+
+    std::thread sampler([&exporter] { exporter.sample_loop(); });
+    exporter.serve(listen_fd);
+    sampler.join();
+
+    close(listen_fd);
+    if (!unix_path.empty()) {
+        unlink(unix_path.c_str());
+    }
+    std::cout << "\nStopped" << std::endl;
+    return 0;
+}
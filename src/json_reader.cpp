@@ -0,0 +1,269 @@
+#include "json_reader.h"
+
+#include <cstdlib>
+#include <iterator>
+#include <stdexcept>
+
+static const char* type_name(JsonValue::Type type) {
+    switch(type) {
+        case JsonValue::Type::NUL:
+            return "null";
+        case JsonValue::Type::BOOL:
+            return "boolean";
+        case JsonValue::Type::NUMBER:
+            return "number";
+        case JsonValue::Type::STRING:
+            return "string";
+        case JsonValue::Type::ARRAY:
+            return "array";
+        case JsonValue::Type::OBJECT:
+            return "object";
+    }
+    return "unknown";
+}
+
+static void expect_type(JsonValue::Type actual, JsonValue::Type expected) {
+    if (actual != expected) {
+        throw std::runtime_error(std::string("expected a JSON ") + type_name(expected) + ", found " + type_name(actual));
+    }
+}
+
+bool JsonValue::as_bool() const {
+    expect_type(type_, Type::BOOL);
+    return bool_;
+}
+
+double JsonValue::as_number() const {
+    expect_type(type_, Type::NUMBER);
+    return number_;
+}
+
+const std::string& JsonValue::as_string() const {
+    expect_type(type_, Type::STRING);
+    return string_;
+}
+
+const std::vector<JsonValue>& JsonValue::as_array() const {
+    expect_type(type_, Type::ARRAY);
+    return array_;
+}
+
+const JsonValue* JsonValue::find(const std::string& name) const {
+    if (type_ != Type::OBJECT) {
+        return nullptr;
+    }
+    for (const auto& member : members_) {
+        if (member.first == name) {
+            return &member.second;
+        }
+    }
+    return nullptr;
+}
+
+const JsonValue& JsonValue::at(const std::string& name) const {
+    expect_type(type_, Type::OBJECT);
+    const JsonValue* value = find(name);
+    if (value == nullptr) {
+        throw std::runtime_error("missing JSON member '" + name + "'");
+    }
+    return *value;
+}
+
+// Recursive descent over an in-memory copy of the document
+class JsonParser {
+public:
+    explicit JsonParser(const std::string& text) : text_(text) {}
+
+    JsonValue parse_document() {
+        JsonValue value = parse_value(0);
+        skip_whitespace();
+        if (pos_ != text_.size()) {
+            fail("trailing characters after the document");
+        }
+        return value;
+    }
+
+private:
+    static constexpr int kMaxDepth = 256;
+
+    [[noreturn]] void fail(const std::string& message) const {
+        throw std::runtime_error("JSON error at byte " + std::to_string(pos_) + ": " + message);
+    }
+
+    void skip_whitespace() {
+        while (pos_ < text_.size() &&
+               (text_[pos_] == ' ' || text_[pos_] == '\t' || text_[pos_] == '\n' || text_[pos_] == '\r')) {
+            pos_++;
+        }
+    }
+
+    bool consume(char c) {
+        skip_whitespace();
+        if (pos_ < text_.size() && text_[pos_] == c) {
+            pos_++;
+            return true;
+        }
+        return false;
+    }
+
+    void expect(char c) {
+        if (!consume(c)) {
+            fail(std::string("expected '") + c + "'");
+        }
+    }
+
+    bool consume_literal(const char* literal) {
+        size_t length = std::char_traits<char>::length(literal);
+        if (text_.compare(pos_, length, literal) == 0) {
+            pos_ += length;
+            return true;
+        }
+        return false;
+    }
+
+    JsonValue parse_value(int depth) {
+        if (depth > kMaxDepth) {
+            fail("nesting too deep");
+        }
+        skip_whitespace();
+        if (pos_ >= text_.size()) {
+            fail("unexpected end of input");
+        }
+
+        JsonValue value;
+        char c = text_[pos_];
+        if (c == '{') {
+            pos_++;
+            value.type_ = JsonValue::Type::OBJECT;
+            if (consume('}')) {
+                return value;
+            }
+            do {
+                skip_whitespace();
+                if (pos_ >= text_.size() || text_[pos_] != '"') {
+                    fail("expected a member name");
+                }
+                std::string name = parse_string();
+                expect(':');
+                value.members_.emplace_back(std::move(name), parse_value(depth + 1));
+            } while (consume(','));
+            expect('}');
+        } else if (c == '[') {
+            pos_++;
+            value.type_ = JsonValue::Type::ARRAY;
+            if (consume(']')) {
+                return value;
+            }
+            do {
+                value.array_.push_back(parse_value(depth + 1));
+            } while (consume(','));
+            expect(']');
+        } else if (c == '"') {
+            value.type_ = JsonValue::Type::STRING;
+            value.string_ = parse_string();
+        } else if (consume_literal("true")) {
+            value.type_ = JsonValue::Type::BOOL;
+            value.bool_ = true;
+        } else if (consume_literal("false")) {
+            value.type_ = JsonValue::Type::BOOL;
+        } else if (consume_literal("null")) {
+            value.type_ = JsonValue::Type::NUL;
+        } else {
+            const char* start = text_.c_str() + pos_;
+            char* end = nullptr;
+            double number = std::strtod(start, &end);
+            if (end == start || !(c == '-' || (c >= '0' && c <= '9'))) {
+                fail("unexpected character");
+            }
+            pos_ += end - start;
+            value.type_ = JsonValue::Type::NUMBER;
+            value.number_ = number;
+        }
+        return value;
+    }
+
+    // Called with pos_ on the opening quote
+    std::string parse_string() {
+        std::string out;
+        pos_++;
+        while (true) {
+            if (pos_ >= text_.size()) {
+                fail("unterminated string");
+            }
+            char c = text_[pos_++];
+            if (c == '"') {
+                return out;
+            }
+            if (c != '\\') {
+                out += c;
+                continue;
+            }
+            if (pos_ >= text_.size()) {
+                fail("unterminated escape");
+            }
+            char escape = text_[pos_++];
+            switch(escape) {
+                case '"':  out += '"'; break;
+                case '\\': out += '\\'; break;
+                case '/':  out += '/'; break;
+                case 'b':  out += '\b'; break;
+                case 'f':  out += '\f'; break;
+                case 'n':  out += '\n'; break;
+                case 'r':  out += '\r'; break;
+                case 't':  out += '\t'; break;
+                case 'u':
+                    append_utf8(out, parse_hex4());
+                    break;
+                default:
+                    fail(std::string("bad escape '\\") + escape + "'");
+            }
+        }
+    }
+
+    unsigned parse_hex4() {
+        if (pos_ + 4 > text_.size()) {
+            fail("truncated \\u escape");
+        }
+        unsigned code = 0;
+        for (int i = 0; i < 4; i++) {
+            char h = text_[pos_++];
+            code <<= 4;
+            if (h >= '0' && h <= '9') {
+                code |= h - '0';
+            } else if (h >= 'a' && h <= 'f') {
+                code |= h - 'a' + 10;
+            } else if (h >= 'A' && h <= 'F') {
+                code |= h - 'A' + 10;
+            } else {
+                fail("bad \\u escape");
+            }
+        }
+        return code;
+    }
+
+    // Surrogate pairs are not combined; the writer never emits them
+    static void append_utf8(std::string& out, unsigned code) {
+        if (code < 0x80) {
+            out += static_cast<char>(code);
+        } else if (code < 0x800) {
+            out += static_cast<char>(0xC0 | (code >> 6));
+            out += static_cast<char>(0x80 | (code & 0x3F));
+        } else {
+            out += static_cast<char>(0xE0 | (code >> 12));
+            out += static_cast<char>(0x80 | ((code >> 6) & 0x3F));
+            out += static_cast<char>(0x80 | (code & 0x3F));
+        }
+    }
+
+    const std::string& text_;
+    size_t pos_ = 0;
+};
+
+JsonValue JsonValue::parse(const std::string& text) {
+    return JsonParser(text).parse_document();
+}
+
+JsonValue JsonValue::parse(std::istream& in) {
+    std::string text((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+    return parse(text);
+}
@@ -0,0 +1,150 @@
+#include "json_writer.h"
+
+#include <cmath>
+#include <cstdio>
+
+JsonWriter::JsonWriter(std::ostream& out, bool pretty) : out_(out), pretty_(pretty) {}
+
+void JsonWriter::newline() {
+    if (pretty_ && single_line_depth_ == 0) {
+        out_ << '\n' << std::string(first_.size() * 2, ' ');
+    }
+}
+
+void JsonWriter::before_value() {
+    if (after_key_) {
+        after_key_ = false;
+        return;
+    }
+    if (!first_.empty()) {
+        if (!first_.back()) {
+            out_ << (pretty_ && single_line_depth_ != 0 ? ", " : ",");
+        }
+        first_.back() = false;
+        newline();
+    }
+}
+
+JsonWriter& JsonWriter::begin_object() {
+    before_value();
+    out_ << '{';
+    first_.push_back(true);
+    return *this;
+}
+
+JsonWriter& JsonWriter::end_object() {
+    bool empty = first_.back();
+    first_.pop_back();
+    if (!empty) {
+        newline();
+    }
+    out_ << '}';
+    if (first_.empty() && pretty_) {
+        out_ << '\n';
+    }
+    return *this;
+}
+
+JsonWriter& JsonWriter::begin_array(bool single_line) {
+    before_value();
+    out_ << '[';
+    first_.push_back(true);
+    if (single_line && single_line_depth_ == 0) {
+        single_line_depth_ = first_.size();
+    }
+    return *this;
+}
+
+JsonWriter& JsonWriter::end_array() {
+    bool empty = first_.back();
+    first_.pop_back();
+    if (!empty) {
+        newline();
+    }
+    out_ << ']';
+    if (single_line_depth_ > first_.size()) {
+        single_line_depth_ = 0;
+    }
+    return *this;
+}
+
+JsonWriter& JsonWriter::key(const std::string& name) {
+    before_value();
+    write_string(name);
+    out_ << (pretty_ ? ": " : ":");
+    after_key_ = true;
+    return *this;
+}
+
+JsonWriter& JsonWriter::value(const std::string& v) {
+    before_value();
+    write_string(v);
+    return *this;
+}
+
+JsonWriter& JsonWriter::value(const char* v) {
+    return value(std::string(v));
+}
+
+JsonWriter& JsonWriter::value(double v) {
+    before_value();
+    if (!std::isfinite(v)) {
+        out_ << "null";  // JSON has no NaN or infinity
+        return *this;
+    }
+    char buffer[32];
+    std::snprintf(buffer, sizeof(buffer), "%.9g", v);
+    out_ << buffer;
+    return *this;
+}
+
+JsonWriter& JsonWriter::value(long long v) {
+    before_value();
+    out_ << v;
+    return *this;
+}
+
+JsonWriter& JsonWriter::value(unsigned long long v) {
+    before_value();
+    out_ << v;
+    return *this;
+}
+
+JsonWriter& JsonWriter::value(bool v) {
+    before_value();
+    out_ << (v ? "true" : "false");
+    return *this;
+}
+
+JsonWriter& JsonWriter::null() {
+    before_value();
+    out_ << "null";
+    return *this;
+}
+
+void JsonWriter::write_string(const std::string& s) {
+    out_ << '"' << json_escape(s) << '"';
+}
+
+std::string json_escape(const std::string& s) {
+    std::string out;
+    out.reserve(s.size());
+    for (char c : s) {
+        switch(c) {
+            case '"':  out += "\\\""; break;
+            case '\\': out += "\\\\"; break;
+            case '\n': out += "\\n"; break;
+            case '\r': out += "\\r"; break;
+            case '\t': out += "\\t"; break;
+            default:
+                if (static_cast<unsigned char>(c) < 0x20) {
+                    char buffer[8];
+                    std::snprintf(buffer, sizeof(buffer), "\\u%04x", c);
+                    out += buffer;
+                } else {
+                    out += c;
+                }
+        }
+    }
+    return out;
+}
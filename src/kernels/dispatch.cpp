@@ -0,0 +1,61 @@
+// Runtime kernel dispatch. Compiled with the baseline flags.
+
+#include "kernels.h"
+#include "cpu_utils.h"
+
+namespace {
+
+struct KernelTable {
+    KernelFn avx128 = nullptr;
+    KernelFn avx256 = nullptr;
+    KernelFn avx512 = nullptr;
+    KernelFn amx = nullptr;
+    KernelFn basic_add = nullptr;
+};
+
+KernelTable build_kernel_table() {
+    const CpuFeatures& features = get_cpu_features();
+    KernelTable table;
+
+    // AVX-128 falls back to the legacy SSE encoding when AVX is missing
+    if (features.avx) {
+        table.avx128 = benchmark_avx128;
+    } else if (features.sse2) {
+        table.avx128 = benchmark_sse;
+    }
+
+    if (features.avx2) {
+        table.avx256 = benchmark_avx256;
+    }
+    if (features.avx512f) {
+        table.avx512 = benchmark_avx512;
+    }
+    if (features.amx_tile || features.amx_bf16) {
+        table.amx = benchmark_amx;
+    }
+
+    // Basic integer add is supported on all CPUs
+    table.basic_add = benchmark_basic_add;
+
+    return table;
+}
+
+} // namespace
+
+KernelFn get_kernel(InstructionSet instr_set) {
+    static const KernelTable table = build_kernel_table();
+
+    switch(instr_set) {
+        case InstructionSet::AVX128:
+            return table.avx128;
+        case InstructionSet::AVX256:
+            return table.avx256;
+        case InstructionSet::AVX512:
+            return table.avx512;
+        case InstructionSet::AMX:
+            return table.amx;
+        case InstructionSet::BASIC_ADD:
+            return table.basic_add;
+    }
+    return nullptr;
+}
@@ -0,0 +1,40 @@
+// AVX kernels (128-bit VEX encoded). Compiled with -mavx.
+// Only call these through get_kernel(), which checks CPU support first.
+
+#include "kernels.h"
+
+// AVX-128 benchmark function
+extern "C" void benchmark_avx128(size_t iterations) {
+    asm volatile(
+        "movq %0, %%rcx\n"     // Move iterations to rcx register
+        
+        // Initialize xmm registers with data
+        "vxorps %%xmm0, %%xmm0, %%xmm0\n"
+        "vxorps %%xmm1, %%xmm1, %%xmm1\n"
+        "vaddps %%xmm0, %%xmm1, %%xmm0\n"
+        
+        "1:\n"                 // Label for loop
+        
+        // AVX-128 instructions
+        "vmovaps %%xmm0, %%xmm1\n"
+        "vaddps %%xmm1, %%xmm0, %%xmm0\n"
+        "vmulps %%xmm1, %%xmm0, %%xmm0\n"
+        "vshufps $0x1B, %%xmm0, %%xmm0, %%xmm1\n"
+        "vaddps %%xmm1, %%xmm0, %%xmm0\n"
+        "vmovaps %%xmm0, %%xmm2\n"
+        "vmovaps %%xmm0, %%xmm3\n"
+        "vaddps %%xmm2, %%xmm3, %%xmm3\n"
+        "vmovaps %%xmm3, %%xmm4\n"
+        "vmovaps %%xmm4, %%xmm5\n"
+        "vaddps %%xmm4, %%xmm5, %%xmm5\n"
+        "vmulps %%xmm3, %%xmm5, %%xmm5\n"
+        "vaddps %%xmm5, %%xmm0, %%xmm0\n"
+        
+        "decq %%rcx\n"         // Decrement counter
+        "jnz 1b\n"             // Jump back to label 1 if rcx != 0
+        
+        : // No outputs
+        : "r"(iterations)      // Input constraint: iterations in a register
+        : "rcx", "xmm0", "xmm1", "xmm2", "xmm3", "xmm4", "xmm5" // Clobbered registers
+    );
+}
@@ -0,0 +1,37 @@
+// AVX2 kernels (256-bit). Compiled with -mavx2 -mfma.
+// Only call these through get_kernel(), which checks CPU support first.
+
+#include "kernels.h"
+
+// AVX-256 benchmark function
+extern "C" void benchmark_avx256(size_t iterations) {
+    asm volatile(
+        "movq %0, %%rcx\n"     // Move iterations to rcx register
+        
+        // Initialize ymm registers with data
+        "vxorps %%ymm0, %%ymm0, %%ymm0\n"
+        "vxorps %%ymm1, %%ymm1, %%ymm1\n"
+        
+        "1:\n"                 // Label for loop
+        
+        // AVX2 instructions (256-bit)
+        "vmovaps %%ymm0, %%ymm1\n"
+        "vaddps %%ymm1, %%ymm0, %%ymm0\n"
+        "vmulps %%ymm1, %%ymm0, %%ymm0\n"
+        "vpermpd $0x1B, %%ymm0, %%ymm2\n"
+        "vaddps %%ymm2, %%ymm0, %%ymm0\n"
+        "vmovaps %%ymm0, %%ymm3\n"
+        "vaddps %%ymm3, %%ymm0, %%ymm0\n"
+        "vmulps %%ymm3, %%ymm0, %%ymm0\n"
+        "vaddps %%ymm1, %%ymm0, %%ymm0\n"
+        
+        "decq %%rcx\n"         // Decrement counter
+        "jnz 1b\n"             // Jump back to label 1 if rcx != 0
+        
+        "vzeroupper\n"         // Zero upper bits of YMM registers
+        
+        : // No outputs
+        : "r"(iterations)      // Input constraint: iterations in a register
+        : "rcx", "ymm0", "ymm1", "ymm2", "ymm3" // Clobbered registers
+    );
+}
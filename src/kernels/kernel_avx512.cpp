@@ -0,0 +1,37 @@
+// AVX-512 kernels. Compiled with -mavx512f.
+// Only call these through get_kernel(), which checks CPU support first.
+
+#include "kernels.h"
+
+// AVX-512 benchmark function
+extern "C" void benchmark_avx512(size_t iterations) {
+    asm volatile(
+        "movq %0, %%rcx\n"     // Move iterations to rcx register
+        
+        // Initialize zmm registers with data
+        "vpxorq %%zmm0, %%zmm0, %%zmm0\n"
+        "vpxorq %%zmm1, %%zmm1, %%zmm1\n"
+        
+        "1:\n"                 // Label for loop
+        
+        // AVX-512 instructions (512-bit)
+        "vmovaps %%zmm0, %%zmm1\n"
+        "vaddps %%zmm1, %%zmm0, %%zmm0\n"
+        "vmulps %%zmm1, %%zmm0, %%zmm0\n"
+        "vaddps %%zmm1, %%zmm0, %%zmm2\n"
+        "vfmadd132ps %%zmm0, %%zmm1, %%zmm2\n"
+        "vmovaps %%zmm2, %%zmm3\n"
+        "vfmadd213ps %%zmm0, %%zmm1, %%zmm3\n"
+        "vaddps %%zmm3, %%zmm0, %%zmm0\n"
+        "vmulps %%zmm3, %%zmm0, %%zmm0\n"
+        
+        "decq %%rcx\n"         // Decrement counter
+        "jnz 1b\n"             // Jump back to label 1 if rcx != 0
+        
+        "vzeroupper\n"         // Zero upper bits of ZMM registers
+        
+        : // No outputs
+        : "r"(iterations)      // Input constraint: iterations in a register
+        : "rcx", "zmm0", "zmm1", "zmm2", "zmm3" // Clobbered registers
+    );
+}
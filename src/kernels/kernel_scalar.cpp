@@ -0,0 +1,64 @@
+// Scalar kernels. Compiled with the baseline flags, safe on every x86-64 CPU.
+// Only call these through get_kernel(), which checks CPU support first.
+
+#include "kernels.h"
+
+// AMX benchmark function
+extern "C" void benchmark_amx(size_t iterations) {
+    // AMX requires specific setup with LDTILECFG instruction first
+    // This is a placeholder that demonstrates AMX usage pattern
+    // In a real implementation, we would use proper tile configuration and operations
+    
+    asm volatile(
+        "movq %0, %%rcx\n"     // Move iterations to rcx register
+        "1:\n"                 // Label for loop
+        
+        // AMX operation simulation with basic instructions
+        // In reality, we would use tdpbf16ps, tdpbssd, tilezero, tileloadd, tilestored, etc.
+        "xor %%rax, %%rax\n"
+        "xor %%rbx, %%rbx\n"
+        "xor %%rdx, %%rdx\n"
+        "inc %%rax\n"
+        "inc %%rbx\n"
+        "inc %%rdx\n"
+        
+        "decq %%rcx\n"         // Decrement counter
+        "jnz 1b\n"             // Jump back to label 1 if rcx != 0
+        
+        : // No outputs
+        : "r"(iterations)      // Input constraint: iterations in a register
+        : "rax", "rbx", "rcx", "rdx" // Clobbered registers
+    );
+}
+
+// Basic integer ADD benchmark function
+extern "C" void benchmark_basic_add(size_t iterations) {
+    asm volatile(
+        "movq %0, %%rcx\n"     // Move iterations to rcx register
+        
+        // Initialize registers with data
+        "movq $1, %%rax\n"
+        "movq $2, %%rbx\n"
+        
+        "1:\n"                 // Label for loop
+        
+        // Basic integer add instructions
+        "addq %%rbx, %%rax\n"
+        "addq %%rax, %%rbx\n"
+        "addq %%rbx, %%rax\n"
+        "addq %%rax, %%rbx\n"
+        "addq %%rbx, %%rax\n"
+        "addq %%rax, %%rbx\n"
+        "addq %%rbx, %%rax\n"
+        "addq %%rax, %%rbx\n"
+        "addq %%rbx, %%rax\n"
+        "addq %%rax, %%rbx\n"
+        
+        "decq %%rcx\n"         // Decrement counter
+        "jnz 1b\n"             // Jump back to label 1 if rcx != 0
+        
+        : // No outputs
+        : "r"(iterations)      // Input constraint: iterations in a register
+        : "rax", "rbx", "rcx"  // Clobbered registers
+    );
+}
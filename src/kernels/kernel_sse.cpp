@@ -0,0 +1,40 @@
+// SSE kernels. Compiled with -msse -msse2 only, which is the x86-64 baseline.
+// Only call these through get_kernel(), which checks CPU support first.
+
+#include "kernels.h"
+
+// SSE benchmark function (safe for most x86 CPUs, using SSE instructions)
+extern "C" void benchmark_sse(size_t iterations) {
+    asm volatile(
+        "movq %0, %%rcx\n"     // Move iterations to rcx register
+        
+        // Initialize xmm registers with data
+        "movq $0x3f800000, %%rax\n"    // 1.0f in IEEE-754
+        "movd %%eax, %%xmm0\n"
+        "pshufd $0, %%xmm0, %%xmm0\n"  // Replicate to all elements
+        
+        "movq $0x40000000, %%rax\n"    // 2.0f in IEEE-754
+        "movd %%eax, %%xmm1\n"
+        "pshufd $0, %%xmm1, %%xmm1\n"  // Replicate to all elements
+        
+        "1:\n"                 // Label for loop
+        
+        // SSE instructions (128-bit)
+        "movaps %%xmm0, %%xmm2\n"
+        "addps %%xmm1, %%xmm2\n"
+        "mulps %%xmm1, %%xmm2\n"
+        "movaps %%xmm2, %%xmm3\n"
+        "addps %%xmm0, %%xmm3\n"
+        "mulps %%xmm1, %%xmm3\n"
+        "movaps %%xmm3, %%xmm4\n"
+        "addps %%xmm0, %%xmm4\n"
+        "mulps %%xmm4, %%xmm0\n"
+        
+        "decq %%rcx\n"         // Decrement counter
+        "jnz 1b\n"             // Jump back to label 1 if rcx != 0
+        
+        : // No outputs
+        : "r"(iterations)      // Input constraint: iterations in a register
+        : "rax", "rcx", "xmm0", "xmm1", "xmm2", "xmm3", "xmm4" // Clobbered registers
+    );
+}
@@ -0,0 +1,302 @@
+#include "live_view.h"
+#include "avx_benchmark.h"
+#include "stop_signal.h"
+#include "probe/sources.h"
+
+#include <algorithm>
+#include <chrono>
+#include <csignal>
+#include <cstdio>
+#include <ctime>
+#include <sys/ioctl.h>
+#include <unistd.h>
+
+namespace {
+
+// 256-color palette from red (far below the fastest core) to green
+const int kPalette[] = {196, 202, 208, 214, 220, 226, 190, 154, 118, 82, 46};
+const int kPaletteSize = sizeof(kPalette) / sizeof(kPalette[0]);
+const int kIdleCell = -1;
+const double kScaleFloor = 0.6;     // The coldest color is 60% of the fastest frequency seen
+
+const int kHeatTop = 3;             // First row of the heat map
+const int kLabelWidth = 6;          // "%5d " before each row of cells
+
+void write_all(const std::string& data) {
+    size_t written = 0;
+    while (written < data.size()) {
+        ssize_t n = ::write(STDOUT_FILENO, data.data() + written, data.size() - written);
+        if (n <= 0) {
+            return;
+        }
+        written += n;
+    }
+}
+
+void append_format(std::string& out, const char* format, double a, double b = 0.0) {
+    char buffer[64];
+    int n = snprintf(buffer, sizeof(buffer), format, a, b);
+    out.append(buffer, std::min<int>(n, sizeof(buffer) - 1));
+}
+
+volatile sig_atomic_t g_window_resized = 0;
+
+void handle_window_change(int) {
+    g_window_resized = 1;
+}
+
+void append_cursor(std::string& out, int row, int column) {
+    char buffer[24];
+    int n = snprintf(buffer, sizeof(buffer), "\x1b[%d;%dH", row, column);
+    out.append(buffer, n);
+}
+
+} // namespace
+
+LiveBoard::LiveBoard(const std::vector<int>& cpus)
+    : cpus_(cpus), slots_(new LiveCoreSlot[cpus.size()]) {
+    for (size_t i = 0; i < cpus_.size(); i++) {
+        index_of_cpu_[cpus_[i]] = i;
+    }
+}
+
+LiveCoreSlot* LiveBoard::slot(int cpu) {
+    auto it = index_of_cpu_.find(cpu);
+    return it == index_of_cpu_.end() ? nullptr : &slots_[it->second];
+}
+
+LiveView::LiveView(const LiveBoard& board, int refresh_ms)
+    : board_(board), refresh_ms_(std::max(refresh_ms, 10)) {}
+
+LiveView::~LiveView() {
+    stop();
+}
+
+bool LiveView::start() {
+    if (!isatty(STDOUT_FILENO)) {
+        return false;
+    }
+    size_t cores = board_.cpus().size();
+    prev_cells_.assign(cores, -2);
+    prev_iterations_.assign(cores, 0);
+    rates_.assign(cores, 0.0);
+    frame_.reserve(cores * 24 + 4096);
+    layout();
+
+    // Ctrl+C must not leave the terminal on the alternate screen: the handler
+    // only flags it, and the view restores the screen before the signal is
+    // raised again
+    install_stop_handlers();
+    g_window_resized = 0;
+    signal(SIGWINCH, handle_window_change);
+
+    // Alternate screen, hidden cursor, cleared
+    write_all("\x1b[?1049h\x1b[?25l\x1b[2J");
+    screen_active_ = true;
+    running_ = true;
+    thread_ = std::thread(&LiveView::run, this);
+    return true;
+}
+
+void LiveView::stop() {
+    if (!running_) {
+        return;
+    }
+    running_ = false;
+    if (thread_.joinable()) {
+        thread_.join();
+    }
+    restore_screen();
+    signal(SIGWINCH, SIG_DFL);
+    restore_stop_handlers();
+}
+
+void LiveView::restore_screen() {
+    if (screen_active_.exchange(false)) {
+        write_all("\x1b[0m\x1b[?25h\x1b[?1049l");
+    }
+}
+
+// Fit the heat map to the terminal width and force a full redraw
+void LiveView::layout() {
+    struct winsize size;
+    if (ioctl(STDOUT_FILENO, TIOCGWINSZ, &size) == 0 && size.ws_col > 0) {
+        columns_ = size.ws_col;
+    }
+    cells_per_row_ = std::max(8, (columns_ - kLabelWidth - 1) / 8 * 8);
+    std::fill(prev_cells_.begin(), prev_cells_.end(), -2);
+    prev_lines_.clear();
+}
+
+void LiveView::run() {
+    auto start = std::chrono::steady_clock::now();
+    auto previous = start;
+    cfp::TickSchedule frames(static_cast<uint64_t>(refresh_ms_) * 1000000ULL);
+
+    while (running_) {
+        if (stop_requested()) {
+            // The benchmark threads keep running; end the process the way
+            // the signal would have, with the terminal restored
+            restore_screen();
+            restore_stop_handlers();
+            return;
+        }
+        if (g_window_resized) {
+            g_window_resized = 0;
+            layout();
+            write_all("\x1b[2J");
+        }
+
+        auto now = std::chrono::steady_clock::now();
+        double elapsed = std::chrono::duration<double>(now - start).count();
+        double frame_sec = std::chrono::duration<double>(now - previous).count();
+        previous = now;
+
+        render_frame(elapsed, frame_sec);
+        auto rendered = std::chrono::steady_clock::now();
+        last_render_us_ = std::chrono::duration<double, std::micro>(rendered - now).count();
+
+        frames.wait();
+    }
+}
+
+// Queue a text line, only if it changed since the last frame
+void LiveView::put_line(int row, const std::string& text) {
+    if (static_cast<int>(prev_lines_.size()) <= row) {
+        prev_lines_.resize(row + 1);
+    }
+    if (prev_lines_[row] == text) {
+        return;
+    }
+    append_cursor(frame_, row, 1);
+    frame_ += text;
+    frame_ += "\x1b[K";
+    prev_lines_[row] = text;
+}
+
+void LiveView::render_frame(double elapsed_sec, double frame_sec) {
+    const std::vector<int>& cpus = board_.cpus();
+    size_t cores = cpus.size();
+    frame_.clear();
+
+    // Snapshot every slot once; everything below works on the copy
+    struct Snapshot {
+        int instr;
+        uint32_t khz;
+    };
+    std::vector<Snapshot> snapshot(cores);
+    for (size_t i = 0; i < cores; i++) {
+        const LiveCoreSlot& slot = board_.slot_at(i);
+        snapshot[i].instr = slot.instr.load(std::memory_order_relaxed);
+        snapshot[i].khz = slot.freq_khz.load(std::memory_order_relaxed);
+        uint64_t iterations = slot.iterations.load(std::memory_order_relaxed);
+        // A smaller count means a new run started on this core
+        uint64_t delta = iterations >= prev_iterations_[i] ? iterations - prev_iterations_[i] : iterations;
+        rates_[i] = snapshot[i].instr >= 0 && frame_sec > 0.0 ? delta / frame_sec : 0.0;
+        prev_iterations_[i] = iterations;
+        if (snapshot[i].instr >= 0) {
+            max_khz_seen_ = std::max(max_khz_seen_, static_cast<double>(snapshot[i].khz));
+        }
+    }
+
+    // Heat map: one cell per core, only changed cells are redrawn
+    int rows = static_cast<int>((cores + cells_per_row_ - 1) / cells_per_row_);
+    double low_khz = max_khz_seen_ * kScaleFloor;
+    for (size_t i = 0; i < cores; i++) {
+        int cell = kIdleCell;
+        if (snapshot[i].instr >= 0 && max_khz_seen_ > 0.0) {
+            double ratio = (snapshot[i].khz - low_khz) / (max_khz_seen_ - low_khz);
+            cell = std::clamp(static_cast<int>(ratio * (kPaletteSize - 1) + 0.5), 0, kPaletteSize - 1);
+        }
+        int row = kHeatTop + static_cast<int>(i / cells_per_row_);
+        if (i % cells_per_row_ == 0 && prev_cells_[i] == -2) {
+            char label[16];
+            snprintf(label, sizeof(label), "%5d ", cpus[i]);
+            append_cursor(frame_, row, 1);
+            frame_ += label;
+        }
+        if (cell == prev_cells_[i]) {
+            continue;
+        }
+        append_cursor(frame_, row, kLabelWidth + 1 + static_cast<int>(i % cells_per_row_));
+        if (cell == kIdleCell) {
+            frame_ += "\x1b[0;2m\xc2\xb7\x1b[0m";   // Dim middle dot
+        } else {
+            char color[24];
+            int n = snprintf(color, sizeof(color), "\x1b[38;5;%dm", kPalette[cell]);
+            frame_.append(color, n);
+            frame_ += "\xe2\x96\x88\x1b[0m";       // Full block
+        }
+        prev_cells_[i] = cell;
+    }
+
+    // Title and legend
+    std::string line = "cpu_instr_freq live  ";
+    append_format(line, "%.1f s   ", elapsed_sec);
+    append_format(line, "refresh %.0f ms   render %.0f us", refresh_ms_, last_render_us_);
+    append_format(line, ", %.0f B/frame", static_cast<double>(last_frame_bytes_));
+    put_line(1, line);
+
+    int row = kHeatTop + rows + 1;
+    line = "      ";
+    for (int i = 0; i < kPaletteSize; i++) {
+        char color[24];
+        int n = snprintf(color, sizeof(color), "\x1b[38;5;%dm", kPalette[i]);
+        line.append(color, n);
+        line += "\xe2\x96\x88";
+    }
+    line += "\x1b[0m  ";
+    append_format(line, "%.0f .. %.0f MHz", low_khz / 1000.0, max_khz_seen_ / 1000.0);
+    line += "   \x1b[2m\xc2\xb7\x1b[0m idle";
+    put_line(row, line);
+    row += 2;
+
+    // Per running kernel: cores, frequency spread and throughput
+    struct KernelStats {
+        int cores = 0;
+        double sum_khz = 0.0;
+        uint32_t min_khz = 0;
+        uint32_t max_khz = 0;
+        double rate = 0.0;
+    };
+    std::map<int, KernelStats> kernels;
+    KernelStats total;
+    for (size_t i = 0; i < cores; i++) {
+        if (snapshot[i].instr < 0) {
+            continue;
+        }
+        for (KernelStats* stats : {&kernels[snapshot[i].instr], &total}) {
+            stats->min_khz = stats->cores == 0 ? snapshot[i].khz : std::min(stats->min_khz, snapshot[i].khz);
+            stats->max_khz = std::max(stats->max_khz, snapshot[i].khz);
+            stats->sum_khz += snapshot[i].khz;
+            stats->rate += rates_[i];
+            stats->cores++;
+        }
+    }
+
+    char text[160];
+    snprintf(text, sizeof(text), "%-12s %6s %10s %10s %10s %12s", "Kernel", "Cores", "Avg MHz", "Min MHz", "Max MHz", "M iter/s");
+    put_line(row++, text);
+    auto stats_line = [&text](const std::string& name, const KernelStats& stats) {
+        snprintf(text, sizeof(text), "%-12s %6d %10.0f %10.0f %10.0f %12.2f", name.c_str(), stats.cores,
+                 stats.cores > 0 ? stats.sum_khz / stats.cores / 1000.0 : 0.0,
+                 stats.min_khz / 1000.0, stats.max_khz / 1000.0, stats.rate / 1e6);
+        return std::string(text);
+    };
+    for (const auto& [instr, stats] : kernels) {
+        put_line(row++, stats_line(get_instruction_set_name(static_cast<InstructionSet>(instr)), stats));
+    }
+    put_line(row++, stats_line("All", total));
+    snprintf(text, sizeof(text), "%zu of %zu cores running", static_cast<size_t>(total.cores), cores);
+    put_line(row++, text);
+
+    // Clear lines left over from a frame that had more kernels
+    while (row < static_cast<int>(prev_lines_.size())) {
+        put_line(row++, "");
+    }
+
+    last_frame_bytes_ = frame_.size();
+    if (!frame_.empty()) {
+        write_all(frame_);
+    }
+}
@@ -1,12 +1,35 @@
 #include "cpu_utils.h"
 #include "avx_benchmark.h"
+#include "worker_pool.h"
+#include "sweep.h"
+#include "overhead.h"
+#include "scenario.h"
+#include "scenario_file.h"
+#include "daemon.h"
+#include "exporter.h"
+#include "monitor.h"
+#include "trace_capture.h"
+#include "synthetic_tree.h"
+#include "raw_trace.h"
+#include "compare.h"
+#include "suite.h"
+#include "smt.h"
+#include "kernels.h"
+#include "chrome_trace.h"
+#include "live_view.h"
+#include "topology.h"
+#include "probe/sources.h"
 
 #include <iostream>
+#include <fstream>
 #include <string>
 #include <cstdlib>
 #include <vector>
 #include <thread>
 #include <map>
+#include <set>
+#include <algorithm>
+#include <chrono>
 #include <iomanip> // Added for std::setw and std::setprecision
 
 void print_usage(const char* program_name) {
@@ -18,15 +41,67 @@ void print_usage(const char* program_name) {
     std::cout << "  --core=ID          CPU core to run the benchmark on (default: 0)" << std::endl;
     std::cout << "  --all-cores        Run the benchmark on all cores in parallel" << std::endl;
     std::cout << "  --all-cores-seq    Run the benchmark on all cores sequentially" << std::endl;
+    std::cout << "  --memory=PLACEMENT Bind each run's memory to the CPU's node (local, default) or the nearest other node (remote)" << std::endl;
+    std::cout << "  --live             With --all-cores or --all-cores-seq: full-screen per-core frequency and throughput view" << std::endl;
+    std::cout << "  --refresh-ms=MS    Redraw interval of --live (default: 250)" << std::endl;
     std::cout << "  --list             List available CPU features and exit" << std::endl;
     std::cout << "  --monitor-freq     Monitor CPU frequency during benchmark" << std::endl;
     std::cout << "  --freq-only        Only display frequencies of all cores and exit" << std::endl;
+    std::cout << "  --sweep            Run each ISA on 1, 2, 4 ... N cores at once and print a frequency table" << std::endl;
+    std::cout << "                     (all ISAs unless --instr lists them, e.g. --instr=avx256,avx512)" << std::endl;
+    std::cout << "  --overhead         Measure what frequency sampling costs: each ISA unobserved, then at each --rates interval" << std::endl;
+    std::cout << "  --rates=MS,...     Sampling intervals for --overhead (default: 1,10,100,1000)" << std::endl;
+    std::cout << "  --suite            Run every ISA (or --instr list) in every --placements mode in one process, one JSON report" << std::endl;
+    std::cout << "  --placements=LIST  Suite placements: single, parallel, sequential (default: single,parallel;" << std::endl;
+    std::cout << "                     single only with --core)" << std::endl;
+    std::cout << "  --smt              Compare SMT placements on every core with two usable hyperthreads, --instr as primary kernel" << std::endl;
+    std::cout << "  --smt-policies=L   SMT policies: one-per-core, same, mixed (default: all three)" << std::endl;
+    std::cout << "  --smt-mix=ISA      Kernel on the siblings in the mixed policy (default: basic_add)" << std::endl;
+    std::cout << "  --cooldown=SECONDS Idle time between sweep or overhead runs (default: 0)" << std::endl;
+    std::cout << "  --group=ISA:CPUS   Run ISA on a CPU list (e.g. avx512:0-15); repeat for a mixed workload" << std::endl;
+    std::cout << "                     that is compared against each group running alone" << std::endl;
+    std::cout << "  --scenario-file=F  Run the multi-phase plan in scenario file F and write one JSON result" << std::endl;
+    std::cout << "  --output=FILE      Write the JSON result to FILE instead of stdout" << std::endl;
+    std::cout << "  --compare=FILE     Re-run the scenario of report FILE (from --scenario-file) and test each core and ISA" << std::endl;
+    std::cout << "                     for a frequency regression; exits with 2 if any is found" << std::endl;
+    std::cout << "  --test=TEST        Comparison test: mwu (Mann-Whitney U) or bootstrap (default: mwu)" << std::endl;
+    std::cout << "  --threshold=PCT    Smallest frequency drop that counts as a regression (default: 2)" << std::endl;
+    std::cout << "  --alpha=P          Significance level of the comparison (default: 0.05)" << std::endl;
+    std::cout << "  --chrome-trace=F   Also write a single-core, --suite or --scenario-file run as a Chrome/Perfetto trace" << std::endl;
+    std::cout << "  --record=FILE      Single-core run: also save every raw reading (samples, energy, batch TSC) to FILE" << std::endl;
+    std::cout << "  --replay=FILE      Recompute and print the result of a --record file without running anything" << std::endl;
+    std::cout << "  --daemon           Publish per-core frequency, temperature and power to shared memory until stopped" << std::endl;
+    std::cout << "  --shm-name=NAME    Daemon shared-memory segment name (default: " CFS_DEFAULT_NAME ")" << std::endl;
+    std::cout << "  --force            Let --daemon replace a segment published by a running daemon" << std::endl;
+    std::cout << "  --monitor          Record CPU frequencies to a file until stopped (all CPUs, or --core=ID)" << std::endl;
+    std::cout << "  --format=FMT       Monitor output format: csv, binary or chrome (default: csv)" << std::endl;
+    std::cout << "  --rotate-size=MB   Start a new monitor file after MB megabytes" << std::endl;
+    std::cout << "  --rotate-time=SEC  Start a new monitor file after SEC seconds" << std::endl;
+    std::cout << "  --trace-events     Record power:cpu_frequency/cpu_idle tracepoint events until stopped" << std::endl;
+    std::cout << "  --tracefs=DIR      tracefs root for --trace-events; a non-tracefs directory is replayed as a capture" << std::endl;
+    std::cout << "  --no-idle          Leave out power:cpu_idle events" << std::endl;
+    std::cout << "  --fs-root=DIR      Read every sysfs/procfs path below DIR (e.g. a synthetic tree)" << std::endl;
+    std::cout << "  --synth-tree=DIR   Build a synthetic sysfs/procfs tree in DIR and play --timeline into it" << std::endl;
+    std::cout << "  --synth-cpus=N     CPUs in the synthetic tree (default: 8)" << std::endl;
+    std::cout << "  --synth-packages=N Packages in the synthetic tree (default: 1)" << std::endl;
+    std::cout << "  --synth-smt=N      Threads per core in the synthetic tree (default: 1)" << std::endl;
+    std::cout << "  --timeline=FILE    Frequency script for --synth-tree: lines of 'SECONDS CPUS KHZ'" << std::endl;
+    std::cout << "  --exporter         Serve OpenMetrics text over HTTP until stopped" << std::endl;
+    std::cout << "  --listen=ADDR      Exporter address: unix:PATH, PORT or localhost:PORT (default: unix:/tmp/cpu_instr_freq.sock)" << std::endl;
+    std::cout << "  --rate-ms=MS       Sampling interval (default: 100, daemon: 10, exporter and monitor: 1000)" << std::endl;
+    std::cout << "  --adaptive         Stop once frequency reaches a steady state instead of after --time" << std::endl;
+    std::cout << "  --min-time=SECONDS Adaptive mode: minimum run time (default: 2)" << std::endl;
+    std::cout << "  --max-time=SECONDS Adaptive mode: maximum run time (default: 60)" << std::endl;
+    std::cout << "  --ci=MHZ           Adaptive mode: target 95% CI half-width of the steady mean (default: 5)" << std::endl;
     std::cout << std::endl;
     std::cout << "Example: " << program_name << " --instr=avx256 --time=10 --core=3" << std::endl;
     std::cout << "Example: " << program_name << " --instr=avx256 --time=10 --all-cores" << std::endl;
+    std::cout << "Example: " << program_name << " --instr=avx512 --adaptive --max-time=120" << std::endl;
+    std::cout << "Example: " << program_name << " --group=avx512:0-15 --group=basic_add:16-31 --time=10" << std::endl;
 }
 
-void run_benchmark_with_frequency_monitoring(InstructionSet instr_set, int duration_sec, int core_id) {
+void run_benchmark_with_frequency_monitoring(InstructionSet instr_set, const BenchmarkOptions& options, int core_id) {
+    int duration_sec = options.duration_sec;
     // Start frequency monitoring in a separate thread
     std::thread monitor_thread([core_id, duration_sec]() {
         // Sample every 100ms
@@ -46,13 +121,54 @@ void run_benchmark_with_frequency_monitoring(InstructionSet instr_set, int durat
     });
     
     // Run the benchmark
-    run_benchmark(instr_set, duration_sec, core_id);
+    run_benchmark(instr_set, options, core_id);
     
     // Wait for monitoring to complete
     monitor_thread.join();
 }
 
-void run_benchmark_on_all_cores(InstructionSet instr_set, int duration_sec, bool monitor_freq) {
+// Warn about pool workers that could not be pinned; their runs report N/A
+void report_unpinned_workers(const WorkerPool& pool) {
+    for (int core_id : pool.cpus()) {
+        if (!pool.is_pinned(core_id)) {
+            std::cerr << "Warning: could not pin worker to core " << core_id << ", skipping it" << std::endl;
+        }
+    }
+}
+
+// Where the cores' sample storage ended up, relative to each core's node
+void print_memory_placement(const CoreResults& results) {
+    int local = 0, remote = 0;
+    size_t off_node = 0;
+    for (const auto& [core_id, result] : results) {
+        if (!result.success || result.memory_node < 0) {
+            continue;
+        }
+        (result.memory_node == result.cpu_node ? local : remote)++;
+        off_node += result.memory_pages_off_node;
+    }
+    if (local + remote > 0) {
+        std::cout << "Sample storage: " << local << " core(s) on their local node, " << remote << " on a remote node" << std::endl;
+    }
+    if (off_node > 0) {
+        std::cout << "Warning: " << off_node << " page(s) of sample storage did not land on their bound node" << std::endl;
+    }
+}
+
+// Runs with a live view publish to its board; returns false (and leaves the
+// options alone) if stdout is not a terminal
+bool start_live_view(LiveView& view, LiveBoard& board, BenchmarkOptions& options) {
+    if (!view.start()) {
+        std::cerr << "Warning: --live needs a terminal, continuing without it" << std::endl;
+        return false;
+    }
+    options.live_board = &board;
+    return true;
+}
+
+void run_benchmark_on_all_cores(WorkerPool& pool, InstructionSet instr_set, BenchmarkOptions options, bool monitor_freq,
+                                int live_refresh_ms) {
+    int duration_sec = options.duration_sec;
     std::cout << "Running benchmark on all cores in parallel..." << std::endl;
     
     // Start frequency monitoring if requested
@@ -68,23 +184,24 @@ void run_benchmark_on_all_cores(InstructionSet instr_set, int duration_sec, bool
     }
     
     // Collect results from each core
-    int core_count = get_core_count();
-    std::vector<BenchmarkResult> results(core_count);
-    std::vector<std::thread> threads;
-    
-    // Launch benchmark threads for each core
-    for (int core_id = 0; core_id < core_count; core_id++) {
-        threads.emplace_back([core_id, instr_set, duration_sec, &results]() {
-            results[core_id] = run_benchmark_with_result(instr_set, duration_sec, core_id);
-        });
+    CoreResults results;
+    
+    // Queue one benchmark on each pinned worker; a spin barrier holds them so
+    // all kernels start together
+    std::vector<CoreAssignment> assignments;
+    for (int core_id : pool.cpus()) {
+        assignments.push_back({core_id, instr_set});
     }
     
-    // Wait for all benchmarks to complete
-    for (auto& t : threads) {
-        if (t.joinable()) {
-            t.join();
-        }
+    LiveBoard board(pool.cpus());
+    LiveView view(board, live_refresh_ms);
+    if (live_refresh_ms > 0) {
+        start_live_view(view, board, options);
     }
+    for (auto& result : run_synchronized(pool, assignments, options)) {
+        results[result.core_id] = std::move(result);
+    }
+    view.stop();
     
     // Wait for monitoring to complete if requested
     if (monitor_freq && monitor_thread.joinable()) {
@@ -99,17 +216,20 @@ void run_benchmark_on_all_cores(InstructionSet instr_set, int duration_sec, bool
     std::cout << "Core ID  |   Min Freq (MHz)  |   Max Freq (MHz)  |   Avg Freq (MHz)" << std::endl;
     std::cout << "---------|-------------------|-------------------|------------------" << std::endl;
     
-    for (int core_id = 0; core_id < core_count; core_id++) {
-        if (results[core_id].success) {
+    for (const auto& [core_id, result] : results) {
+        if (result.success) {
             std::cout << std::setw(8) << core_id << " | " 
-                      << std::fixed << std::setw(17) << std::setprecision(2) << results[core_id].min_freq << " | "
-                      << std::fixed << std::setw(17) << std::setprecision(2) << results[core_id].max_freq << " | "
-                      << std::fixed << std::setw(17) << std::setprecision(2) << results[core_id].avg_freq << std::endl;
+                      << std::fixed << std::setw(17) << std::setprecision(2) << result.min_freq << " | "
+                      << std::fixed << std::setw(17) << std::setprecision(2) << result.max_freq << " | "
+                      << std::fixed << std::setw(17) << std::setprecision(2) << result.avg_freq << std::endl;
         } else {
             std::cout << std::setw(8) << core_id << " |         N/A        |         N/A        |         N/A" << std::endl;
         }
     }
     
+    print_start_alignment(results);
+    print_memory_placement(results);
+    
     // If monitoring was done separately, show those results too
     if (monitor_freq && !all_frequencies.empty()) {
         std::cout << "\nFrequency Monitoring Results:" << std::endl;
@@ -124,17 +244,23 @@ void run_benchmark_on_all_cores(InstructionSet instr_set, int duration_sec, bool
     }
 }
 
-void run_benchmark_on_all_cores_sequential(InstructionSet instr_set, int duration_sec, bool monitor_freq) {
+void run_benchmark_on_all_cores_sequential(WorkerPool& pool, InstructionSet instr_set, BenchmarkOptions options,
+                                           int live_refresh_ms) {
     std::cout << "Running benchmark on all cores sequentially..." << std::endl;
     
     // Collect results from each core one at a time
-    int core_count = get_core_count();
-    std::vector<BenchmarkResult> results(core_count);
+    CoreResults results;
     
-    for (int core_id = 0; core_id < core_count; core_id++) {
-        std::cout << "Running benchmark on core " << core_id << "..." << std::endl;
-        results[core_id] = run_benchmark_with_result(instr_set, duration_sec, core_id);
+    LiveBoard board(pool.cpus());
+    LiveView view(board, live_refresh_ms);
+    bool live = live_refresh_ms > 0 && start_live_view(view, board, options);
+    for (int core_id : pool.cpus()) {
+        if (!live) {
+            std::cout << "Running benchmark on core " << core_id << "..." << std::endl;
+        }
+        results[core_id] = pool.submit_benchmark(core_id, instr_set, options).get();
     }
+    view.stop();
     
     // Display results in an organized manner
     std::string instr_name = get_instruction_set_name(instr_set);
@@ -144,16 +270,182 @@ void run_benchmark_on_all_cores_sequential(InstructionSet instr_set, int duratio
     std::cout << "Core ID  |   Min Freq (MHz)  |   Max Freq (MHz)  |   Avg Freq (MHz)" << std::endl;
     std::cout << "---------|-------------------|-------------------|------------------" << std::endl;
     
-    for (int core_id = 0; core_id < core_count; core_id++) {
-        if (results[core_id].success) {
+    for (const auto& [core_id, result] : results) {
+        if (result.success) {
             std::cout << std::setw(8) << core_id << " | " 
-                      << std::fixed << std::setw(17) << std::setprecision(2) << results[core_id].min_freq << " | "
-                      << std::fixed << std::setw(17) << std::setprecision(2) << results[core_id].max_freq << " | "
-                      << std::fixed << std::setw(17) << std::setprecision(2) << results[core_id].avg_freq << std::endl;
+                      << std::fixed << std::setw(17) << std::setprecision(2) << result.min_freq << " | "
+                      << std::fixed << std::setw(17) << std::setprecision(2) << result.max_freq << " | "
+                      << std::fixed << std::setw(17) << std::setprecision(2) << result.avg_freq << std::endl;
         } else {
             std::cout << std::setw(8) << core_id << " |         N/A        |         N/A        |         N/A" << std::endl;
         }
     }
+    
+    print_memory_placement(results);
+}
+
+// Why a CPU cannot be benchmarked, e.g. "is outside cgroup cpuset"
+std::string describe_unusable_cpu(int cpu) {
+    std::map<int, CpuStatus> availability = get_cpu_availability();
+    auto it = availability.find(cpu);
+    if (it == availability.end()) {
+        return "does not exist";
+    }
+    return "is " + get_cpu_status_name(it->second);
+}
+
+// Report the first CPU of a scenario that this machine cannot run on
+bool check_scenario_cpus(const Scenario& scenario) {
+    std::vector<int> usable = get_benchmark_cpus();
+    for (int cpu : scenario_cpus(scenario)) {
+        if (std::find(usable.begin(), usable.end(), cpu) == usable.end()) {
+            std::cerr << "Error: CPU " << cpu << " in " << scenario.path << " " << describe_unusable_cpu(cpu) << std::endl;
+            return false;
+        }
+    }
+    return true;
+}
+
+// Write runs as a Chrome trace if a path was given; false on failure
+bool write_trace_if_requested(const std::string& trace_path, const std::vector<TraceRun>& runs) {
+    if (trace_path.empty()) {
+        return true;
+    }
+    try {
+        write_chrome_trace(trace_path, runs);
+    } catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << std::endl;
+        return false;
+    }
+    std::cout << "Trace written to " << trace_path << std::endl;
+    return true;
+}
+
+// Load and execute a scenario file, then write its JSON result
+int run_scenario_file(const std::string& scenario_path, const std::string& output_path, const std::string& trace_path) {
+    Scenario scenario;
+    try {
+        scenario = load_scenario_file(scenario_path);
+    } catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << std::endl;
+        return 1;
+    }
+    
+    if (!check_scenario_cpus(scenario)) {
+        return 1;
+    }
+    for (auto& phase : scenario.phases) {
+        phase.options.sample_package_power = !trace_path.empty();
+    }
+    
+    print_cpu_info();
+    WorkerPool pool(scenario_cpus(scenario));
+    report_unpinned_workers(pool);
+    std::vector<PhaseResult> phase_results = run_scenario(pool, scenario);
+    
+    std::vector<TraceRun> runs;
+    for (size_t i = 0; i < phase_results.size(); i++) {
+        for (size_t j = 0; j < phase_results[i].results.size(); j++) {
+            runs.push_back({scenario.phases[i].name, phase_results[i].assignments[j].instr_set, &phase_results[i].results[j]});
+        }
+    }
+    if (!write_trace_if_requested(trace_path, runs)) {
+        return 1;
+    }
+    
+    if (output_path.empty()) {
+        write_scenario_report(std::cout, scenario, phase_results);
+        return 0;
+    }
+    
+    std::ofstream output(output_path);
+    if (!output.is_open()) {
+        std::cerr << "Error: cannot write " << output_path << std::endl;
+        return 1;
+    }
+    write_scenario_report(output, scenario, phase_results);
+    std::cout << "\nResults written to " << output_path << std::endl;
+    return 0;
+}
+
+// Re-run the scenario behind a stored report and test every core against it.
+// Exits with 2 when a regression is found so rollout gates can tell it from an error.
+int run_compare(const CompareOptions& compare_options, std::string scenario_path, const std::string& output_path) {
+    BaselineReport baseline;
+    Scenario scenario;
+    try {
+        baseline = load_baseline_report(compare_options.baseline_path);
+        if (scenario_path.empty()) {
+            scenario_path = baseline.scenario_path;
+        }
+        scenario = load_scenario_file(scenario_path);
+    } catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << std::endl;
+        return 1;
+    }
+    
+    if (!check_scenario_cpus(scenario)) {
+        return 1;
+    }
+    
+    print_cpu_info();
+    WorkerPool pool(scenario_cpus(scenario));
+    report_unpinned_workers(pool);
+    std::vector<PhaseResult> phase_results = run_scenario(pool, scenario);
+    
+    std::vector<CoreComparison> comparisons;
+    try {
+        comparisons = compare_with_baseline(baseline, scenario, phase_results, compare_options);
+    } catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << std::endl;
+        return 1;
+    }
+    print_comparison(comparisons, compare_options);
+    
+    if (!output_path.empty()) {
+        std::ofstream output(output_path);
+        if (!output.is_open()) {
+            std::cerr << "Error: cannot write " << output_path << std::endl;
+            return 1;
+        }
+        write_comparison_report(output, comparisons, compare_options, scenario_path);
+        std::cout << "\nComparison written to " << output_path << std::endl;
+    }
+    
+    for (const auto& comparison : comparisons) {
+        if (comparison.regression) {
+            return 2;
+        }
+    }
+    return 0;
+}
+
+// Rebuild a recorded run from its raw readings and print it like a live run
+int run_replay(const std::string& trace_path, const std::string& output_path) {
+    RawTrace trace;
+    try {
+        trace = load_raw_trace(trace_path);
+    } catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << std::endl;
+        return 1;
+    }
+    
+    BenchmarkResult result = replay_raw_trace(trace);
+    std::cout << "Replaying " << trace_path << " (" << trace.frequencies.size() << " samples, "
+              << trace.batch_end_tsc.size() << " batches)" << std::endl;
+    print_benchmark_result(result, get_instruction_set_name(trace.instr_set));
+    print_frequency_timeline(result);
+    
+    if (!output_path.empty()) {
+        std::ofstream output(output_path);
+        if (!output.is_open()) {
+            std::cerr << "Error: cannot write " << output_path << std::endl;
+            return 1;
+        }
+        write_replay_report(output, trace, result);
+        std::cout << "\nResults written to " << output_path << std::endl;
+    }
+    return result.success ? 0 : 1;
 }
 
 int main(int argc, char** argv) {
@@ -161,12 +453,48 @@ int main(int argc, char** argv) {
     std::string instr_type = "avx256";
     int duration_sec = 5;
     int core_id = 0;
+    bool core_given = false;
     bool show_help = false;
     bool list_features = false;
     bool use_all_cores = false;
     bool use_all_cores_sequential = false;
     bool monitor_freq = false;
+    bool live = false;
+    int refresh_ms = 250;
     bool freq_only = false;
+    bool sweep = false;
+    bool overhead = false;
+    bool suite = false;
+    bool smt = false;
+    std::string smt_policies = "one-per-core,same,mixed";
+    std::string smt_mix = "basic_add";
+    std::string placements;
+    std::string overhead_rates = "1,10,100,1000";
+    bool instr_given = false;
+    int cooldown_sec = 0;
+    std::vector<std::string> group_specs;
+    std::string scenario_path;
+    std::string output_path;
+    std::string record_path;
+    std::string chrome_trace_path;
+    CompareOptions compare_options;
+    std::string compare_test = "mwu";
+    std::string memory_placement = "local";
+    std::string replay_path;
+    bool daemon = false;
+    DaemonOptions daemon_options;
+    bool exporter = false;
+    ExporterOptions exporter_options;
+    std::string fs_root;
+    bool synth_tree = false;
+    SyntheticTreeOptions synth_options;
+    bool trace_events = false;
+    TraceCaptureOptions trace_options;
+    bool monitor = false;
+    MonitorOptions monitor_options;
+    std::string format_name = "csv";
+    int rate_ms = 0;
+    BenchmarkOptions options;
     
     // Parse command line arguments
     for (int i = 1; i < argc; i++) {
@@ -176,20 +504,117 @@ int main(int argc, char** argv) {
             show_help = true;
         } else if (arg.find("--instr=") == 0) {
             instr_type = arg.substr(8);
+            instr_given = true;
         } else if (arg.find("--time=") == 0) {
             duration_sec = std::atoi(arg.substr(7).c_str());
         } else if (arg.find("--core=") == 0) {
             core_id = std::atoi(arg.substr(7).c_str());
+            core_given = true;
         } else if (arg == "--all-cores") {
             use_all_cores = true;
         } else if (arg == "--all-cores-seq") {
             use_all_cores_sequential = true;
         } else if (arg == "--list") {
             list_features = true;
+        } else if (arg == "--live") {
+            live = true;
+        } else if (arg.find("--refresh-ms=") == 0) {
+            refresh_ms = std::max(10, std::atoi(arg.substr(13).c_str()));
         } else if (arg == "--monitor-freq") {
             monitor_freq = true;
         } else if (arg == "--freq-only") {
             freq_only = true;
+        } else if (arg == "--sweep") {
+            sweep = true;
+        } else if (arg == "--smt") {
+            smt = true;
+        } else if (arg.find("--smt-policies=") == 0) {
+            smt_policies = arg.substr(15);
+        } else if (arg.find("--smt-mix=") == 0) {
+            smt_mix = arg.substr(10);
+        } else if (arg == "--suite") {
+            suite = true;
+        } else if (arg.find("--placements=") == 0) {
+            placements = arg.substr(13);
+        } else if (arg == "--overhead") {
+            overhead = true;
+        } else if (arg.find("--rates=") == 0) {
+            overhead_rates = arg.substr(8);
+        } else if (arg.find("--cooldown=") == 0) {
+            cooldown_sec = std::atoi(arg.substr(11).c_str());
+        } else if (arg.find("--group=") == 0) {
+            group_specs.push_back(arg.substr(8));
+        } else if (arg.find("--scenario-file=") == 0) {
+            scenario_path = arg.substr(16);
+        } else if (arg.find("--output=") == 0) {
+            output_path = arg.substr(9);
+        } else if (arg.find("--compare=") == 0) {
+            compare_options.baseline_path = arg.substr(10);
+        } else if (arg.find("--memory=") == 0) {
+            memory_placement = arg.substr(9);
+        } else if (arg.find("--test=") == 0) {
+            compare_test = arg.substr(7);
+        } else if (arg.find("--threshold=") == 0) {
+            compare_options.threshold_pct = std::atof(arg.substr(12).c_str());
+        } else if (arg.find("--alpha=") == 0) {
+            compare_options.alpha = std::atof(arg.substr(8).c_str());
+        } else if (arg.find("--chrome-trace=") == 0) {
+            chrome_trace_path = arg.substr(15);
+        } else if (arg.find("--record=") == 0) {
+            record_path = arg.substr(9);
+        } else if (arg.find("--replay=") == 0) {
+            replay_path = arg.substr(9);
+        } else if (arg == "--daemon") {
+            daemon = true;
+        } else if (arg.find("--shm-name=") == 0) {
+            daemon_options.shm_name = arg.substr(11);
+        } else if (arg == "--force") {
+            daemon_options.force = true;
+        } else if (arg == "--monitor") {
+            monitor = true;
+        } else if (arg.find("--format=") == 0) {
+            format_name = arg.substr(9);
+        } else if (arg.find("--rotate-size=") == 0) {
+            monitor_options.rotate_bytes = static_cast<uint64_t>(std::atof(arg.substr(14).c_str()) * 1024 * 1024);
+        } else if (arg.find("--rotate-time=") == 0) {
+            monitor_options.rotate_sec = std::atoi(arg.substr(14).c_str());
+        } else if (arg.find("--fs-root=") == 0) {
+            fs_root = arg.substr(10);
+        } else if (arg.find("--synth-tree=") == 0) {
+            synth_tree = true;
+            synth_options.root = arg.substr(13);
+        } else if (arg.find("--synth-cpus=") == 0) {
+            synth_options.cpus = std::atoi(arg.substr(13).c_str());
+        } else if (arg.find("--synth-packages=") == 0) {
+            synth_options.packages = std::atoi(arg.substr(17).c_str());
+        } else if (arg.find("--synth-smt=") == 0) {
+            synth_options.threads_per_core = std::atoi(arg.substr(12).c_str());
+        } else if (arg.find("--timeline=") == 0) {
+            synth_options.timeline_path = arg.substr(11);
+        } else if (arg == "--trace-events") {
+            trace_events = true;
+        } else if (arg.find("--tracefs=") == 0) {
+            trace_options.tracefs_root = arg.substr(10);
+        } else if (arg == "--no-idle") {
+            trace_options.idle_events = false;
+        } else if (arg == "--exporter") {
+            exporter = true;
+        } else if (arg.find("--listen=") == 0) {
+            exporter_options.listen = arg.substr(9);
+        } else if (arg.find("--rate-ms=") == 0) {
+            rate_ms = std::atoi(arg.substr(10).c_str());
+            if (rate_ms <= 0) {
+                std::cerr << "Error: --rate-ms must be greater than 0" << std::endl;
+                return 1;
+            }
+        } else if (arg == "--adaptive") {
+            options.adaptive = true;
+        } else if (arg.find("--min-time=") == 0) {
+            options.steady_state.min_sec = std::atof(arg.substr(11).c_str());
+        } else if (arg.find("--max-time=") == 0) {
+            options.steady_state.max_sec = std::atof(arg.substr(11).c_str());
+        } else if (arg.find("--ci=") == 0) {
+            options.steady_state.ci_target_mhz = std::atof(arg.substr(5).c_str());
         } else {
             std::cerr << "Unknown option: " << arg << std::endl;
             print_usage(argv[0]);
@@ -202,6 +627,15 @@ int main(int argc, char** argv) {
         return 0;
     }
     
+    if (synth_tree) {
+        return run_synthetic_tree(synth_options);
+    }
+    
+    // Every source reads below the injected root from here on
+    if (!fs_root.empty()) {
+        cfp::set_fs_root(fs_root);
+    }
+    
     // Only print CPU info and return if --list was specified
     if (list_features) {
         print_cpu_info();
@@ -214,17 +648,271 @@ int main(int argc, char** argv) {
         return 0;
     }
     
+    if (rate_ms > 0) {
+        options.sampling_interval_ms = rate_ms;
+        daemon_options.interval_ms = rate_ms;
+        exporter_options.interval_ms = rate_ms;
+        monitor_options.interval_ms = rate_ms;
+    }
+    
+    if (daemon) {
+        return run_daemon(daemon_options);
+    }
+    if (exporter) {
+        return run_exporter(exporter_options);
+    }
+    if (trace_events) {
+        if (core_given) {
+            trace_options.cpus = {core_id};
+        }
+        trace_options.output_path = output_path;
+        return run_trace_capture(trace_options);
+    }
+    if (monitor) {
+        if (core_given) {
+            monitor_options.cpus = {core_id};
+        }
+        monitor_options.output_path = output_path;
+        try {
+            monitor_options.format = string_to_trace_format(format_name);
+        } catch (const std::exception& e) {
+            std::cerr << "Error: " << e.what() << std::endl;
+            return 1;
+        }
+        return run_monitor(monitor_options);
+    }
+    
+    // A recorded trace carries everything its result is computed from
+    if (!replay_path.empty()) {
+        return run_replay(replay_path, output_path);
+    }
+    
+    if (!compare_options.baseline_path.empty()) {
+        try {
+            compare_options.test = string_to_compare_test(compare_test);
+        } catch (const std::exception& e) {
+            std::cerr << "Error: " << e.what() << std::endl;
+            return 1;
+        }
+        if (compare_options.threshold_pct < 0 || compare_options.alpha <= 0 || compare_options.alpha >= 1) {
+            std::cerr << "Error: --compare needs --threshold >= 0 and 0 < --alpha < 1" << std::endl;
+            return 1;
+        }
+        return run_compare(compare_options, scenario_path, output_path);
+    }
+    
+    // A scenario file carries its own durations, placements and sampling settings
+    if (!scenario_path.empty()) {
+        return run_scenario_file(scenario_path, output_path, chrome_trace_path);
+    }
+    
     // Validate parameters
     if (duration_sec <= 0) {
         std::cerr << "Error: Duration must be greater than 0" << std::endl;
         return 1;
     }
     
-    int max_core = get_max_core_id();
-    if (core_id < 0 || core_id > max_core) {
-        std::cerr << "Error: Core ID must be between 0 and " << max_core << std::endl;
+    if (options.adaptive) {
+        if (options.steady_state.min_sec <= 0 || options.steady_state.max_sec < options.steady_state.min_sec) {
+            std::cerr << "Error: Adaptive mode needs 0 < --min-time <= --max-time" << std::endl;
+            return 1;
+        }
+        if (options.steady_state.ci_target_mhz <= 0) {
+            std::cerr << "Error: --ci must be greater than 0" << std::endl;
+            return 1;
+        }
+        if (monitor_freq) {
+            std::cerr << "Error: --monitor-freq samples for a fixed time and cannot be combined with --adaptive" << std::endl;
+            return 1;
+        }
+    }
+    options.duration_sec = duration_sec;
+    // A Chrome trace gets a package power track next to the frequencies
+    options.sample_package_power = !chrome_trace_path.empty();
+    
+    try {
+        options.memory_placement = string_to_memory_placement(memory_placement);
+    } catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << std::endl;
         return 1;
     }
+    if (options.memory_placement == MemoryPlacement::REMOTE && get_numa_nodes().size() < 2) {
+        std::cerr << "Error: --memory=remote needs at least two NUMA nodes" << std::endl;
+        return 1;
+    }
+    
+    // Only CPUs that are online, in our cpuset and in our affinity mask can be
+    // pinned; without --core= the first of those is used
+    std::vector<int> usable = get_benchmark_cpus();
+    if (usable.empty()) {
+        std::cerr << "Error: No usable CPUs (check the affinity mask and cgroup cpuset)" << std::endl;
+        return 1;
+    }
+    if (!core_given) {
+        core_id = usable.front();
+    } else if (std::find(usable.begin(), usable.end(), core_id) == usable.end()) {
+        std::cerr << "Error: Core " << core_id << " " << describe_unusable_cpu(core_id)
+                  << " (usable: " << format_cpu_list(usable) << ")" << std::endl;
+        return 1;
+    }
+    
+    if (suite) {
+        SuiteOptions suite_options;
+        suite_options.instr_sets = all_instruction_sets();
+        suite_options.options = options;
+        suite_options.cooldown_sec = cooldown_sec;
+        if (core_given) {
+            suite_options.single_cpus = {core_id};
+        }
+        try {
+            if (instr_given) {
+                suite_options.instr_sets = string_to_instruction_set_list(instr_type);
+            }
+            std::string default_placements = core_given ? "single" : "single,parallel";
+            suite_options.placements = parse_placement_list(placements.empty() ? default_placements : placements);
+        } catch (const std::exception& e) {
+            std::cerr << "Error: " << e.what() << std::endl;
+            return 1;
+        }
+        print_cpu_info();
+        
+        auto start = std::chrono::steady_clock::now();
+        WorkerPool pool(get_benchmark_cpus());
+        report_unpinned_workers(pool);
+        std::vector<SuiteEntry> entries = run_suite(pool, suite_options);
+        double wall_sec = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        print_suite_summary(entries);
+        std::cout << "\nSuite wall time: " << std::fixed << std::setprecision(1) << wall_sec << " s" << std::endl;
+        
+        std::vector<TraceRun> runs;
+        for (const auto& entry : entries) {
+            for (const auto& result : entry.results) {
+                runs.push_back({get_placement_name(entry.placement), entry.instr_set, &result});
+            }
+        }
+        if (!write_trace_if_requested(chrome_trace_path, runs)) {
+            return 1;
+        }
+        
+        if (output_path.empty()) {
+            write_suite_report(std::cout, suite_options, entries, wall_sec);
+            return 0;
+        }
+        std::ofstream output(output_path);
+        if (!output.is_open()) {
+            std::cerr << "Error: cannot write " << output_path << std::endl;
+            return 1;
+        }
+        write_suite_report(output, suite_options, entries, wall_sec);
+        std::cout << "\nResults written to " << output_path << std::endl;
+        return 0;
+    }
+    
+    if (smt) {
+        SmtOptions smt_options;
+        smt_options.options = options;
+        smt_options.cooldown_sec = cooldown_sec;
+        try {
+            smt_options.primary = string_to_instruction_set(instr_type);
+            smt_options.secondary = string_to_instruction_set(smt_mix);
+            smt_options.policies = parse_smt_policy_list(smt_policies);
+        } catch (const std::exception& e) {
+            std::cerr << "Error: " << e.what() << std::endl;
+            return 1;
+        }
+        for (InstructionSet instr_set : {smt_options.primary, smt_options.secondary}) {
+            if (get_kernel(instr_set) == nullptr) {
+                std::cerr << "Error: The CPU does not support " << get_instruction_set_name(instr_set) << " instructions" << std::endl;
+                return 1;
+            }
+        }
+        print_cpu_info();
+        
+        WorkerPool pool(get_benchmark_cpus());
+        report_unpinned_workers(pool);
+        std::vector<SmtRun> runs = run_smt_experiment(pool, smt_options);
+        if (runs.empty()) {
+            std::cerr << "Error: No physical core has two usable hyperthreads (SMT off, or siblings outside the CPU set)" << std::endl;
+            return 1;
+        }
+        print_smt_report(smt_options, runs);
+        
+        if (!output_path.empty()) {
+            std::ofstream output(output_path);
+            if (!output.is_open()) {
+                std::cerr << "Error: cannot write " << output_path << std::endl;
+                return 1;
+            }
+            write_smt_report(output, smt_options, runs);
+            std::cout << "\nResults written to " << output_path << std::endl;
+        }
+        return 0;
+    }
+    
+    if (overhead) {
+        std::vector<InstructionSet> instr_sets = all_instruction_sets();
+        std::vector<int> intervals;
+        try {
+            if (instr_given) {
+                instr_sets = string_to_instruction_set_list(instr_type);
+            }
+            intervals = parse_interval_list(overhead_rates);
+        } catch (const std::exception& e) {
+            std::cerr << "Error: " << e.what() << std::endl;
+            return 1;
+        }
+        print_cpu_info();
+        
+        print_observer_overhead(run_observer_overhead(instr_sets, intervals, options, core_id, cooldown_sec));
+        return 0;
+    }
+    
+    if (sweep) {
+        std::vector<InstructionSet> instr_sets = all_instruction_sets();
+        if (instr_given) {
+            try {
+                instr_sets = string_to_instruction_set_list(instr_type);
+            } catch (const std::exception& e) {
+                std::cerr << "Error: " << e.what() << std::endl;
+                return 1;
+            }
+        }
+        print_cpu_info();
+        
+        WorkerPool pool(get_benchmark_cpus());
+        report_unpinned_workers(pool);
+        print_sweep_table(run_active_core_sweep(pool, instr_sets, options, cooldown_sec));
+        return 0;
+    }
+    
+    if (!group_specs.empty()) {
+        std::vector<WorkloadGroup> groups;
+        std::set<int> used_cpus;
+        try {
+            for (const auto& spec : group_specs) {
+                groups.push_back(parse_workload_group(spec));
+                for (int cpu : groups.back().cpus) {
+                    if (std::find(usable.begin(), usable.end(), cpu) == usable.end()) {
+                        std::cerr << "Error: CPU " << cpu << " in group '" << spec << "' " << describe_unusable_cpu(cpu) << std::endl;
+                        return 1;
+                    }
+                    if (!used_cpus.insert(cpu).second) {
+                        std::cerr << "Error: CPU " << cpu << " appears in more than one group" << std::endl;
+                        return 1;
+                    }
+                }
+            }
+        } catch (const std::exception& e) {
+            std::cerr << "Error: " << e.what() << std::endl;
+            return 1;
+        }
+        print_cpu_info();
+        
+        WorkerPool pool(std::vector<int>(used_cpus.begin(), used_cpus.end()));
+        report_unpinned_workers(pool);
+        print_mixed_workload(run_mixed_workload(pool, groups, options, cooldown_sec));
+        return 0;
+    }
     
     // Convert instruction type string to enum
     InstructionSet instr_set;
@@ -235,6 +923,15 @@ int main(int argc, char** argv) {
         return 1;
     }
     
+    if ((!record_path.empty() || !chrome_trace_path.empty()) && (use_all_cores || use_all_cores_sequential || monitor_freq)) {
+        std::cerr << "Error: --record and --chrome-trace only apply to a single-core run" << std::endl;
+        return 1;
+    }
+    if ((!record_path.empty() || !chrome_trace_path.empty()) && get_kernel(instr_set) == nullptr) {
+        std::cerr << "Error: The CPU does not support " << get_instruction_set_name(instr_set) << " instructions" << std::endl;
+        return 1;
+    }
+    
     // Display system information based on the benchmark mode
     if (use_all_cores || use_all_cores_sequential) {
         // For all-cores modes, show all CPU info
@@ -245,15 +942,46 @@ int main(int argc, char** argv) {
     }
     
     // Run the benchmark based on the chosen options
-    if (use_all_cores) {
-        run_benchmark_on_all_cores(instr_set, duration_sec, monitor_freq);
-    } else if (use_all_cores_sequential) {
-        run_benchmark_on_all_cores_sequential(instr_set, duration_sec, monitor_freq);
+    if (use_all_cores || use_all_cores_sequential) {
+        // One long-lived pinned worker per core serves every run in this process
+        WorkerPool pool(get_benchmark_cpus());
+        report_unpinned_workers(pool);
+        
+        if (use_all_cores) {
+            run_benchmark_on_all_cores(pool, instr_set, options, monitor_freq, live ? refresh_ms : 0);
+        } else {
+            run_benchmark_on_all_cores_sequential(pool, instr_set, options, live ? refresh_ms : 0);
+        }
     } else if (monitor_freq) {
-        run_benchmark_with_frequency_monitoring(instr_set, duration_sec, core_id);
+        run_benchmark_with_frequency_monitoring(instr_set, options, core_id);
+    } else if (!record_path.empty() || !chrome_trace_path.empty()) {
+        RawTrace trace;
+        if (!record_path.empty()) {
+            options.raw_trace = &trace;
+        }
+        BenchmarkResult result = run_benchmark_with_result(instr_set, options, core_id);
+        // Nothing worth saving from a run that did not complete
+        if (!result.success) {
+            std::cerr << "Error: " << get_benchmark_failure_message(result, instr_set) << std::endl;
+            return 1;
+        }
+        print_benchmark_result(result, get_instruction_set_name(instr_set));
+        print_frequency_timeline(result);
+        if (!record_path.empty()) {
+            try {
+                save_raw_trace(record_path, trace);
+            } catch (const std::exception& e) {
+                std::cerr << "Error: " << e.what() << std::endl;
+                return 1;
+            }
+            std::cout << "\nRaw readings written to " << record_path << std::endl;
+        }
+        if (!write_trace_if_requested(chrome_trace_path, {{"", instr_set, &result}})) {
+            return 1;
+        }
     } else {
         // Run the benchmark on a single core
-        run_benchmark(instr_set, duration_sec, core_id);
+        run_benchmark(instr_set, options, core_id);
     }
     
     return 0;
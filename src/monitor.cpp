@@ -0,0 +1,393 @@
+#include "monitor.h"
+#include "chrome_trace.h"
+#include "cpu_utils.h"
+#include "topology.h"
+#include "stop_signal.h"
+#include "probe/sources.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <ctime>
+#include <fcntl.h>
+#include <iostream>
+#include <stdexcept>
+#include <unistd.h>
+
+namespace {
+
+const size_t kBufferBytes = 256 * 1024;
+const uint64_t kFlushIntervalNs = 1000000000ULL;
+
+// Chrome trace track groups: CPUs as in write_chrome_trace(), packages after them
+int cpu_pid(int cpu) {
+    return cpu + 1;
+}
+
+int package_pid(int package) {
+    return 1000000 + package;
+}
+
+int64_t realtime_ns() {
+    struct timespec ts;
+    clock_gettime(CLOCK_REALTIME, &ts);
+    return static_cast<int64_t>(ts.tv_sec) * 1000000000LL + ts.tv_nsec;
+}
+
+// Output file with its own write buffer and size/time based rotation
+class TraceWriter {
+public:
+    TraceWriter(const MonitorOptions& options, const std::vector<int>& cpus, const std::vector<int>& packages,
+                const std::string& base_path)
+        : options_(options), cpus_(cpus), packages_(packages), buffer_(kBufferBytes),
+          chrome_([this](const char* data, size_t length) { append(data, length); }) {
+        size_t dot = base_path.rfind('.');
+        size_t slash = base_path.rfind('/');
+        if (dot != std::string::npos && (slash == std::string::npos || dot > slash)) {
+            stem_ = base_path.substr(0, dot);
+            extension_ = base_path.substr(dot);
+        } else {
+            stem_ = base_path;
+        }
+    }
+
+    ~TraceWriter() { close_file(); }
+
+    bool open_next();
+    void append(const void* data, size_t length);
+    void end_record(uint64_t now_ns);
+    void close_file();
+
+    ChromeTraceWriter& chrome() { return chrome_; }
+    const std::string& path() const { return path_; }
+    int files_written() const { return index_; }
+
+private:
+    bool rotating() const { return options_.rotate_bytes > 0 || options_.rotate_sec > 0; }
+    void flush();
+    void write_all(const void* data, size_t length);
+    void write_preamble();
+
+    const MonitorOptions& options_;
+    const std::vector<int>& cpus_;
+    const std::vector<int>& packages_;
+    std::string stem_;
+    std::string extension_;
+    std::string path_;
+    int fd_ = -1;
+    int index_ = 0;
+
+    std::vector<char> buffer_;
+    size_t used_ = 0;
+    uint64_t file_bytes_ = 0;
+    uint64_t opened_ns_ = 0;
+    uint64_t last_flush_ns_ = 0;
+
+    ChromeTraceWriter chrome_;     // Formats into append(); only used for TraceFormat::CHROME
+};
+
+bool TraceWriter::open_next() {
+    close_file();
+
+    index_++;
+    if (rotating()) {
+        char suffix[16];
+        snprintf(suffix, sizeof(suffix), ".%04d", index_);
+        path_ = stem_ + suffix + extension_;
+    } else {
+        path_ = stem_ + extension_;
+    }
+
+    fd_ = ::open(path_.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (fd_ < 0) {
+        std::cerr << "Error: cannot write " << path_ << ": " << strerror(errno) << std::endl;
+        return false;
+    }
+    file_bytes_ = 0;
+    opened_ns_ = cfp::monotonic_ns();
+    last_flush_ns_ = opened_ns_;
+    write_preamble();
+    return true;
+}
+
+void TraceWriter::write_preamble() {
+    if (options_.format == TraceFormat::BINARY) {
+        TraceFileHeader header;
+        memset(&header, 0, sizeof(header));
+        memcpy(header.magic, "CIFTRACE", 8);
+        header.version = 1;
+        header.cpu_count = static_cast<uint32_t>(cpus_.size());
+        header.interval_ns = static_cast<uint64_t>(options_.interval_ms) * 1000000ULL;
+        header.start_realtime_ns = realtime_ns();
+        header.start_monotonic_ns = cfp::monotonic_ns();
+        append(&header, sizeof(header));
+        for (int cpu : cpus_) {
+            uint32_t id = static_cast<uint32_t>(cpu);
+            append(&id, sizeof(id));
+        }
+    } else if (options_.format == TraceFormat::CHROME) {
+        // Every file, including each rotated one, is a complete trace
+        chrome_.begin();
+        for (int cpu : cpus_) {
+            chrome_.process_name(cpu_pid(cpu), "CPU " + std::to_string(cpu));
+            chrome_.process_sort_index(cpu_pid(cpu), cpu);
+        }
+        for (int package : packages_) {
+            chrome_.process_name(package_pid(package), "Package " + std::to_string(package));
+            chrome_.process_sort_index(package_pid(package), -1000 + package);
+        }
+    } else {
+        char cell[32];
+        append("Timestamp", 9);
+        for (int cpu : cpus_) {
+            int n = snprintf(cell, sizeof(cell), ",CPU%d", cpu);
+            append(cell, n);
+        }
+        append(",Average\n", 9);
+    }
+}
+
+void TraceWriter::append(const void* data, size_t length) {
+    if (used_ + length > buffer_.size()) {
+        flush();
+    }
+    // A chunk larger than the whole buffer (a wide binary record) goes straight out
+    if (length > buffer_.size()) {
+        write_all(data, length);
+        file_bytes_ += length;
+        return;
+    }
+    memcpy(buffer_.data() + used_, data, length);
+    used_ += length;
+}
+
+void TraceWriter::end_record(uint64_t now_ns) {
+    if (now_ns - last_flush_ns_ >= kFlushIntervalNs) {
+        flush();
+    }
+
+    bool size_reached = options_.rotate_bytes > 0 && file_bytes_ + used_ >= options_.rotate_bytes;
+    bool time_reached = options_.rotate_sec > 0
+        && now_ns - opened_ns_ >= static_cast<uint64_t>(options_.rotate_sec) * 1000000000ULL;
+    if (size_reached || time_reached) {
+        open_next();
+    }
+}
+
+void TraceWriter::write_all(const void* data, size_t length) {
+    const char* bytes = static_cast<const char*>(data);
+    size_t written = 0;
+    while (fd_ >= 0 && written < length) {
+        ssize_t n = ::write(fd_, bytes + written, length - written);
+        if (n < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            std::cerr << "\nError: write to " << path_ << " failed: " << strerror(errno) << std::endl;
+            break;
+        }
+        written += n;
+    }
+}
+
+void TraceWriter::flush() {
+    write_all(buffer_.data(), used_);
+    file_bytes_ += used_;
+    used_ = 0;
+    last_flush_ns_ = cfp::monotonic_ns();
+}
+
+void TraceWriter::close_file() {
+    if (fd_ >= 0) {
+        if (options_.format == TraceFormat::CHROME) {
+            chrome_.end();
+        }
+        flush();
+        ::close(fd_);
+        fd_ = -1;
+    }
+}
+
+// "YYYY-mm-dd HH:MM:SS.mmm" in local time. The date part is only reformatted
+// when the second changes.
+class TimestampFormatter {
+public:
+    int format(int64_t realtime, char* out) {
+        time_t seconds = static_cast<time_t>(realtime / 1000000000LL);
+        if (seconds != cached_second_) {
+            struct tm local;
+            localtime_r(&seconds, &local);
+            strftime(cached_text_, sizeof(cached_text_), "%Y-%m-%d %H:%M:%S", &local);
+            cached_second_ = seconds;
+        }
+        int millis = static_cast<int>((realtime / 1000000LL) % 1000);
+        return sprintf(out, "%s.%03d", cached_text_, millis);
+    }
+
+private:
+    time_t cached_second_ = -1;
+    char cached_text_[32] = "";
+};
+
+std::string default_output_path(const std::vector<int>& cpus, TraceFormat format) {
+    char stamp[32];
+    time_t now = time(nullptr);
+    struct tm local;
+    localtime_r(&now, &local);
+    strftime(stamp, sizeof(stamp), "%Y%m%d_%H%M%S", &local);
+
+    std::string extension = format == TraceFormat::BINARY ? ".bin" : format == TraceFormat::CHROME ? ".json" : ".csv";
+    if (cpus.size() == 1) {
+        return "cpu" + std::to_string(cpus[0]) + "_frequency_" + stamp + extension;
+    }
+    return std::string("cpu_frequencies_") + stamp + extension;
+}
+
+} // namespace
+
+TraceFormat string_to_trace_format(const std::string& name) {
+    if (name == "csv") {
+        return TraceFormat::CSV;
+    } else if (name == "binary" || name == "bin") {
+        return TraceFormat::BINARY;
+    } else if (name == "chrome" || name == "perfetto") {
+        return TraceFormat::CHROME;
+    }
+    throw std::invalid_argument("unknown trace format '" + name + "' (expected csv, binary or chrome)");
+}
+
+int run_monitor(const MonitorOptions& options) {
+    if (options.interval_ms <= 0) {
+        std::cerr << "Error: monitor interval must be greater than 0" << std::endl;
+        return 1;
+    }
+
+    // Keep the fs root fixed while sources are open
+    cfp::FsRootUse root_use;
+
+    std::vector<int> cpus = options.cpus.empty() ? get_benchmark_cpus() : options.cpus;
+    if (cpus.empty()) {
+        std::cerr << "Error: no usable CPUs to monitor" << std::endl;
+        return 1;
+    }
+
+    std::vector<cfp::SysfsFreqFile> freq_files(cpus.size());
+    bool need_cpuinfo = false;
+    for (size_t i = 0; i < cpus.size(); i++) {
+        if (!freq_files[i].open(cpus[i])) {
+            need_cpuinfo = true;
+        }
+    }
+    cfp::CpuinfoFreqReader cpuinfo;
+    std::vector<uint32_t> cpuinfo_khz;
+    if (need_cpuinfo && !cpuinfo.open()) {
+        std::cerr << "Error: no frequency source available" << std::endl;
+        return 1;
+    }
+
+    // Package power is only part of the Chrome trace
+    std::vector<int> packages;
+    std::vector<cfp::RaplPackagePower> package_power;
+    if (options.format == TraceFormat::CHROME) {
+        for (const auto& place : get_cpu_topology(cpus)) {
+            if (std::find(packages.begin(), packages.end(), place.package_id) == packages.end()) {
+                cfp::RaplPackagePower power;
+                if (power.open(place.package_id)) {
+                    packages.push_back(place.package_id);
+                    package_power.push_back(std::move(power));
+                }
+            }
+        }
+    }
+
+    std::string base_path = options.output_path.empty()
+        ? default_output_path(cpus, options.format) : options.output_path;
+    TraceWriter writer(options, cpus, packages, base_path);
+    if (!writer.open_next()) {
+        return 1;
+    }
+
+    install_stop_handlers();
+    bool interactive = isatty(STDOUT_FILENO);
+
+    std::cout << "Recording " << cpus.size() << " CPU" << (cpus.size() == 1 ? "" : "s")
+              << " every " << options.interval_ms << " ms to " << writer.path() << std::endl;
+    std::cout << "Press Ctrl+C to stop recording" << std::endl;
+
+    std::vector<uint32_t> khz(cpus.size(), 0);
+    TimestampFormatter timestamps;
+    char row[64];
+    uint64_t ticks = 0;
+    uint64_t last_status_ns = 0;
+
+    cfp::TickSchedule schedule(static_cast<uint64_t>(options.interval_ms) * 1000000ULL);
+
+    while (!stop_requested()) {
+        uint64_t now_ns = cfp::monotonic_ns();
+        if (need_cpuinfo) {
+            cpuinfo.read_all_khz(cpuinfo_khz);
+        }
+
+        uint64_t sum_khz = 0;
+        for (size_t i = 0; i < cpus.size(); i++) {
+            khz[i] = 0;
+            if (freq_files[i].is_open()) {
+                freq_files[i].read_khz(khz[i]);
+            } else if (cpus[i] < static_cast<int>(cpuinfo_khz.size())) {
+                khz[i] = cpuinfo_khz[cpus[i]];
+            }
+            sum_khz += khz[i];
+        }
+        uint64_t avg_khz = cpus.empty() ? 0 : sum_khz / cpus.size();
+
+        if (options.format == TraceFormat::BINARY) {
+            writer.append(&now_ns, sizeof(now_ns));
+            writer.append(khz.data(), khz.size() * sizeof(uint32_t));
+        } else if (options.format == TraceFormat::CHROME) {
+            // Monotonic microseconds, the clock perf and the kernel tracers default to
+            double ts_us = now_ns / 1000.0;
+            for (size_t i = 0; i < cpus.size(); i++) {
+                writer.chrome().counter(cpu_pid(cpus[i]), "Frequency", ts_us, "MHz", khz[i] / 1000.0);
+            }
+            for (size_t i = 0; i < package_power.size(); i++) {
+                uint32_t milliwatts = 0;
+                if (package_power[i].read_power_mw(now_ns, milliwatts)) {
+                    writer.chrome().counter(package_pid(packages[i]), "Power", ts_us, "W", milliwatts / 1000.0);
+                }
+            }
+        } else {
+            writer.append(row, timestamps.format(realtime_ns(), row));
+            for (uint32_t value : khz) {
+                writer.append(row, sprintf(row, ",%u.%03u", value / 1000, value % 1000));
+            }
+            writer.append(row, sprintf(row, ",%llu.%03llu\n",
+                                       static_cast<unsigned long long>(avg_khz / 1000),
+                                       static_cast<unsigned long long>(avg_khz % 1000)));
+        }
+        writer.end_record(now_ns);
+        ticks++;
+
+        if (interactive && now_ns - last_status_ns >= 1000000000ULL) {
+            char stamp[32];
+            timestamps.format(realtime_ns(), stamp);
+            printf("\r%s - Avg: %.2f MHz", stamp, avg_khz / 1000.0);
+            fflush(stdout);
+            last_status_ns = now_ns;
+        }
+
+        schedule.wait();
+    }
+
+    writer.close_file();
+    std::cout << "\nStopping frequency monitoring" << std::endl;
+    std::cout << ticks << " samples saved to " << writer.path();
+    if (writer.files_written() > 1) {
+        std::cout << " (" << writer.files_written() << " files)";
+    }
+    std::cout << std::endl;
+    if (schedule.skipped() > 0) {
+        std::cout << schedule.skipped() << " ticks skipped because sampling fell behind" << std::endl;
+    }
+    return 0;
+}
@@ -0,0 +1,188 @@
+#include "numa_placement.h"
+#include "topology.h"
+#include "probe/sources.h"
+
+#include <dirent.h>
+#include <linux/mempolicy.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <climits>
+#include <cstring>
+#include <cstdio>
+#include <fstream>
+#include <stdexcept>
+
+MemoryPlacement string_to_memory_placement(const std::string& str) {
+    if (str == "local") {
+        return MemoryPlacement::LOCAL;
+    } else if (str == "remote") {
+        return MemoryPlacement::REMOTE;
+    }
+    throw std::invalid_argument("Unknown memory placement: " + str + " (expected local or remote)");
+}
+
+std::string get_memory_placement_name(MemoryPlacement placement) {
+    switch (placement) {
+        case MemoryPlacement::LOCAL:
+            return "local";
+        case MemoryPlacement::REMOTE:
+            return "remote";
+    }
+    return "unknown";
+}
+
+std::vector<int> get_numa_nodes() {
+    std::ifstream file(cfp::fs_path("/sys/devices/system/node/online"));
+    std::string line;
+    if (std::getline(file, line)) {
+        try {
+            std::vector<int> nodes = parse_cpu_list(line);
+            if (!nodes.empty()) {
+                return nodes;
+            }
+        } catch (const std::invalid_argument&) {
+        }
+    }
+    return {0};
+}
+
+int get_cpu_node(int cpu) {
+    int node = 0;
+    DIR* dir = opendir(cfp::fs_path("/sys/devices/system/cpu/cpu" + std::to_string(cpu)).c_str());
+    if (dir == nullptr) {
+        return node;
+    }
+    while (struct dirent* entry = readdir(dir)) {
+        char tail;
+        if (sscanf(entry->d_name, "node%d%c", &node, &tail) == 1) {
+            break;
+        }
+        node = 0;
+    }
+    closedir(dir);
+    return node;
+}
+
+// Row of the SLIT distance matrix for node, one entry per online node
+static std::vector<int> read_node_distances(int node) {
+    std::ifstream file(cfp::fs_path("/sys/devices/system/node/node" + std::to_string(node) + "/distance"));
+    std::vector<int> distances;
+    int distance;
+    while (file >> distance) {
+        distances.push_back(distance);
+    }
+    return distances;
+}
+
+int choose_memory_node(int cpu, MemoryPlacement placement) {
+    int local = get_cpu_node(cpu);
+    if (placement == MemoryPlacement::LOCAL) {
+        return local;
+    }
+
+    std::vector<int> nodes = get_numa_nodes();
+    std::vector<int> distances = read_node_distances(local);
+    int best = -1;
+    int best_distance = INT_MAX;
+    for (size_t i = 0; i < nodes.size(); i++) {
+        if (nodes[i] == local) {
+            continue;
+        }
+        // Without a distance row every remote node is equally far; take the first
+        int distance = i < distances.size() ? distances[i] : INT_MAX - 1;
+        if (distance < best_distance) {
+            best = nodes[i];
+            best_distance = distance;
+        }
+    }
+    return best;
+}
+
+bool bind_thread_memory(int node) {
+    if (node < 0) {
+        return syscall(SYS_set_mempolicy, MPOL_DEFAULT, nullptr, 0) == 0;
+    }
+
+    const size_t bits = sizeof(unsigned long) * CHAR_BIT;
+    std::vector<unsigned long> mask(node / bits + 1, 0);
+    mask[node / bits] |= 1UL << (node % bits);
+    // The kernel reads maxnode - 1 bits
+    return syscall(SYS_set_mempolicy, MPOL_BIND, mask.data(), mask.size() * bits + 1) == 0;
+}
+
+NodeBuffer::~NodeBuffer() {
+    release();
+}
+
+NodeBuffer::NodeBuffer(NodeBuffer&& other) noexcept : data_(other.data_), size_(other.size_) {
+    other.data_ = nullptr;
+    other.size_ = 0;
+}
+
+NodeBuffer& NodeBuffer::operator=(NodeBuffer&& other) noexcept {
+    if (this != &other) {
+        release();
+        data_ = other.data_;
+        size_ = other.size_;
+        other.data_ = nullptr;
+        other.size_ = 0;
+    }
+    return *this;
+}
+
+void NodeBuffer::release() {
+    if (data_ != nullptr) {
+        munmap(data_, size_);
+        data_ = nullptr;
+        size_ = 0;
+    }
+}
+
+bool NodeBuffer::allocate(size_t bytes, int node) {
+    release();
+    size_t page = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+    size_t size = (std::max<size_t>(bytes, 1) + page - 1) / page * page;
+    void* data = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (data == MAP_FAILED) {
+        return false;
+    }
+    data_ = data;
+    size_ = size;
+
+    // Bind before the first touch, so no page is ever faulted elsewhere
+    if (node >= 0) {
+        const size_t bits = sizeof(unsigned long) * CHAR_BIT;
+        std::vector<unsigned long> mask(node / bits + 1, 0);
+        mask[node / bits] |= 1UL << (node % bits);
+        syscall(SYS_mbind, data_, size_, MPOL_BIND, mask.data(), mask.size() * bits + 1,
+                MPOL_MF_MOVE | MPOL_MF_STRICT);
+    }
+    memset(data_, 0, size_);
+    return true;
+}
+
+std::map<int, size_t> NodeBuffer::page_nodes() const {
+    std::map<int, size_t> nodes;
+    if (data_ == nullptr) {
+        return nodes;
+    }
+    size_t page = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+    size_t count = size_ / page;
+    std::vector<void*> pages(count);
+    for (size_t i = 0; i < count; i++) {
+        pages[i] = static_cast<char*>(data_) + i * page;
+    }
+    // With a null node list, move_pages() only reports where each page is
+    std::vector<int> status(count, -1);
+    if (syscall(SYS_move_pages, 0, count, pages.data(), nullptr, status.data(), 0) != 0) {
+        nodes[-1] = count;
+        return nodes;
+    }
+    for (int node : status) {
+        nodes[node >= 0 ? node : -1]++;
+    }
+    return nodes;
+}
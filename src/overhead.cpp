@@ -0,0 +1,147 @@
+#include "overhead.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+#include <thread>
+
+std::vector<int> parse_interval_list(const std::string& list) {
+    std::vector<int> intervals;
+    std::stringstream stream(list);
+    std::string item;
+    while (std::getline(stream, item, ',')) {
+        char* end = nullptr;
+        long value = strtol(item.c_str(), &end, 10);
+        if (item.empty() || *end != '\0' || value <= 0) {
+            throw std::invalid_argument("invalid sampling interval '" + item + "' in '" + list + "'");
+        }
+        intervals.push_back(static_cast<int>(value));
+    }
+    if (intervals.empty()) {
+        throw std::invalid_argument("empty sampling interval list");
+    }
+    return intervals;
+}
+
+std::vector<OverheadPoint> run_observer_overhead(const std::vector<InstructionSet>& instr_sets,
+                                                 const std::vector<int>& intervals_ms,
+                                                 const BenchmarkOptions& options,
+                                                 int core_id,
+                                                 int cooldown_sec) {
+    std::vector<OverheadPoint> points;
+
+    for (InstructionSet instr_set : instr_sets) {
+        // 0 stands for the unobserved baseline
+        std::vector<int> runs = {0};
+        runs.insert(runs.end(), intervals_ms.begin(), intervals_ms.end());
+
+        for (int interval_ms : runs) {
+            BenchmarkOptions run_options = options;
+            run_options.adaptive = false;
+            run_options.sample_frequency = interval_ms > 0;
+            if (interval_ms > 0) {
+                run_options.sampling_interval_ms = interval_ms;
+            }
+
+            std::cout << "\nOverhead: " << get_instruction_set_name(instr_set) << ", "
+                      << (interval_ms > 0 ? "sampling every " + std::to_string(interval_ms) + " ms" : "unobserved")
+                      << std::endl;
+
+            OverheadPoint point;
+            point.instr_set = instr_set;
+            point.interval_ms = interval_ms;
+            point.result = run_benchmark_with_result(instr_set, run_options, core_id);
+            if (!point.result.success) {
+                std::cout << get_instruction_set_name(instr_set) << " is not supported, skipping" << std::endl;
+                break;
+            }
+            if (point.result.elapsed_sec > 0) {
+                point.throughput = point.result.total_iterations / point.result.elapsed_sec;
+            }
+            points.push_back(point);
+
+            if (cooldown_sec > 0) {
+                std::this_thread::sleep_for(std::chrono::seconds(cooldown_sec));
+            }
+        }
+    }
+
+    return points;
+}
+
+void print_observer_overhead(const std::vector<OverheadPoint>& points) {
+    std::cout << "\n========== Observer Overhead ==========\n" << std::endl;
+    printf("%-12s %8s %14s %9s %10s %8s %12s %8s %10s %8s\n",
+           "ISA", "Rate", "Iter/s", "dIter", "Avg MHz", "dMHz",
+           "Sampler CPU", "CPU %", "RQ wait", "Preempt");
+
+    for (size_t begin = 0; begin < points.size();) {
+        // Points of one ISA are contiguous: the unobserved run, then each rate
+        size_t end = begin;
+        while (end < points.size() && points[end].instr_set == points[begin].instr_set) {
+            end++;
+        }
+
+        const OverheadPoint* baseline = nullptr;
+        const OverheadPoint* reference = nullptr;   // Largest interval: the least perturbed frequency
+        for (size_t i = begin; i < end; i++) {
+            if (points[i].interval_ms == 0) {
+                baseline = &points[i];
+            } else if (reference == nullptr || points[i].interval_ms > reference->interval_ms) {
+                reference = &points[i];
+            }
+        }
+
+        for (size_t i = begin; i < end; i++) {
+            const OverheadPoint& point = points[i];
+            const BenchmarkResult& result = point.result;
+            std::string name = get_instruction_set_name(point.instr_set);
+
+            char rate[16];
+            if (point.interval_ms == 0) {
+                snprintf(rate, sizeof(rate), "off");
+            } else {
+                snprintf(rate, sizeof(rate), "%d ms", point.interval_ms);
+            }
+
+            char throughput_delta[16] = "-";
+            if (baseline != nullptr && baseline != &point && baseline->throughput > 0) {
+                snprintf(throughput_delta, sizeof(throughput_delta), "%+.2f%%",
+                         (point.throughput / baseline->throughput - 1.0) * 100.0);
+            }
+
+            if (!result.sampled) {
+                printf("%-12s %8s %14.4g %9s %10s %8s %12s %8s %10s %8ld\n",
+                       name.c_str(), rate, point.throughput, throughput_delta,
+                       "-", "-", "-", "-", "-", result.kernel_preemptions);
+                continue;
+            }
+
+            char freq_delta[16] = "-";
+            if (reference != nullptr && reference != &point) {
+                snprintf(freq_delta, sizeof(freq_delta), "%+.1f", result.avg_freq - reference->result.avg_freq);
+            }
+            char sampler_cpu[16];
+            snprintf(sampler_cpu, sizeof(sampler_cpu), "%.2f ms", result.sampler_cpu_sec * 1000.0);
+            char cpu_share[16];
+            snprintf(cpu_share, sizeof(cpu_share), "%.3f",
+                     result.elapsed_sec > 0 ? result.sampler_cpu_sec / result.elapsed_sec * 100.0 : 0.0);
+            char wait[16] = "n/a";
+            if (result.sampler_wait_sec >= 0) {
+                snprintf(wait, sizeof(wait), "%.2f ms", result.sampler_wait_sec * 1000.0);
+            }
+
+            printf("%-12s %8s %14.4g %9s %10.2f %8s %12s %8s %10s %8ld\n",
+                   name.c_str(), rate, point.throughput, throughput_delta,
+                   result.avg_freq, freq_delta, sampler_cpu, cpu_share, wait, result.kernel_preemptions);
+        }
+        begin = end;
+    }
+
+    std::cout << "\ndIter is relative to the unobserved run; dMHz is relative to the slowest sampling rate." << std::endl;
+    std::cout << "Sampler CPU and RQ wait are the monitor thread's own CPU time and runqueue wait;" << std::endl;
+    std::cout << "Preempt counts involuntary context switches of the benchmark thread." << std::endl;
+}
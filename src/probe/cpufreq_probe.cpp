@@ -0,0 +1,115 @@
+// C API of the cpufreq_probe library. Thin wrappers over cfp::Sampler; no
+// exception may escape through these functions.
+
+#include "cpufreq_probe.h"
+#include "probe/sampler.h"
+#include "probe/sources.h"
+
+#include <new>
+
+struct cfp_probe {
+    cfp::Sampler sampler;
+};
+
+extern "C" {
+
+void cfp_options_init(cfp_options* options) {
+    if (options == nullptr) {
+        return;
+    }
+    options->source = CFP_SOURCE_AUTO;
+    options->interval_us = 100000;
+    options->cpus = nullptr;
+    options->cpu_count = 0;
+    options->sampler_cpu = -1;
+}
+
+int cfp_open(const cfp_options* options, cfp_probe** out) {
+    if (options == nullptr || out == nullptr) {
+        return CFP_EINVAL;
+    }
+    *out = nullptr;
+
+    cfp_probe* probe = new (std::nothrow) cfp_probe;
+    if (probe == nullptr) {
+        return CFP_ENOMEM;
+    }
+
+    int rc;
+    try {
+        rc = probe->sampler.open(*options);
+    } catch (const std::bad_alloc&) {
+        rc = CFP_ENOMEM;
+    } catch (...) {
+        rc = CFP_ESYS;
+    }
+
+    if (rc != CFP_OK) {
+        delete probe;
+        return rc;
+    }
+    *out = probe;
+    return CFP_OK;
+}
+
+int cfp_start(cfp_probe* probe) {
+    if (probe == nullptr) {
+        return CFP_EINVAL;
+    }
+    return probe->sampler.start();
+}
+
+int cfp_stop(cfp_probe* probe) {
+    if (probe == nullptr) {
+        return CFP_EINVAL;
+    }
+    return probe->sampler.stop();
+}
+
+int cfp_read(const cfp_probe* probe, int cpu, cfp_sample* out) {
+    if (probe == nullptr || out == nullptr) {
+        return CFP_EINVAL;
+    }
+    return probe->sampler.read(cpu, *out);
+}
+
+void cfp_close(cfp_probe* probe) {
+    delete probe;  // ~Sampler stops the thread
+}
+
+int cfp_set_fs_root(const char* root) {
+    try {
+        if (!cfp::set_fs_root(root != nullptr ? root : "")) {
+            return CFP_ESTATE;
+        }
+    } catch (...) {
+        return CFP_ENOMEM;
+    }
+    return CFP_OK;
+}
+
+int cfp_pin_thread(int cpu) {
+    return cfp::pin_thread_to_cpu(cpu) ? CFP_OK : CFP_ESYS;
+}
+
+const char* cfp_strerror(int code) {
+    switch(code) {
+        case CFP_OK:
+            return "success";
+        case CFP_EINVAL:
+            return "invalid argument";
+        case CFP_ENOENT:
+            return "no usable frequency source";
+        case CFP_ESTATE:
+            return "invalid state for this call";
+        case CFP_ENOMEM:
+            return "out of memory";
+        case CFP_ESYS:
+            return "system call failed";
+        case CFP_ENODATA:
+            return "no sample yet";
+    }
+    return "unknown error";
+}
+
+} // extern "C"
@@ -0,0 +1,186 @@
+#include "probe/sampler.h"
+
+#include <algorithm>
+#include <chrono>
+
+namespace cfp {
+
+Sampler::~Sampler() {
+    stop();
+}
+
+int Sampler::open(const cfp_options& options) {
+    if (running_) {
+        return CFP_ESTATE;
+    }
+    if (options.interval_us == 0) {
+        return CFP_EINVAL;
+    }
+    if (options.source != CFP_SOURCE_AUTO && options.source != CFP_SOURCE_SYSFS &&
+        options.source != CFP_SOURCE_CPUINFO) {
+        return CFP_EINVAL;
+    }
+
+    source_ = options.source;
+    interval_us_ = options.interval_us;
+    sampler_cpu_ = options.sampler_cpu;
+
+    cpus_.clear();
+    if (options.cpus != nullptr) {
+        cpus_.assign(options.cpus, options.cpus + options.cpu_count);
+    } else {
+        cpus_ = online_cpus();
+    }
+    if (cpus_.empty()) {
+        return CFP_EINVAL;
+    }
+
+    int max_cpu = 0;
+    for (int cpu : cpus_) {
+        if (cpu < 0) {
+            return CFP_EINVAL;
+        }
+        max_cpu = std::max(max_cpu, cpu);
+    }
+    slot_of_cpu_.assign(max_cpu + 1, -1);
+    for (size_t i = 0; i < cpus_.size(); i++) {
+        if (slot_of_cpu_[cpus_[i]] >= 0) {
+            return CFP_EINVAL;  // Duplicate CPU
+        }
+        slot_of_cpu_[cpus_[i]] = static_cast<int>(i);
+    }
+
+    slots_.reset(new (std::nothrow) Slot[cpus_.size()]);
+    if (!slots_) {
+        return CFP_ENOMEM;
+    }
+
+    // Open one cached descriptor per CPU; fall back to cpuinfo where allowed
+    sysfs_files_.clear();
+    sysfs_files_.resize(cpus_.size());
+    need_cpuinfo_ = false;
+    for (size_t i = 0; i < cpus_.size(); i++) {
+        if (source_ != CFP_SOURCE_CPUINFO && sysfs_files_[i].open(cpus_[i])) {
+            continue;
+        }
+        if (source_ == CFP_SOURCE_SYSFS) {
+            return CFP_ENOENT;
+        }
+        need_cpuinfo_ = true;
+    }
+    if (need_cpuinfo_ && !cpuinfo_.open()) {
+        return CFP_ENOENT;
+    }
+    cpuinfo_khz_.assign(max_cpu + 1, 0);
+
+    return CFP_OK;
+}
+
+int Sampler::start() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (running_ || !slots_) {
+        return CFP_ESTATE;
+    }
+
+    stop_requested_ = false;
+    root_use_.emplace();
+    try {
+        thread_ = std::thread(&Sampler::run, this);
+    } catch (const std::exception&) {
+        root_use_.reset();
+        return CFP_ESYS;
+    }
+    running_ = true;
+    return CFP_OK;
+}
+
+int Sampler::stop() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (!running_) {
+            return CFP_ESTATE;
+        }
+        stop_requested_ = true;
+    }
+    cv_.notify_all();
+
+    thread_.join();
+    std::lock_guard<std::mutex> lock(mutex_);
+    running_ = false;
+    root_use_.reset();
+    return CFP_OK;
+}
+
+int Sampler::read(int cpu, cfp_sample& out) const {
+    if (cpu < 0 || cpu >= static_cast<int>(slot_of_cpu_.size()) || slot_of_cpu_[cpu] < 0) {
+        return CFP_EINVAL;
+    }
+    const Slot& slot = slots_[slot_of_cpu_[cpu]];
+
+    // Seqlock read: retry while the writer is mid-update or raced us
+    uint32_t before, after;
+    do {
+        before = slot.seq.load(std::memory_order_acquire);
+        out.timestamp_ns = slot.timestamp_ns.load(std::memory_order_relaxed);
+        out.freq_khz = slot.freq_khz.load(std::memory_order_relaxed);
+        out.sequence = slot.sequence.load(std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_acquire);
+        after = slot.seq.load(std::memory_order_relaxed);
+    } while ((before & 1) != 0 || before != after);
+
+    return out.sequence == 0 ? CFP_ENODATA : CFP_OK;
+}
+
+void Sampler::publish(size_t index, uint64_t timestamp_ns, uint32_t khz) {
+    Slot& slot = slots_[index];
+    uint32_t seq = slot.seq.load(std::memory_order_relaxed);
+
+    slot.seq.store(seq + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    slot.timestamp_ns.store(timestamp_ns, std::memory_order_relaxed);
+    slot.freq_khz.store(khz, std::memory_order_relaxed);
+    slot.sequence.store(slot.sequence.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    slot.seq.store(seq + 2, std::memory_order_release);
+}
+
+void Sampler::sample_once() {
+    if (need_cpuinfo_ && !cpuinfo_.read_all_khz(cpuinfo_khz_)) {
+        std::fill(cpuinfo_khz_.begin(), cpuinfo_khz_.end(), 0);
+    }
+
+    for (size_t i = 0; i < cpus_.size(); i++) {
+        uint32_t khz = 0;
+        if (sysfs_files_[i].is_open()) {
+            sysfs_files_[i].read_khz(khz);
+        } else if (cpus_[i] < static_cast<int>(cpuinfo_khz_.size())) {
+            khz = cpuinfo_khz_[cpus_[i]];
+        }
+        publish(i, monotonic_ns(), khz);
+    }
+}
+
+void Sampler::run() {
+    if (sampler_cpu_ >= 0) {
+        pin_thread_to_cpu(sampler_cpu_);
+    }
+
+    auto interval = std::chrono::microseconds(interval_us_);
+    auto next_tick = std::chrono::steady_clock::now();
+
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (!stop_requested_) {
+        lock.unlock();
+        sample_once();
+        lock.lock();
+
+        // Fixed-rate schedule; skip missed ticks instead of bursting
+        next_tick += interval;
+        auto now = std::chrono::steady_clock::now();
+        if (next_tick < now) {
+            next_tick = now;
+        }
+        cv_.wait_until(lock, next_tick, [this]() { return stop_requested_; });
+    }
+}
+
+} // namespace cfp
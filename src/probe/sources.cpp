@@ -0,0 +1,620 @@
+#include "probe/sources.h"
+
+#include <algorithm>
+#include <cctype>
+#include <cerrno>
+#include <cstdarg>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <mutex>
+#include <dirent.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <sched.h>
+#include <unistd.h>
+
+namespace cfp {
+
+// Read from any thread, so every access goes through the mutex
+static std::mutex g_fs_root_mutex;
+static std::string g_fs_root;
+static int g_fs_root_users = 0;
+
+bool set_fs_root(const std::string& root) {
+    std::string trimmed = root;
+    while (trimmed.size() > 1 && trimmed.back() == '/') {
+        trimmed.pop_back();
+    }
+    std::lock_guard<std::mutex> lock(g_fs_root_mutex);
+    if (g_fs_root_users > 0 && trimmed != g_fs_root) {
+        return false;
+    }
+    g_fs_root = trimmed;
+    return true;
+}
+
+std::string fs_root() {
+    std::lock_guard<std::mutex> lock(g_fs_root_mutex);
+    return g_fs_root;
+}
+
+std::string fs_path(const std::string& path) {
+    std::lock_guard<std::mutex> lock(g_fs_root_mutex);
+    return g_fs_root + path;
+}
+
+FsRootUse::FsRootUse() {
+    std::lock_guard<std::mutex> lock(g_fs_root_mutex);
+    g_fs_root_users++;
+}
+
+FsRootUse::~FsRootUse() {
+    std::lock_guard<std::mutex> lock(g_fs_root_mutex);
+    g_fs_root_users--;
+}
+
+// fs_path() of a printf-formatted absolute path
+static std::string format_path(const char* format, ...) __attribute__((format(printf, 1, 2)));
+static std::string format_path(const char* format, ...) {
+    char path[256];
+    va_list args;
+    va_start(args, format);
+    vsnprintf(path, sizeof(path), format, args);
+    va_end(args);
+    return fs_path(path);
+}
+
+uint64_t monotonic_ns() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return static_cast<uint64_t>(ts.tv_sec) * 1000000000ULL + ts.tv_nsec;
+}
+
+TickSchedule::TickSchedule(uint64_t interval_ns)
+    : interval_ns_(interval_ns > 0 ? interval_ns : 1), next_ns_(monotonic_ns()) {}
+
+uint64_t TickSchedule::wait() {
+    next_ns_ += interval_ns_;
+    uint64_t now = monotonic_ns();
+    uint64_t missed = 0;
+    if (next_ns_ <= now) {
+        // Stay on the original grid, just past the ticks that were missed
+        missed = (now - next_ns_) / interval_ns_ + 1;
+        next_ns_ += missed * interval_ns_;
+        skipped_ += missed;
+    }
+
+    struct timespec deadline;
+    deadline.tv_sec = static_cast<time_t>(next_ns_ / 1000000000ULL);
+    deadline.tv_nsec = static_cast<long>(next_ns_ % 1000000000ULL);
+    clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &deadline, nullptr);
+    return missed;
+}
+
+bool pin_thread_to_cpu(int cpu) {
+    if (cpu < 0) {
+        return false;
+    }
+
+    // Sized for the id rather than CPU_SETSIZE, so CPUs past 1023 can be pinned
+    cpu_set_t* cpuset = CPU_ALLOC(cpu + 1);
+    if (cpuset == nullptr) {
+        return false;
+    }
+    size_t size = CPU_ALLOC_SIZE(cpu + 1);
+    CPU_ZERO_S(size, cpuset);
+    CPU_SET_S(cpu, size, cpuset);
+    bool pinned = pthread_setaffinity_np(pthread_self(), size, cpuset) == 0;
+    CPU_FREE(cpuset);
+    return pinned;
+}
+
+std::vector<int> thread_affinity() {
+    // The kernel rejects masks smaller than its own CPU count with EINVAL, so
+    // grow the set until it fits
+    for (int count = CPU_SETSIZE; count <= (1 << 22); count *= 2) {
+        cpu_set_t* cpuset = CPU_ALLOC(count);
+        if (cpuset == nullptr) {
+            break;
+        }
+        size_t size = CPU_ALLOC_SIZE(count);
+        CPU_ZERO_S(size, cpuset);
+        if (sched_getaffinity(0, size, cpuset) == 0) {
+            std::vector<int> cpus;
+            for (int cpu = 0; cpu < count; cpu++) {
+                if (CPU_ISSET_S(cpu, size, cpuset)) {
+                    cpus.push_back(cpu);
+                }
+            }
+            CPU_FREE(cpuset);
+            return cpus;
+        }
+        int error = errno;
+        CPU_FREE(cpuset);
+        if (error != EINVAL) {
+            break;
+        }
+    }
+    return {};
+}
+
+// One CPU id of a CPU list: digits only, at most kMaxCpuId
+static bool parse_cpu_id(const char*& p, long& id) {
+    if (!isdigit(static_cast<unsigned char>(*p))) {
+        return false;
+    }
+    char* end = nullptr;
+    errno = 0;
+    id = strtol(p, &end, 10);
+    if (errno == ERANGE || id > kMaxCpuId) {
+        return false;
+    }
+    p = end;
+    return true;
+}
+
+bool parse_cpu_list(const std::string& text, std::vector<int>& cpus) {
+    cpus.clear();
+    std::vector<std::pair<long, long>> ranges;
+    const char* p = text.c_str();
+
+    while (true) {
+        while (*p == ' ' || *p == '\t' || *p == '\n') {
+            p++;
+        }
+        if (*p == '\0') {
+            break;
+        }
+        if (*p == ',') {
+            p++;
+            continue;
+        }
+
+        long first = 0;
+        if (!parse_cpu_id(p, first)) {
+            return false;
+        }
+        long last = first;
+        if (*p == '-') {
+            p++;
+            if (!parse_cpu_id(p, last) || last < first) {
+                return false;
+            }
+        }
+        ranges.emplace_back(first, last);
+
+        while (*p == ' ' || *p == '\t' || *p == '\n') {
+            p++;
+        }
+        if (*p != ',' && *p != '\0') {
+            return false;
+        }
+    }
+
+    // Expand merged ranges, so overlapping input never costs more than the
+    // id cap
+    std::sort(ranges.begin(), ranges.end());
+    long next = 0;
+    for (const auto& range : ranges) {
+        for (long cpu = std::max(range.first, next); cpu <= range.second; cpu++) {
+            cpus.push_back(static_cast<int>(cpu));
+        }
+        next = std::max(next, range.second + 1);
+    }
+    return true;
+}
+
+std::vector<int> online_cpus() {
+    std::vector<int> cpus;
+    char list[4096] = {};
+    if (FILE* file = fopen(fs_path("/sys/devices/system/cpu/online").c_str(), "r")) {
+        bool ok = fgets(list, sizeof(list), file) != nullptr && parse_cpu_list(list, cpus) && !cpus.empty();
+        fclose(file);
+        if (ok) {
+            return cpus;
+        }
+    }
+
+    // No online list: a synthetic tree describes its CPUs by directory, the
+    // live system by count
+    cpus.clear();
+    if (!fs_root().empty()) {
+        DIR* dir = opendir(fs_path("/sys/devices/system/cpu").c_str());
+        if (dir != nullptr) {
+            while (struct dirent* entry = readdir(dir)) {
+                int cpu;
+                char tail;
+                if (sscanf(entry->d_name, "cpu%d%c", &cpu, &tail) == 1) {
+                    cpus.push_back(cpu);
+                }
+            }
+            closedir(dir);
+        }
+        std::sort(cpus.begin(), cpus.end());
+    } else {
+        long count = sysconf(_SC_NPROCESSORS_ONLN);
+        for (long cpu = 0; cpu < count; cpu++) {
+            cpus.push_back(static_cast<int>(cpu));
+        }
+    }
+    if (cpus.empty()) {
+        cpus.push_back(0);
+    }
+    return cpus;
+}
+
+int online_cpu_count() {
+    return static_cast<int>(online_cpus().size());
+}
+
+// Point fd at a newly opened path, closing whatever it held before, so a
+// source can be opened again without leaking. -1 if the open fails.
+static bool reopen_fd(int& fd, const std::string& path) {
+    int opened = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd >= 0) {
+        close(fd);
+    }
+    fd = opened;
+    return fd >= 0;
+}
+
+// Read a whole small file through an open descriptor, starting at offset 0
+static bool read_from_start(int fd, std::string& buffer) {
+    buffer.clear();
+    char chunk[4096];
+    off_t offset = 0;
+
+    while (true) {
+        ssize_t n = pread(fd, chunk, sizeof(chunk), offset);
+        if (n < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return false;
+        }
+        if (n == 0) {
+            return true;
+        }
+        buffer.append(chunk, n);
+        offset += n;
+    }
+}
+
+// Walk "processor : N" / "cpu MHz : X" pairs and report each CPU's kHz
+template <typename Callback>
+static void parse_cpuinfo(const char* text, size_t length, Callback callback) {
+    const char* end = text + length;
+    int current_cpu = -1;
+
+    for (const char* line = text; line < end;) {
+        const char* eol = static_cast<const char*>(memchr(line, '\n', end - line));
+        if (eol == nullptr) {
+            eol = end;
+        }
+
+        const char* colon = static_cast<const char*>(memchr(line, ':', eol - line));
+        if (colon != nullptr) {
+            if (strncmp(line, "processor", 9) == 0) {
+                current_cpu = static_cast<int>(strtol(colon + 1, nullptr, 10));
+            } else if (current_cpu >= 0 && strncmp(line, "cpu MHz", 7) == 0) {
+                double mhz = strtod(colon + 1, nullptr);
+                callback(current_cpu, static_cast<uint32_t>(mhz * 1000.0 + 0.5));
+            }
+        }
+        line = eol + 1;
+    }
+}
+
+double read_cpuinfo_mhz(int cpu) {
+    CpuinfoFreqReader reader;
+    std::vector<uint32_t> khz_by_cpu;
+    if (!reader.open() || !reader.read_all_khz(khz_by_cpu)) {
+        return 0.0;
+    }
+    if (cpu < 0 || cpu >= static_cast<int>(khz_by_cpu.size())) {
+        return 0.0;
+    }
+    return khz_by_cpu[cpu] / 1000.0;
+}
+
+double read_sysfs_mhz(int cpu) {
+    SysfsFreqFile file;
+    uint32_t khz = 0;
+    if (!file.open(cpu) || !file.read_khz(khz)) {
+        return 0.0;
+    }
+    return khz / 1000.0;
+}
+
+SysfsFreqFile::~SysfsFreqFile() {
+    if (fd_ >= 0) {
+        close(fd_);
+    }
+}
+
+SysfsFreqFile::SysfsFreqFile(SysfsFreqFile&& other) noexcept : fd_(other.fd_) {
+    other.fd_ = -1;
+}
+
+SysfsFreqFile& SysfsFreqFile::operator=(SysfsFreqFile&& other) noexcept {
+    if (this != &other) {
+        if (fd_ >= 0) {
+            close(fd_);
+        }
+        fd_ = other.fd_;
+        other.fd_ = -1;
+    }
+    return *this;
+}
+
+bool SysfsFreqFile::open(int cpu) {
+    return reopen_fd(fd_, format_path("/sys/devices/system/cpu/cpu%d/cpufreq/scaling_cur_freq", cpu));
+}
+
+bool SysfsFreqFile::read_khz(uint32_t& khz) const {
+    char buffer[32];
+    ssize_t n = pread(fd_, buffer, sizeof(buffer) - 1, 0);
+    if (n <= 0) {
+        return false;
+    }
+    buffer[n] = '\0';
+
+    char* end = nullptr;
+    unsigned long value = strtoul(buffer, &end, 10);
+    if (end == buffer) {
+        return false;
+    }
+    khz = static_cast<uint32_t>(value);
+    return true;
+}
+
+CpuinfoFreqReader::~CpuinfoFreqReader() {
+    if (fd_ >= 0) {
+        close(fd_);
+    }
+}
+
+bool CpuinfoFreqReader::open() {
+    return reopen_fd(fd_, fs_path("/proc/cpuinfo"));
+}
+
+bool CpuinfoFreqReader::read_all_khz(std::vector<uint32_t>& khz_by_cpu) {
+    if (!read_from_start(fd_, buffer_)) {
+        return false;
+    }
+
+    std::fill(khz_by_cpu.begin(), khz_by_cpu.end(), 0);
+    parse_cpuinfo(buffer_.data(), buffer_.size(), [&khz_by_cpu](int cpu, uint32_t khz) {
+        if (cpu >= static_cast<int>(khz_by_cpu.size())) {
+            khz_by_cpu.resize(cpu + 1, 0);
+        }
+        khz_by_cpu[cpu] = khz;
+    });
+    return true;
+}
+
+// Read one unsigned integer through a cached descriptor
+static bool pread_u64(int fd, uint64_t& value) {
+    char buffer[32];
+    ssize_t n = pread(fd, buffer, sizeof(buffer) - 1, 0);
+    if (n <= 0) {
+        return false;
+    }
+    buffer[n] = '\0';
+    char* end = nullptr;
+    value = strtoull(buffer, &end, 10);
+    return end != buffer;
+}
+
+RaplPackagePower::~RaplPackagePower() {
+    if (fd_ >= 0) {
+        close(fd_);
+    }
+}
+
+RaplPackagePower::RaplPackagePower(RaplPackagePower&& other) noexcept
+    : fd_(other.fd_), max_energy_uj_(other.max_energy_uj_), last_energy_uj_(other.last_energy_uj_),
+      last_timestamp_ns_(other.last_timestamp_ns_), have_last_(other.have_last_) {
+    other.fd_ = -1;
+}
+
+bool RaplPackagePower::open(int package_id) {
+    max_energy_uj_ = 0;
+    have_last_ = false;
+
+    std::string path = format_path("/sys/class/powercap/intel-rapl:%d/max_energy_range_uj", package_id);
+    int range_fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (range_fd >= 0) {
+        pread_u64(range_fd, max_energy_uj_);
+        close(range_fd);
+    }
+
+    return reopen_fd(fd_, format_path("/sys/class/powercap/intel-rapl:%d/energy_uj", package_id));
+}
+
+bool RaplPackagePower::read_energy_uj(uint64_t& energy_uj) const {
+    return fd_ >= 0 && pread_u64(fd_, energy_uj);
+}
+
+bool rapl_energy_delta_uj(uint64_t previous_uj, uint64_t current_uj, uint64_t max_energy_uj, uint64_t& delta_uj) {
+    if (current_uj >= previous_uj) {
+        delta_uj = current_uj - previous_uj;
+        return true;
+    }
+    // Counter wrapped; only computable with a range that holds both readings
+    if (max_energy_uj == 0 || previous_uj > max_energy_uj) {
+        return false;
+    }
+    delta_uj = current_uj + (max_energy_uj - previous_uj);
+    return true;
+}
+
+bool RaplPackagePower::read_power_mw(uint64_t timestamp_ns, uint32_t& milliwatts) {
+    uint64_t energy_uj = 0;
+    if (fd_ < 0 || !pread_u64(fd_, energy_uj)) {
+        return false;
+    }
+
+    bool ok = false;
+    uint64_t delta_uj = 0;
+    if (have_last_ && timestamp_ns > last_timestamp_ns_ &&
+        rapl_energy_delta_uj(last_energy_uj_, energy_uj, max_energy_uj_, delta_uj)) {
+        double seconds = (timestamp_ns - last_timestamp_ns_) / 1e9;
+        // UINT32_MAX is the daemon's "unknown" marker, so saturate just below it
+        double power_mw = std::min(delta_uj / 1000.0 / seconds, static_cast<double>(UINT32_MAX - 1));
+        milliwatts = static_cast<uint32_t>(power_mw);
+        ok = true;
+    }
+
+    last_energy_uj_ = energy_uj;
+    last_timestamp_ns_ = timestamp_ns;
+    have_last_ = true;
+    return ok;
+}
+
+CoreTemperatures::~CoreTemperatures() {
+    for (const auto& sensor : sensors_) {
+        close(sensor.fd);
+    }
+}
+
+bool CoreTemperatures::open() {
+    for (const auto& sensor : sensors_) {
+        close(sensor.fd);
+    }
+    sensors_.clear();
+
+    DIR* hwmon = opendir(fs_path("/sys/class/hwmon").c_str());
+    if (hwmon == nullptr) {
+        return false;
+    }
+
+    std::string path;
+    while (struct dirent* entry = readdir(hwmon)) {
+        if (entry->d_name[0] == '.') {
+            continue;
+        }
+
+        // Only the coretemp driver, whose device is named coretemp.<package>
+        path = format_path("/sys/class/hwmon/%s/name", entry->d_name);
+        FILE* name_file = fopen(path.c_str(), "re");
+        if (name_file == nullptr) {
+            continue;
+        }
+        char name[64] = {0};
+        bool is_coretemp = fgets(name, sizeof(name), name_file) != nullptr && strncmp(name, "coretemp", 8) == 0;
+        fclose(name_file);
+        if (!is_coretemp) {
+            continue;
+        }
+
+        size_t first_sensor = sensors_.size();
+        for (int index = 1; index < 256; index++) {
+            path = format_path("/sys/class/hwmon/%s/temp%d_label", entry->d_name, index);
+            FILE* label_file = fopen(path.c_str(), "re");
+            if (label_file == nullptr) {
+                continue;
+            }
+            char label[64] = {0};
+            bool have_label = fgets(label, sizeof(label), label_file) != nullptr;
+            fclose(label_file);
+            if (!have_label) {
+                continue;
+            }
+
+            // "Package id P" or "Core C"; the core label does not name its
+            // package, so take it from the package sensor of the same device
+            Sensor sensor{-1, -1, -1};
+            int number = 0;
+            if (sscanf(label, "Package id %d", &number) == 1) {
+                sensor.package_id = number;
+            } else if (sscanf(label, "Core %d", &number) == 1) {
+                sensor.core_id = number;
+            } else {
+                continue;
+            }
+
+            path = format_path("/sys/class/hwmon/%s/temp%d_input", entry->d_name, index);
+            sensor.fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+            if (sensor.fd >= 0) {
+                sensors_.push_back(sensor);
+            }
+        }
+
+        // Assign this device's package id to its core sensors
+        int device_package = 0;
+        for (size_t i = first_sensor; i < sensors_.size(); i++) {
+            if (sensors_[i].core_id < 0) {
+                device_package = sensors_[i].package_id;
+            }
+        }
+        for (size_t i = first_sensor; i < sensors_.size(); i++) {
+            if (sensors_[i].package_id < 0) {
+                sensors_[i].package_id = device_package;
+            }
+        }
+    }
+    closedir(hwmon);
+
+    return !sensors_.empty();
+}
+
+bool CoreTemperatures::read_mdegc(int package_id, int core_id, int32_t& mdegc) const {
+    const Sensor* package_sensor = nullptr;
+    for (const auto& sensor : sensors_) {
+        if (sensor.package_id != package_id) {
+            continue;
+        }
+        if (sensor.core_id == core_id) {
+            uint64_t value = 0;
+            if (pread_u64(sensor.fd, value)) {
+                mdegc = static_cast<int32_t>(value);
+                return true;
+            }
+        } else if (sensor.core_id < 0) {
+            package_sensor = &sensor;
+        }
+    }
+
+    uint64_t value = 0;
+    if (package_sensor != nullptr && pread_u64(package_sensor->fd, value)) {
+        mdegc = static_cast<int32_t>(value);
+        return true;
+    }
+    return false;
+}
+
+ThermalThrottleCounters::~ThermalThrottleCounters() {
+    if (core_fd_ >= 0) {
+        close(core_fd_);
+    }
+    if (package_fd_ >= 0) {
+        close(package_fd_);
+    }
+}
+
+ThermalThrottleCounters::ThermalThrottleCounters(ThermalThrottleCounters&& other) noexcept
+    : core_fd_(other.core_fd_), package_fd_(other.package_fd_) {
+    other.core_fd_ = -1;
+    other.package_fd_ = -1;
+}
+
+bool ThermalThrottleCounters::open(int cpu) {
+    std::string path = format_path("/sys/devices/system/cpu/cpu%d/thermal_throttle/core_throttle_count", cpu);
+    bool have_core = reopen_fd(core_fd_, path);
+    path = format_path("/sys/devices/system/cpu/cpu%d/thermal_throttle/package_throttle_count", cpu);
+    bool have_package = reopen_fd(package_fd_, path);
+    return have_core || have_package;
+}
+
+bool ThermalThrottleCounters::read_core(uint64_t& count) const {
+    return core_fd_ >= 0 && pread_u64(core_fd_, count);
+}
+
+bool ThermalThrottleCounters::read_package(uint64_t& count) const {
+    return package_fd_ >= 0 && pread_u64(package_fd_, count);
+}
+
+} // namespace cfp
@@ -0,0 +1,416 @@
+#include "probe/tracepoints.h"
+#include "probe/sources.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <dirent.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/stat.h>
+#include <sys/vfs.h>
+#include <unistd.h>
+
+namespace cfp {
+
+namespace {
+
+const long kTracefsMagic = 0x74726163;
+const long kDebugfsMagic = 0x64626720;
+
+// Ring-buffer page commit flags (kernel/trace/ring_buffer.c)
+const uint64_t kMissedEvents = 1ULL << 31;
+const uint64_t kMissedStored = 1ULL << 30;
+
+// Compressed event header type_len values
+const uint32_t kTypePadding = 29;
+const uint32_t kTypeTimeExtend = 30;
+const uint32_t kTypeTimeStamp = 31;
+const uint32_t kTimeShift = 27;
+const uint64_t kTimeStampMsb = 0xf8ULL << 56;   // Absolute stamps only carry the low 59 bits
+
+bool read_text(const std::string& path, std::string& text) {
+    int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        return false;
+    }
+    text.clear();
+    char buffer[4096];
+    ssize_t n;
+    while ((n = ::read(fd, buffer, sizeof(buffer))) > 0) {
+        text.append(buffer, n);
+    }
+    ::close(fd);
+    return n == 0;
+}
+
+bool write_text(const std::string& path, const std::string& text) {
+    int fd = ::open(path.c_str(), O_WRONLY | O_TRUNC | O_CLOEXEC);
+    if (fd < 0) {
+        return false;
+    }
+    bool ok = ::write(fd, text.data(), text.size()) == static_cast<ssize_t>(text.size());
+    ::close(fd);
+    return ok;
+}
+
+std::string trim(const std::string& text) {
+    size_t begin = text.find_first_not_of(" \t\n");
+    size_t end = text.find_last_not_of(" \t\n");
+    return begin == std::string::npos ? std::string() : text.substr(begin, end - begin + 1);
+}
+
+// Find "field:<type> <name>;\toffset:N;\tsize:M;" in a format file
+bool find_field(const std::string& format, const std::string& name, size_t& offset, size_t& size) {
+    size_t line_start = 0;
+    while (line_start < format.size()) {
+        size_t line_end = format.find('\n', line_start);
+        if (line_end == std::string::npos) {
+            line_end = format.size();
+        }
+        std::string line = format.substr(line_start, line_end - line_start);
+        line_start = line_end + 1;
+
+        size_t semicolon = line.find(';');
+        if (line.find("field:") == std::string::npos || semicolon == std::string::npos) {
+            continue;
+        }
+        // The declaration ends with the name, possibly followed by [N]
+        std::string declaration = line.substr(0, semicolon);
+        size_t bracket = declaration.find('[');
+        if (bracket != std::string::npos) {
+            declaration.resize(bracket);
+        }
+        size_t name_start = declaration.find_last_of(" \t");
+        if (name_start == std::string::npos || declaration.substr(name_start + 1) != name) {
+            continue;
+        }
+
+        size_t offset_pos = line.find("offset:");
+        size_t size_pos = line.find("size:");
+        if (offset_pos == std::string::npos || size_pos == std::string::npos) {
+            return false;
+        }
+        offset = strtoul(line.c_str() + offset_pos + 7, nullptr, 10);
+        size = strtoul(line.c_str() + size_pos + 5, nullptr, 10);
+        return true;
+    }
+    return false;
+}
+
+uint32_t load_u32(const uint8_t* data) {
+    uint32_t value;
+    memcpy(&value, data, sizeof(value));
+    return value;
+}
+
+uint64_t load_uint(const uint8_t* data, size_t size) {
+    if (size == 4) {
+        return load_u32(data);
+    }
+    uint64_t value;
+    memcpy(&value, data, sizeof(value));
+    return value;
+}
+
+} // namespace
+
+TracepointSource::~TracepointSource() {
+    close();
+}
+
+bool TracepointSource::load_layout(const std::string& event, EventLayout& layout, std::string& error) const {
+    std::string format;
+    std::string path = root_ + "/events/power/" + event + "/format";
+    if (!read_text(path, format)) {
+        error = "cannot read " + path;
+        return false;
+    }
+
+    size_t id_pos = format.find("ID:");
+    size_t state_size = 0, cpu_size = 0;
+    size_t state_offset = 0, cpu_offset = 0;
+    if (id_pos == std::string::npos
+        || !find_field(format, "state", state_offset, state_size)
+        || !find_field(format, "cpu_id", cpu_offset, cpu_size)
+        || state_size != 4 || cpu_size != 4) {
+        error = "unexpected layout in " + path;
+        return false;
+    }
+    layout.id = atoi(format.c_str() + id_pos + 3);
+    layout.state_offset = static_cast<uint32_t>(state_offset);
+    layout.cpu_offset = static_cast<uint32_t>(cpu_offset);
+    return true;
+}
+
+bool TracepointSource::set_event_enabled(const std::string& event, bool enabled) const {
+    return write_text(root_ + "/events/power/" + event + "/enable", enabled ? "1" : "0");
+}
+
+bool TracepointSource::open(const TracepointOptions& options, const std::vector<int>& cpus, std::string& error) {
+    close();
+    idle_events_ = options.idle_events;
+
+    root_ = options.tracefs_root;
+    if (root_.empty()) {
+        struct stat st;
+        root_ = stat(fs_path("/sys/kernel/tracing/events/power").c_str(), &st) == 0
+            ? fs_path("/sys/kernel/tracing") : fs_path("/sys/kernel/debug/tracing");
+    }
+
+    struct statfs fs;
+    live_ = statfs(root_.c_str(), &fs) == 0
+        && (static_cast<long>(fs.f_type) == kTracefsMagic || static_cast<long>(fs.f_type) == kDebugfsMagic);
+
+    if (!load_layout("cpu_frequency", frequency_, error)) {
+        return false;
+    }
+    if (idle_events_ && !load_layout("cpu_idle", idle_, error)) {
+        return false;
+    }
+
+    // Page layout; the data field's end is the sub-buffer size
+    std::string header;
+    size_t offset = 0, size = 0;
+    if (read_text(root_ + "/events/header_page", header)) {
+        if (find_field(header, "commit", offset, size)) {
+            commit_offset_ = offset;
+            commit_size_ = size;
+        }
+        if (find_field(header, "data", offset, size)) {
+            data_offset_ = offset;
+            page_size_ = offset + size;
+        }
+    }
+    std::string subbuf_kb;
+    if (read_text(root_ + "/buffer_subbuf_size_kb", subbuf_kb) && atoi(subbuf_kb.c_str()) > 0) {
+        page_size_ = static_cast<size_t>(atoi(subbuf_kb.c_str())) * 1024;
+    }
+    page_.resize(page_size_);
+
+    // The selected clock is the one in brackets
+    std::string clocks;
+    if (read_text(root_ + "/trace_clock", clocks)) {
+        size_t open_bracket = clocks.find('[');
+        size_t close_bracket = clocks.find(']');
+        if (open_bracket != std::string::npos && close_bracket > open_bracket) {
+            clock_ = clocks.substr(open_bracket + 1, close_bracket - open_bracket - 1);
+        }
+    }
+
+    if (live_) {
+        // Timestamps in CLOCK_MONOTONIC line up with the rest of the tool.
+        // Switching clocks clears the buffers, so do it before opening them.
+        if (clock_ != "mono" && write_text(root_ + "/trace_clock", "mono")) {
+            saved_clock_ = clock_;
+            clock_ = "mono";
+        }
+        std::string enabled;
+        if (read_text(root_ + "/events/power/cpu_frequency/enable", enabled) && trim(enabled) == "0") {
+            if (!set_event_enabled("cpu_frequency", true)) {
+                error = "cannot enable power:cpu_frequency (" + std::string(strerror(errno)) + ")";
+                close();
+                return false;
+            }
+            enabled_frequency_ = true;
+        }
+        if (idle_events_ && read_text(root_ + "/events/power/cpu_idle/enable", enabled) && trim(enabled) == "0") {
+            enabled_idle_ = set_event_enabled("cpu_idle", true);
+        }
+        // buffer_percent stays as configured: waking the reader on every
+        // event would itself generate cpu_idle events
+    }
+
+    std::vector<int> selected = cpus;
+    if (selected.empty()) {
+        DIR* dir = opendir((root_ + "/per_cpu").c_str());
+        if (dir != nullptr) {
+            while (struct dirent* entry = readdir(dir)) {
+                int cpu;
+                if (sscanf(entry->d_name, "cpu%d", &cpu) == 1) {
+                    selected.push_back(cpu);
+                }
+            }
+            closedir(dir);
+        }
+    }
+    for (int cpu : selected) {
+        std::string path = root_ + "/per_cpu/cpu" + std::to_string(cpu) + "/trace_pipe_raw";
+        int fd = ::open(path.c_str(), O_RDONLY | O_NONBLOCK | O_CLOEXEC);
+        if (fd < 0) {
+            error = "cannot open " + path + " (" + strerror(errno) + ")";
+            close();
+            return false;
+        }
+        buffers_.push_back({cpu, fd, false});
+    }
+    if (buffers_.empty()) {
+        error = "no per-CPU buffers under " + root_ + "/per_cpu";
+        close();
+        return false;
+    }
+    return true;
+}
+
+void TracepointSource::close() {
+    for (const auto& buffer : buffers_) {
+        ::close(buffer.fd);
+    }
+    buffers_.clear();
+
+    if (enabled_frequency_) {
+        set_event_enabled("cpu_frequency", false);
+        enabled_frequency_ = false;
+    }
+    if (enabled_idle_) {
+        set_event_enabled("cpu_idle", false);
+        enabled_idle_ = false;
+    }
+    if (!saved_clock_.empty()) {
+        write_text(root_ + "/trace_clock", saved_clock_);
+        saved_clock_.clear();
+    }
+}
+
+bool TracepointSource::read(std::vector<TraceEvent>& out, int timeout_ms) {
+    if (live_ && timeout_ms != 0) {
+        std::vector<struct pollfd> fds;
+        fds.reserve(buffers_.size());
+        for (const auto& buffer : buffers_) {
+            fds.push_back({buffer.fd, POLLIN, 0});
+        }
+        if (poll(fds.data(), fds.size(), timeout_ms) < 0 && errno != EINTR) {
+            return false;
+        }
+    }
+
+    bool any_open = false;
+    for (auto& buffer : buffers_) {
+        while (!buffer.exhausted) {
+            ssize_t n = ::read(buffer.fd, page_.data(), page_.size());
+            if (n < 0) {
+                if (errno == EINTR) {
+                    continue;
+                }
+                if (errno != EAGAIN) {
+                    buffer.exhausted = true;
+                }
+                break;
+            }
+            if (n == 0) {
+                // Live buffers are empty for now; a replayed capture is done
+                if (!live_) {
+                    buffer.exhausted = true;
+                }
+                break;
+            }
+            decode_page(page_.data(), static_cast<size_t>(n), out);
+        }
+        any_open = any_open || !buffer.exhausted;
+    }
+    return any_open;
+}
+
+void TracepointSource::decode_page(const uint8_t* page, size_t length, std::vector<TraceEvent>& out) {
+    if (length < data_offset_) {
+        return;
+    }
+    uint64_t timestamp = load_uint(page, 8);
+    uint64_t commit = load_uint(page + commit_offset_, commit_size_);
+    size_t data_length = static_cast<size_t>(commit & ~(kMissedEvents | kMissedStored));
+    size_t end = std::min(length, data_offset_ + data_length);
+
+    if (commit & kMissedEvents) {
+        uint64_t missed = 1;
+        if ((commit & kMissedStored) && end + sizeof(long) <= length) {
+            missed = load_uint(page + end, sizeof(long));
+        }
+        lost_events_ += missed;
+    }
+
+    size_t pos = data_offset_;
+    while (pos + 4 <= end) {
+        uint32_t word = load_u32(page + pos);
+        uint32_t type_len = word & 0x1f;
+        uint64_t delta = word >> 5;
+        pos += 4;
+
+        if (type_len == kTypePadding) {
+            // Zero delta: the rest of the page is unused
+            if (delta == 0 || pos + 4 > end) {
+                break;
+            }
+            timestamp += delta;
+            pos += load_u32(page + pos);
+        } else if (type_len == kTypeTimeExtend) {
+            if (pos + 4 > end) {
+                break;
+            }
+            timestamp += (static_cast<uint64_t>(load_u32(page + pos)) << kTimeShift) + delta;
+            pos += 4;
+        } else if (type_len == kTypeTimeStamp) {
+            if (pos + 4 > end) {
+                break;
+            }
+            uint64_t absolute = (static_cast<uint64_t>(load_u32(page + pos)) << kTimeShift) + delta;
+            timestamp = absolute | (timestamp & kTimeStampMsb);
+            pos += 4;
+        } else {
+            size_t record_length;
+            if (type_len == 0) {
+                if (pos + 4 > end) {
+                    break;
+                }
+                uint32_t stored = load_u32(page + pos);
+                if (stored < 4) {
+                    break;
+                }
+                record_length = stored - 4;
+                pos += 4;
+            } else {
+                record_length = type_len * 4;
+            }
+            if (pos + record_length > end) {
+                break;
+            }
+            timestamp += delta;
+            decode_record(page + pos, record_length, timestamp, out);
+            pos += (record_length + 3) & ~static_cast<size_t>(3);
+        }
+    }
+}
+
+void TracepointSource::decode_record(const uint8_t* data, size_t length, uint64_t timestamp,
+                                     std::vector<TraceEvent>& out) const {
+    if (length < 2) {
+        return;
+    }
+    uint16_t type;
+    memcpy(&type, data, sizeof(type));
+
+    const EventLayout* layout = nullptr;
+    TraceEvent::Kind kind;
+    if (type == frequency_.id) {
+        layout = &frequency_;
+        kind = TraceEvent::FREQUENCY;
+    } else if (idle_events_ && type == idle_.id) {
+        layout = &idle_;
+        kind = TraceEvent::IDLE;
+    } else {
+        return;
+    }
+    if (layout->state_offset + 4 > length || layout->cpu_offset + 4 > length) {
+        return;
+    }
+
+    TraceEvent event;
+    event.timestamp_ns = timestamp;
+    event.cpu = load_u32(data + layout->cpu_offset);
+    event.value = load_u32(data + layout->state_offset);
+    event.kind = kind;
+    out.push_back(event);
+}
+
+} // namespace cfp
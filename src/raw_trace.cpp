@@ -0,0 +1,245 @@
+#include "raw_trace.h"
+#include "report.h"
+#include "probe/sources.h"
+
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+
+static const char* const kTraceMagic = "cpu_instr_freq-raw-trace";
+static const int kTraceVersion = 1;
+
+// Name accepted by string_to_instruction_set()
+static const char* instruction_set_token(InstructionSet instr_set) {
+    switch(instr_set) {
+        case InstructionSet::AVX128:
+            return "avx128";
+        case InstructionSet::AVX256:
+            return "avx256";
+        case InstructionSet::AVX512:
+            return "avx512";
+        case InstructionSet::AMX:
+            return "amx";
+        case InstructionSet::BASIC_ADD:
+            return "basic_add";
+    }
+    return "unknown";
+}
+
+void save_raw_trace(const std::string& path, const RawTrace& trace) {
+    FILE* file = fopen(path.c_str(), "w");
+    if (file == nullptr) {
+        throw std::runtime_error("cannot write " + path + ": " + strerror(errno));
+    }
+    setvbuf(file, nullptr, _IOFBF, 256 * 1024);
+
+    const BenchmarkOptions& options = trace.options;
+    const SteadyStateOptions& ss = options.steady_state;
+    fprintf(file, "%s %d\n", kTraceMagic, kTraceVersion);
+    fprintf(file, "instr %s\n", instruction_set_token(trace.instr_set));
+    fprintf(file, "core %d\n", trace.core_id);
+    fprintf(file, "duration_sec %d\n", options.duration_sec);
+    fprintf(file, "interval_ms %d\n", options.sampling_interval_ms);
+    fprintf(file, "source %s\n", get_frequency_source_name(options.source).c_str());
+    fprintf(file, "adaptive %d\n", options.adaptive ? 1 : 0);
+    fprintf(file, "steady_state %.17g %.17g %.17g %zu %.17g %.17g %zu\n",
+            ss.min_sec, ss.max_sec, ss.ci_target_mhz, ss.window, ss.stable_tolerance,
+            ss.throttle_drop, ss.throttle_samples);
+    fprintf(file, "tsc_hz %.17g\n", trace.tsc_hz);
+    fprintf(file, "batch_iterations %zu\n", trace.batch_iterations);
+    fprintf(file, "start_tsc %llu\n", trace.start_tsc);
+    fprintf(file, "deadline_tsc %llu\n", trace.deadline_tsc);
+    fprintf(file, "max_energy_uj %llu\n", static_cast<unsigned long long>(trace.max_energy_uj));
+
+    // Readings: f = frequency sample, e = energy counter, b = batch end TSC
+    for (const auto& reading : trace.frequencies) {
+        fprintf(file, "f %.9f %.17g\n", reading.time_sec, reading.mhz);
+    }
+    for (const auto& reading : trace.energy) {
+        fprintf(file, "e %.9f %llu\n", reading.time_sec, static_cast<unsigned long long>(reading.energy_uj));
+    }
+    for (unsigned long long tsc : trace.batch_end_tsc) {
+        fprintf(file, "b %llu\n", tsc);
+    }
+
+    bool ok = ferror(file) == 0;
+    ok = fclose(file) == 0 && ok;
+    if (!ok) {
+        throw std::runtime_error("error writing " + path);
+    }
+}
+
+RawTrace load_raw_trace(const std::string& path) {
+    std::ifstream file(path);
+    if (!file) {
+        throw std::runtime_error("cannot open raw trace " + path);
+    }
+
+    RawTrace trace;
+    std::string line;
+    int line_number = 0;
+    bool have_header = false;
+    while (std::getline(file, line)) {
+        line_number++;
+        if (line.empty()) {
+            continue;
+        }
+        std::istringstream fields(line);
+        std::string key;
+        fields >> key;
+
+        bool ok = true;
+        try {
+            if (!have_header) {
+                int version = 0;
+                if (key != kTraceMagic || !(fields >> version) || version != kTraceVersion) {
+                    throw std::invalid_argument("not a version " + std::to_string(kTraceVersion) + " raw trace");
+                }
+                have_header = true;
+            } else if (key == "f") {
+                RawFrequencyReading reading;
+                ok = static_cast<bool>(fields >> reading.time_sec >> reading.mhz);
+                trace.frequencies.push_back(reading);
+            } else if (key == "e") {
+                RawEnergyReading reading;
+                ok = static_cast<bool>(fields >> reading.time_sec >> reading.energy_uj);
+                trace.energy.push_back(reading);
+            } else if (key == "b") {
+                unsigned long long tsc = 0;
+                ok = static_cast<bool>(fields >> tsc);
+                trace.batch_end_tsc.push_back(tsc);
+            } else if (key == "instr") {
+                std::string name;
+                ok = static_cast<bool>(fields >> name);
+                trace.instr_set = string_to_instruction_set(name);
+            } else if (key == "core") {
+                ok = static_cast<bool>(fields >> trace.core_id);
+            } else if (key == "duration_sec") {
+                ok = static_cast<bool>(fields >> trace.options.duration_sec);
+            } else if (key == "interval_ms") {
+                ok = static_cast<bool>(fields >> trace.options.sampling_interval_ms);
+            } else if (key == "source") {
+                std::string name;
+                ok = static_cast<bool>(fields >> name);
+                trace.options.source = string_to_frequency_source(name);
+            } else if (key == "adaptive") {
+                int adaptive = 0;
+                ok = static_cast<bool>(fields >> adaptive);
+                trace.options.adaptive = adaptive != 0;
+            } else if (key == "steady_state") {
+                SteadyStateOptions& ss = trace.options.steady_state;
+                ok = static_cast<bool>(fields >> ss.min_sec >> ss.max_sec >> ss.ci_target_mhz >> ss.window
+                                              >> ss.stable_tolerance >> ss.throttle_drop >> ss.throttle_samples);
+            } else if (key == "tsc_hz") {
+                ok = static_cast<bool>(fields >> trace.tsc_hz);
+            } else if (key == "batch_iterations") {
+                ok = static_cast<bool>(fields >> trace.batch_iterations);
+            } else if (key == "start_tsc") {
+                ok = static_cast<bool>(fields >> trace.start_tsc);
+            } else if (key == "deadline_tsc") {
+                ok = static_cast<bool>(fields >> trace.deadline_tsc);
+            } else if (key == "max_energy_uj") {
+                unsigned long long range = 0;
+                ok = static_cast<bool>(fields >> range);
+                trace.max_energy_uj = range;
+            } else {
+                throw std::invalid_argument("unknown record '" + key + "'");
+            }
+        } catch (const std::exception& e) {
+            throw std::runtime_error(path + ":" + std::to_string(line_number) + ": " + e.what());
+        }
+        if (!ok) {
+            throw std::runtime_error(path + ":" + std::to_string(line_number) + ": malformed '" + key + "' record");
+        }
+    }
+
+    if (!have_header) {
+        throw std::runtime_error(path + ": empty raw trace");
+    }
+    if (trace.tsc_hz <= 0.0) {
+        throw std::runtime_error(path + ": missing tsc_hz");
+    }
+    return trace;
+}
+
+double average_package_power_w(const std::vector<RawEnergyReading>& energy, uint64_t max_energy_uj) {
+    if (energy.size() < 2) {
+        return -1.0;
+    }
+    // Intervals across a wrap of unknown range are left out, time included
+    double joules = 0.0, seconds = 0.0;
+    for (size_t i = 1; i < energy.size(); i++) {
+        uint64_t delta = 0;
+        if (cfp::rapl_energy_delta_uj(energy[i - 1].energy_uj, energy[i].energy_uj, max_energy_uj, delta)) {
+            joules += delta / 1e6;
+            seconds += energy[i].time_sec - energy[i - 1].time_sec;
+        }
+    }
+    return seconds > 0.0 ? joules / seconds : -1.0;
+}
+
+void package_power_series(const std::vector<RawEnergyReading>& energy, uint64_t max_energy_uj,
+                          std::vector<double>& times, std::vector<double>& watts) {
+    times.clear();
+    watts.clear();
+    for (size_t i = 1; i < energy.size(); i++) {
+        double seconds = energy[i].time_sec - energy[i - 1].time_sec;
+        uint64_t delta = 0;
+        if (seconds > 0.0 &&
+            cfp::rapl_energy_delta_uj(energy[i - 1].energy_uj, energy[i].energy_uj, max_energy_uj, delta)) {
+            times.push_back(energy[i].time_sec);
+            watts.push_back(delta / 1e6 / seconds);
+        }
+    }
+}
+
+BenchmarkResult replay_raw_trace(const RawTrace& trace) {
+    BenchmarkResult result;
+    result.core_id = trace.core_id;
+    result.success = false;
+    result.adaptive = trace.options.adaptive;
+    result.sampled = true;
+    result.batch_iterations = trace.batch_iterations;
+
+    // Run loop accounting, exactly as the live loop derives it
+    result.start_tsc = trace.start_tsc;
+    result.end_tsc = trace.batch_end_tsc.empty() ? trace.start_tsc : trace.batch_end_tsc.back();
+    result.total_iterations = static_cast<unsigned long long>(trace.batch_end_tsc.size()) * trace.batch_iterations;
+    result.elapsed_sec = (result.end_tsc - result.start_tsc) / trace.tsc_hz;
+    result.overrun_us = result.end_tsc > trace.deadline_tsc
+        ? (result.end_tsc - trace.deadline_tsc) / trace.tsc_hz * 1e6 : 0.0;
+    // An adaptive run that stopped before its deadline stopped on convergence
+    result.converged = trace.options.adaptive && result.end_tsc < trace.deadline_tsc;
+
+    // Feed the samples through the same detector a live run uses
+    SteadyStateDetector detector(trace.options.steady_state);
+    for (const auto& reading : trace.frequencies) {
+        result.frequencies.push_back(reading.mhz);
+        result.sample_times.push_back(reading.time_sec);
+        if (trace.options.adaptive) {
+            detector.add_sample(reading.time_sec, reading.mhz);
+        }
+    }
+
+    result.avg_package_power_w = average_package_power_w(trace.energy, trace.max_energy_uj);
+    package_power_series(trace.energy, trace.max_energy_uj, result.power_times, result.package_power_w);
+    finalize_benchmark_result(result, trace.options, detector);
+    return result;
+}
+
+void write_replay_report(std::ostream& out, const RawTrace& trace, const BenchmarkResult& result) {
+    JsonWriter json(out);
+
+    json.begin_object();
+    json.field("tool", "cpu_instr_freq");
+    json.field("mode", "replay");
+    json.key("options");
+    write_options_json(json, trace.options);
+    json.field("tsc_hz", trace.tsc_hz);
+    json.key("result");
+    write_benchmark_result_json(json, trace.instr_set, result);
+    json.end_object();
+}
@@ -0,0 +1,88 @@
+#include "report.h"
+#include "cpu_utils.h"
+
+void write_host_json(JsonWriter& json) {
+    const CpuFeatures& features = get_cpu_features();
+
+    json.begin_object();
+    json.field("model", get_cpu_model_name());
+    json.field("cpus", get_core_count());
+    json.key("features").begin_object();
+    json.field("sse2", features.sse2);
+    json.field("avx", features.avx);
+    json.field("avx2", features.avx2);
+    json.field("fma", features.fma);
+    json.field("avx512f", features.avx512f);
+    json.field("amx_tile", features.amx_tile);
+    json.end_object();
+    json.end_object();
+}
+
+void write_benchmark_result_json(JsonWriter& json, InstructionSet instr_set, const BenchmarkResult& result) {
+    json.begin_object();
+    json.field("cpu", result.core_id);
+    json.field("instr", get_instruction_set_name(instr_set));
+    json.field("success", result.success);
+    if (result.success) {
+        json.field("min_freq_mhz", result.min_freq);
+        json.field("max_freq_mhz", result.max_freq);
+        json.field("avg_freq_mhz", result.avg_freq);
+        json.field("elapsed_sec", result.elapsed_sec);
+        json.field("iterations", result.total_iterations);
+        json.field("batch_iterations", result.batch_iterations);
+        json.field("overrun_us", result.overrun_us);
+        if (result.avg_package_power_w >= 0.0) {
+            json.field("package_power_w", result.avg_package_power_w);
+        }
+        json.field("cpu_node", result.cpu_node);
+        if (result.memory_node >= 0) {
+            json.field("memory_node", result.memory_node);
+            json.field("memory_pages", result.memory_pages);
+            json.field("memory_pages_off_node", result.memory_pages_off_node);
+        }
+        if (result.adaptive) {
+            json.key("adaptive").begin_object();
+            json.field("converged", result.converged);
+            json.field("warmup_sec", result.warmup_sec);
+            json.field("steady_mean_mhz", result.steady_mean);
+            json.field("ci_half_width_mhz", result.ci_half_width);
+            json.field("throttle_events", result.throttle_events);
+            json.end_object();
+        }
+
+        // Samples as [seconds, MHz] pairs on one line each
+        json.key("samples").begin_array();
+        for (size_t i = 0; i < result.frequencies.size(); i++) {
+            json.begin_array(true).value(result.sample_times[i]).value(result.frequencies[i]).end_array();
+        }
+        json.end_array();
+    }
+    json.end_object();
+}
+
+void write_summary_json(JsonWriter& json, const ResultSummary& summary) {
+    json.begin_object();
+    json.field("cores", summary.cores);
+    json.field("succeeded", summary.succeeded);
+    json.field("avg_freq_mhz", summary.avg_freq);
+    json.field("min_core_freq_mhz", summary.min_core_freq);
+    json.field("throughput_per_sec", summary.throughput);
+    json.end_object();
+}
+
+void write_options_json(JsonWriter& json, const BenchmarkOptions& options) {
+    json.begin_object();
+    if (options.adaptive) {
+        json.field("mode", "adaptive");
+        json.field("min_time_sec", options.steady_state.min_sec);
+        json.field("max_time_sec", options.steady_state.max_sec);
+        json.field("ci_target_mhz", options.steady_state.ci_target_mhz);
+    } else {
+        json.field("mode", "fixed");
+        json.field("duration_sec", options.duration_sec);
+    }
+    json.field("source", get_frequency_source_name(options.source));
+    json.field("sampling_interval_ms", options.sampling_interval_ms);
+    json.field("memory", get_memory_placement_name(options.memory_placement));
+    json.end_object();
+}
@@ -0,0 +1,104 @@
+#include "scenario.h"
+#include "topology.h"
+
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+#include <thread>
+
+WorkloadGroup parse_workload_group(const std::string& spec) {
+    size_t colon = spec.find(':');
+    if (colon == std::string::npos || colon == 0 || colon + 1 == spec.size()) {
+        throw std::invalid_argument("Invalid workload group '" + spec + "', expected ISA:CPULIST");
+    }
+
+    WorkloadGroup group;
+    group.instr_set = string_to_instruction_set(spec.substr(0, colon));
+    group.cpus = parse_cpu_list(spec.substr(colon + 1));
+    return group;
+}
+
+// Build the assignments for a set of groups
+static std::vector<CoreAssignment> group_assignments(const std::vector<WorkloadGroup>& groups) {
+    std::vector<CoreAssignment> assignments;
+    for (const auto& group : groups) {
+        for (int cpu : group.cpus) {
+            assignments.push_back({cpu, group.instr_set});
+        }
+    }
+    return assignments;
+}
+
+static std::string group_label(const WorkloadGroup& group) {
+    std::stringstream label;
+    label << get_instruction_set_name(group.instr_set) << " x" << group.cpus.size();
+    return label.str();
+}
+
+std::vector<GroupOutcome> run_mixed_workload(WorkerPool& pool,
+                                             const std::vector<WorkloadGroup>& groups,
+                                             const BenchmarkOptions& options,
+                                             int cooldown_sec) {
+    std::vector<GroupOutcome> outcomes;
+    auto cooldown = [cooldown_sec]() {
+        if (cooldown_sec > 0) {
+            std::this_thread::sleep_for(std::chrono::seconds(cooldown_sec));
+        }
+    };
+
+    // Baselines: each group alone
+    for (const auto& group : groups) {
+        std::cout << "\nBaseline: " << group_label(group) << " alone" << std::endl;
+        GroupOutcome outcome;
+        outcome.group = group;
+        outcome.alone = summarize_results(run_synchronized(pool, group_assignments({group}), options));
+        outcomes.push_back(outcome);
+        cooldown();
+    }
+
+    // All groups together. Results come back in assignment order, so slice
+    // them per group.
+    std::cout << "\nMixed: all groups at once" << std::endl;
+    std::vector<BenchmarkResult> results = run_synchronized(pool, group_assignments(groups), options);
+    print_start_alignment(results);
+
+    size_t offset = 0;
+    for (auto& outcome : outcomes) {
+        size_t count = outcome.group.cpus.size();
+        std::vector<BenchmarkResult> slice(results.begin() + offset, results.begin() + offset + count);
+        outcome.mixed = summarize_results(slice);
+        offset += count;
+    }
+
+    return outcomes;
+}
+
+void print_mixed_workload(const std::vector<GroupOutcome>& outcomes) {
+    auto percent_change = [](double mixed, double alone) {
+        return alone > 0.0 ? (mixed - alone) / alone * 100.0 : 0.0;
+    };
+
+    std::cout << "\n========== Mixed Workload Results ==========\n" << std::endl;
+    std::cout << "Group            | Alone Freq (MHz) | Mixed Freq (MHz) |  Delta  | Alone (M it/s) | Mixed (M it/s) |  Delta" << std::endl;
+    std::cout << "-----------------|------------------|------------------|---------|----------------|----------------|--------" << std::endl;
+
+    for (const auto& outcome : outcomes) {
+        std::cout << std::left << std::setw(16) << group_label(outcome.group) << std::right << " | ";
+        if (!outcome.alone.all_succeeded() || !outcome.mixed.all_succeeded()) {
+            std::cout << std::setw(16) << "N/A" << " | " << std::setw(16) << "N/A" << " |     N/A | "
+                      << std::setw(14) << "N/A" << " | " << std::setw(14) << "N/A" << " |    N/A" << std::endl;
+            continue;
+        }
+        std::cout << std::fixed << std::setprecision(2)
+                  << std::setw(16) << outcome.alone.avg_freq << " | "
+                  << std::setw(16) << outcome.mixed.avg_freq << " | "
+                  << std::setprecision(1) << std::setw(6) << percent_change(outcome.mixed.avg_freq, outcome.alone.avg_freq) << "% | "
+                  << std::setprecision(2)
+                  << std::setw(14) << outcome.alone.throughput / 1e6 << " | "
+                  << std::setw(14) << outcome.mixed.throughput / 1e6 << " | "
+                  << std::setprecision(1) << std::setw(5) << percent_change(outcome.mixed.throughput, outcome.alone.throughput) << "%"
+                  << std::endl;
+    }
+}
@@ -0,0 +1,265 @@
+#include "scenario_file.h"
+#include "json_writer.h"
+#include "report.h"
+
+#include <algorithm>
+#include <cctype>
+#include <cerrno>
+#include <chrono>
+#include <climits>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <set>
+#include <sstream>
+#include <stdexcept>
+#include <thread>
+
+// Trim leading and trailing whitespace
+static std::string trim(const std::string& s) {
+    size_t first = s.find_first_not_of(" \t\r\n");
+    if (first == std::string::npos) {
+        return "";
+    }
+    size_t last = s.find_last_not_of(" \t\r\n");
+    return s.substr(first, last - first + 1);
+}
+
+static double parse_number(const std::string& value) {
+    char* end = nullptr;
+    double number = std::strtod(value.c_str(), &end);
+    if (value.empty() || *end != '\0' || number < 0) {
+        throw std::invalid_argument("expected a non-negative number, got '" + value + "'");
+    }
+    return number;
+}
+
+// Whole seconds and milliseconds. Durations are later multiplied into
+// milliseconds as int, which bounds the largest accepted value.
+static int parse_integer(const std::string& key, const std::string& value) {
+    const long max_value = INT_MAX / 1000;
+    char* end = nullptr;
+    errno = 0;
+    long number = std::strtol(value.c_str(), &end, 10);
+    if (value.empty() || *end != '\0' || errno == ERANGE || number < 0 || number > max_value) {
+        throw std::invalid_argument(key + " must be a whole number from 0 to " + std::to_string(max_value) +
+                                    ", got '" + value + "'");
+    }
+    return static_cast<int>(number);
+}
+
+// Apply one "key = value" line to a phase
+static void apply_setting(ScenarioPhase& phase, const std::string& key, const std::string& value) {
+    if (key == "group") {
+        phase.groups.push_back(parse_workload_group(value));
+    } else if (key == "duration") {
+        if (value == "adaptive") {
+            phase.options.adaptive = true;
+        } else {
+            phase.options.adaptive = false;
+            phase.options.duration_sec = parse_integer(key, value);
+        }
+    } else if (key == "min_time") {
+        phase.options.steady_state.min_sec = parse_number(value);
+    } else if (key == "max_time") {
+        phase.options.steady_state.max_sec = parse_number(value);
+    } else if (key == "ci") {
+        phase.options.steady_state.ci_target_mhz = parse_number(value);
+    } else if (key == "source") {
+        phase.options.source = string_to_frequency_source(value);
+    } else if (key == "rate_ms") {
+        phase.options.sampling_interval_ms = parse_integer(key, value);
+    } else if (key == "cooldown") {
+        phase.cooldown_sec = parse_integer(key, value);
+    } else {
+        throw std::invalid_argument("unknown key '" + key + "'");
+    }
+}
+
+// Reject phases that cannot run
+static void validate_phase(const ScenarioPhase& phase) {
+    if (phase.groups.empty()) {
+        throw std::invalid_argument("phase '" + phase.name + "' has no group");
+    }
+    std::set<int> used;
+    for (const auto& group : phase.groups) {
+        for (int cpu : group.cpus) {
+            if (!used.insert(cpu).second) {
+                throw std::invalid_argument("phase '" + phase.name + "' uses CPU " + std::to_string(cpu) + " twice");
+            }
+        }
+    }
+    if (phase.options.sampling_interval_ms <= 0) {
+        throw std::invalid_argument("phase '" + phase.name + "' needs rate_ms > 0");
+    }
+    if (phase.options.adaptive) {
+        const auto& ss = phase.options.steady_state;
+        if (ss.min_sec <= 0 || ss.max_sec < ss.min_sec || ss.ci_target_mhz <= 0) {
+            throw std::invalid_argument("phase '" + phase.name + "' needs 0 < min_time <= max_time and ci > 0");
+        }
+    } else if (phase.options.duration_sec <= 0) {
+        throw std::invalid_argument("phase '" + phase.name + "' needs duration > 0");
+    }
+}
+
+Scenario load_scenario_file(const std::string& path) {
+    std::ifstream file(path);
+    if (!file.is_open()) {
+        throw std::runtime_error("Cannot open scenario file " + path);
+    }
+
+    Scenario scenario;
+    scenario.path = path;
+
+    ScenarioPhase defaults;
+    ScenarioPhase* current = &defaults;
+    std::string line;
+    int line_number = 0;
+
+    try {
+        while (std::getline(file, line)) {
+            line_number++;
+            line = trim(line.substr(0, line.find('#')));
+            if (line.empty()) {
+                continue;
+            }
+
+            if (line.front() == '[') {
+                if (line.back() != ']') {
+                    throw std::invalid_argument("unterminated section header");
+                }
+                std::string section = trim(line.substr(1, line.size() - 2));
+                if (section == "defaults") {
+                    if (!scenario.phases.empty()) {
+                        throw std::invalid_argument("[defaults] must come before the first phase");
+                    }
+                    current = &defaults;
+                } else if (section == "phase" ||
+                           (section.compare(0, 5, "phase") == 0 && std::isspace(static_cast<unsigned char>(section[5])))) {
+                    ScenarioPhase phase = defaults;
+                    phase.name = trim(section.substr(5));
+                    if (phase.name.empty()) {
+                        phase.name = "phase" + std::to_string(scenario.phases.size() + 1);
+                    }
+                    scenario.phases.push_back(phase);
+                    current = &scenario.phases.back();
+                } else {
+                    throw std::invalid_argument("unknown section '" + section + "'");
+                }
+                continue;
+            }
+
+            size_t equals = line.find('=');
+            if (equals == std::string::npos) {
+                throw std::invalid_argument("expected key = value");
+            }
+            apply_setting(*current, trim(line.substr(0, equals)), trim(line.substr(equals + 1)));
+        }
+
+        if (scenario.phases.empty()) {
+            throw std::invalid_argument("no [phase] sections");
+        }
+        line_number = 0;
+        for (const auto& phase : scenario.phases) {
+            validate_phase(phase);
+        }
+    } catch (const std::exception& e) {
+        std::string where = line_number > 0 ? path + ":" + std::to_string(line_number) : path;
+        throw std::runtime_error(where + ": " + e.what());
+    }
+
+    return scenario;
+}
+
+std::vector<int> scenario_cpus(const Scenario& scenario) {
+    std::set<int> cpus;
+    for (const auto& phase : scenario.phases) {
+        for (const auto& group : phase.groups) {
+            cpus.insert(group.cpus.begin(), group.cpus.end());
+        }
+    }
+    return std::vector<int>(cpus.begin(), cpus.end());
+}
+
+std::vector<PhaseResult> run_scenario(WorkerPool& pool, const Scenario& scenario) {
+    std::vector<PhaseResult> phase_results;
+
+    for (size_t i = 0; i < scenario.phases.size(); i++) {
+        const ScenarioPhase& phase = scenario.phases[i];
+        std::cout << "\nPhase " << (i + 1) << "/" << scenario.phases.size() << ": " << phase.name << std::endl;
+
+        PhaseResult phase_result;
+        for (const auto& group : phase.groups) {
+            for (int cpu : group.cpus) {
+                phase_result.assignments.push_back({cpu, group.instr_set});
+            }
+        }
+        phase_result.results = run_synchronized(pool, phase_result.assignments, phase.options);
+        print_start_alignment(phase_result.results);
+        phase_results.push_back(std::move(phase_result));
+
+        // No point idling after the last phase
+        if (phase.cooldown_sec > 0 && i + 1 < scenario.phases.size()) {
+            std::cout << "Cooling down for " << phase.cooldown_sec << " s" << std::endl;
+            std::this_thread::sleep_for(std::chrono::seconds(phase.cooldown_sec));
+        }
+    }
+
+    return phase_results;
+}
+
+void write_scenario_report(std::ostream& out, const Scenario& scenario, const std::vector<PhaseResult>& phase_results) {
+    JsonWriter json(out);
+
+    json.begin_object();
+    json.field("tool", "cpu_instr_freq");
+    json.field("scenario", scenario.path);
+    json.key("host");
+    write_host_json(json);
+
+    json.key("phases").begin_array();
+    for (size_t i = 0; i < phase_results.size(); i++) {
+        const ScenarioPhase& phase = scenario.phases[i];
+        const PhaseResult& phase_result = phase_results[i];
+        StartAlignment alignment = compute_start_alignment(phase_result.results);
+
+        json.begin_object();
+        json.field("name", phase.name);
+        json.key("options");
+        write_options_json(json, phase.options);
+        json.field("cooldown_sec", phase.cooldown_sec);
+        json.field("start_skew_us", alignment.skew_us);
+        json.field("overlap_sec", alignment.overlap_sec);
+
+        // Per-group aggregates; results are in assignment order, grouped
+        json.key("groups").begin_array();
+        size_t offset = 0;
+        for (const auto& group : phase.groups) {
+            std::vector<BenchmarkResult> slice(phase_result.results.begin() + offset,
+                                               phase_result.results.begin() + offset + group.cpus.size());
+            offset += group.cpus.size();
+
+            json.begin_object();
+            json.field("instr", get_instruction_set_name(group.instr_set));
+            json.key("cpus").begin_array(true);
+            for (int cpu : group.cpus) {
+                json.value(cpu);
+            }
+            json.end_array();
+            json.key("summary");
+            write_summary_json(json, summarize_results(slice));
+            json.end_object();
+        }
+        json.end_array();
+
+        json.key("cores").begin_array();
+        for (size_t j = 0; j < phase_result.results.size(); j++) {
+            write_benchmark_result_json(json, phase_result.assignments[j].instr_set, phase_result.results[j]);
+        }
+        json.end_array();
+
+        json.end_object();
+    }
+    json.end_array();
+    json.end_object();
+}
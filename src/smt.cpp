@@ -0,0 +1,299 @@
+#include "smt.h"
+#include "json_writer.h"
+#include "report.h"
+#include "topology.h"
+
+#include <chrono>
+#include <cstdio>
+#include <iostream>
+#include <map>
+#include <sstream>
+#include <stdexcept>
+#include <thread>
+
+std::vector<SmtPolicy> parse_smt_policy_list(const std::string& list) {
+    std::vector<SmtPolicy> policies;
+    std::stringstream ss(list);
+    std::string item;
+    while (std::getline(ss, item, ',')) {
+        SmtPolicy policy;
+        if (item == "one-per-core") {
+            policy = SmtPolicy::ONE_PER_CORE;
+        } else if (item == "same") {
+            policy = SmtPolicy::SAME_KERNEL;
+        } else if (item == "mixed") {
+            policy = SmtPolicy::MIXED_KERNELS;
+        } else {
+            throw std::invalid_argument("Unknown SMT policy: " + item + " (expected one-per-core, same or mixed)");
+        }
+        policies.push_back(policy);
+    }
+    if (policies.empty()) {
+        throw std::invalid_argument("Empty SMT policy list");
+    }
+    return policies;
+}
+
+std::string get_smt_policy_name(SmtPolicy policy) {
+    switch(policy) {
+        case SmtPolicy::ONE_PER_CORE:
+            return "one-per-core";
+        case SmtPolicy::SAME_KERNEL:
+            return "same";
+        case SmtPolicy::MIXED_KERNELS:
+            return "mixed";
+    }
+    return "unknown";
+}
+
+std::vector<std::vector<CpuTopology>> find_smt_cores(const WorkerPool& pool) {
+    // Topology lists siblings in smt_index order within each physical core
+    std::map<std::pair<int, int>, std::vector<CpuTopology>> by_core;
+    for (const auto& cpu : get_cpu_topology(pool.cpus())) {
+        by_core[{cpu.package_id, cpu.core_id}].push_back(cpu);
+    }
+
+    std::vector<std::vector<CpuTopology>> cores;
+    for (const auto& [key, cpus] : by_core) {
+        if (cpus.size() >= 2) {
+            cores.push_back(cpus);
+        }
+    }
+    return cores;
+}
+
+std::vector<SmtRun> run_smt_experiment(WorkerPool& pool, const SmtOptions& smt) {
+    std::vector<std::vector<CpuTopology>> smt_cores = find_smt_cores(pool);
+    std::vector<SmtRun> runs;
+    if (smt_cores.empty()) {
+        return runs;
+    }
+
+    for (size_t p = 0; p < smt.policies.size(); p++) {
+        SmtRun run;
+        run.policy = smt.policies[p];
+
+        std::vector<CoreAssignment> assignments;
+        for (const auto& siblings : smt_cores) {
+            SmtCore core;
+            core.package_id = siblings[0].package_id;
+            core.core_id = siblings[0].core_id;
+            core.threads.push_back({siblings[0].cpu, smt.primary});
+            for (size_t t = 1; t < siblings.size(); t++) {
+                if (run.policy == SmtPolicy::SAME_KERNEL) {
+                    core.threads.push_back({siblings[t].cpu, smt.primary});
+                } else if (run.policy == SmtPolicy::MIXED_KERNELS) {
+                    core.threads.push_back({siblings[t].cpu, smt.secondary});
+                }
+            }
+            assignments.insert(assignments.end(), core.threads.begin(), core.threads.end());
+            run.cores.push_back(core);
+        }
+
+        std::cout << "\nSMT: " << get_smt_policy_name(run.policy) << " on " << smt_cores.size()
+                  << " core(s), " << assignments.size() << " thread(s)" << std::endl;
+        std::vector<BenchmarkResult> results = run_synchronized(pool, assignments, smt.options);
+        print_start_alignment(results);
+
+        // Hand the results back to their cores, in assignment order
+        size_t next = 0;
+        for (auto& core : run.cores) {
+            for (size_t t = 0; t < core.threads.size(); t++) {
+                core.results.push_back(std::move(results[next++]));
+            }
+        }
+        runs.push_back(std::move(run));
+
+        if (smt.cooldown_sec > 0 && p + 1 < smt.policies.size()) {
+            std::this_thread::sleep_for(std::chrono::seconds(smt.cooldown_sec));
+        }
+    }
+
+    return runs;
+}
+
+// Kernel iterations per second of one thread, 0 if it did not run
+static double thread_throughput(const BenchmarkResult& result) {
+    return result.success && result.elapsed_sec > 0.0 ? result.total_iterations / result.elapsed_sec : 0.0;
+}
+
+// Averages of one policy across its cores
+struct SmtPolicySummary {
+    int threads = 0;
+    int succeeded = 0;
+    double avg_freq = 0.0;              // Mean of the thread averages
+    double primary_per_thread = 0.0;
+    double primary_per_core = 0.0;      // Sum over a core's primary threads, averaged over cores that ran
+    double secondary_per_thread = -1.0; // -1 if no thread ran the secondary kernel
+};
+
+static SmtPolicySummary summarize_smt_run(const SmtOptions& smt, const SmtRun& run) {
+    SmtPolicySummary summary;
+    double freq_sum = 0.0, primary_sum = 0.0, secondary_sum = 0.0;
+    int primary_threads = 0, secondary_threads = 0, primary_cores = 0;
+
+    for (const auto& core : run.cores) {
+        int core_primary_threads = primary_threads;
+        for (size_t t = 0; t < core.threads.size(); t++) {
+            const BenchmarkResult& result = core.results[t];
+            summary.threads++;
+            if (!result.success) {
+                continue;
+            }
+            summary.succeeded++;
+            freq_sum += result.avg_freq;
+            if (t == 0 || core.threads[t].instr_set == smt.primary) {
+                primary_sum += thread_throughput(result);
+                primary_threads++;
+            } else {
+                secondary_sum += thread_throughput(result);
+                secondary_threads++;
+            }
+        }
+        if (primary_threads > core_primary_threads) {
+            primary_cores++;
+        }
+    }
+
+    if (summary.succeeded > 0) {
+        summary.avg_freq = freq_sum / summary.succeeded;
+    }
+    if (primary_threads > 0) {
+        summary.primary_per_thread = primary_sum / primary_threads;
+    }
+    if (primary_cores > 0) {
+        summary.primary_per_core = primary_sum / primary_cores;
+    }
+    if (secondary_threads > 0) {
+        summary.secondary_per_thread = secondary_sum / secondary_threads;
+    }
+    return summary;
+}
+
+void print_smt_report(const SmtOptions& smt, const std::vector<SmtRun>& runs) {
+    std::string primary = get_instruction_set_name(smt.primary);
+    std::string secondary = get_instruction_set_name(smt.secondary);
+
+    std::cout << "\n========== SMT Placement: Threads ==========\n" << std::endl;
+    printf("%-14s %4s %6s %6s %-12s %10s %12s\n", "Policy", "Pkg", "Core", "CPU", "Kernel", "Avg MHz", "M iter/s");
+    for (const auto& run : runs) {
+        std::string policy = get_smt_policy_name(run.policy);
+        for (const auto& core : run.cores) {
+            double freq_sum = 0.0, throughput_sum = 0.0;
+            int succeeded = 0;
+            bool one_kernel = true;
+            for (size_t t = 0; t < core.threads.size(); t++) {
+                const BenchmarkResult& result = core.results[t];
+                std::string kernel = get_instruction_set_name(core.threads[t].instr_set);
+                one_kernel = one_kernel && core.threads[t].instr_set == core.threads[0].instr_set;
+                if (!result.success) {
+                    printf("%-14s %4d %6d %6d %-12s %10s %12s\n", policy.c_str(), core.package_id, core.core_id,
+                           core.threads[t].cpu, kernel.c_str(), "N/A", "N/A");
+                    continue;
+                }
+                printf("%-14s %4d %6d %6d %-12s %10.2f %12.2f\n", policy.c_str(), core.package_id, core.core_id,
+                       core.threads[t].cpu, kernel.c_str(), result.avg_freq, thread_throughput(result) / 1e6);
+                freq_sum += result.avg_freq;
+                throughput_sum += thread_throughput(result);
+                succeeded++;
+            }
+
+            // Iterations of different kernels do not add up to anything meaningful
+            if (core.threads.size() > 1 && succeeded > 0) {
+                char throughput[16] = "-";
+                if (one_kernel) {
+                    snprintf(throughput, sizeof(throughput), "%.2f", throughput_sum / 1e6);
+                }
+                printf("%-14s %4d %6d %6s %-12s %10.2f %12s\n", policy.c_str(), core.package_id, core.core_id,
+                       "core", one_kernel ? get_instruction_set_name(core.threads[0].instr_set).c_str() : "mixed",
+                       freq_sum / succeeded, throughput);
+            }
+        }
+    }
+
+    // Baseline for the per-core comparison
+    const SmtRun* baseline = nullptr;
+    for (const auto& run : runs) {
+        if (run.policy == SmtPolicy::ONE_PER_CORE) {
+            baseline = &run;
+        }
+    }
+    double baseline_per_core = baseline != nullptr ? summarize_smt_run(smt, *baseline).primary_per_core : 0.0;
+
+    std::cout << "\n========== SMT Placement: Summary ==========\n" << std::endl;
+    std::cout << "Primary kernel: " << primary << ", secondary kernel: " << secondary << std::endl;
+    std::cout << "Throughput in M iter/s; per core sums the primary threads of each core\n" << std::endl;
+    printf("%-14s %8s %10s %16s %16s %12s %18s\n",
+           "Policy", "OK", "Avg MHz", "Primary/thread", "Primary/core", "vs 1/core", "Secondary/thread");
+    for (const auto& run : runs) {
+        SmtPolicySummary summary = summarize_smt_run(smt, run);
+        char ok[16];
+        snprintf(ok, sizeof(ok), "%d/%d", summary.succeeded, summary.threads);
+        if (summary.succeeded == 0) {
+            printf("%-14s %8s %10s %16s %16s %12s %18s\n",
+                   get_smt_policy_name(run.policy).c_str(), ok, "N/A", "N/A", "N/A", "-", "-");
+            continue;
+        }
+
+        char relative[16] = "-";
+        if (baseline_per_core > 0.0) {
+            snprintf(relative, sizeof(relative), "%+.1f%%", (summary.primary_per_core / baseline_per_core - 1.0) * 100.0);
+        }
+        char secondary_text[16] = "-";
+        if (summary.secondary_per_thread >= 0.0) {
+            snprintf(secondary_text, sizeof(secondary_text), "%.2f", summary.secondary_per_thread / 1e6);
+        }
+        printf("%-14s %8s %10.2f %16.2f %16.2f %12s %18s\n",
+               get_smt_policy_name(run.policy).c_str(), ok, summary.avg_freq, summary.primary_per_thread / 1e6,
+               summary.primary_per_core / 1e6, relative, secondary_text);
+    }
+}
+
+void write_smt_report(std::ostream& out, const SmtOptions& smt, const std::vector<SmtRun>& runs) {
+    JsonWriter json(out);
+
+    json.begin_object();
+    json.field("tool", "cpu_instr_freq");
+    json.field("mode", "smt");
+    json.key("host");
+    write_host_json(json);
+    json.key("options");
+    write_options_json(json, smt.options);
+    json.field("primary", get_instruction_set_name(smt.primary));
+    json.field("secondary", get_instruction_set_name(smt.secondary));
+    json.field("cooldown_sec", smt.cooldown_sec);
+
+    json.key("policies").begin_array();
+    for (const auto& run : runs) {
+        SmtPolicySummary summary = summarize_smt_run(smt, run);
+        json.begin_object();
+        json.field("policy", get_smt_policy_name(run.policy));
+        json.key("summary").begin_object();
+        json.field("threads", summary.threads);
+        json.field("succeeded", summary.succeeded);
+        json.field("avg_freq_mhz", summary.avg_freq);
+        json.field("primary_per_thread_per_sec", summary.primary_per_thread);
+        json.field("primary_per_core_per_sec", summary.primary_per_core);
+        if (summary.secondary_per_thread >= 0.0) {
+            json.field("secondary_per_thread_per_sec", summary.secondary_per_thread);
+        }
+        json.end_object();
+
+        json.key("cores").begin_array();
+        for (const auto& core : run.cores) {
+            json.begin_object();
+            json.field("package", core.package_id);
+            json.field("core", core.core_id);
+            json.key("threads").begin_array();
+            for (size_t t = 0; t < core.threads.size(); t++) {
+                write_benchmark_result_json(json, core.threads[t].instr_set, core.results[t]);
+            }
+            json.end_array();
+            json.end_object();
+        }
+        json.end_array();
+        json.end_object();
+    }
+    json.end_array();
+    json.end_object();
+}
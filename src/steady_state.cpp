@@ -0,0 +1,123 @@
+#include "steady_state.h"
+
+#include <algorithm>
+#include <cmath>
+
+SteadyStateDetector::SteadyStateDetector(const SteadyStateOptions& options)
+    : options_(options) {
+    options_.window = std::max<size_t>(options_.window, 2);
+    options_.throttle_samples = std::max<size_t>(options_.throttle_samples, 1);
+}
+
+void SteadyStateDetector::add_sample(double time_sec, double freq_mhz) {
+    last_time_sec_ = time_sec;
+
+    window_.push_back(freq_mhz);
+    if (window_.size() > options_.window) {
+        window_.pop_front();
+    }
+
+    switch(phase_) {
+        case RunPhase::WARMUP:
+        case RunPhase::THROTTLING:
+            // Wait for the window to settle, then start a fresh steady phase
+            // seeded with the settled window
+            if (window_.size() == options_.window && window_stable()) {
+                if (warmup_sec_ < 0.0) {
+                    warmup_sec_ = time_sec;
+                }
+                enter_phase(RunPhase::STEADY, time_sec);
+                reset_steady_stats();
+                for (double sample : window_) {
+                    add_steady_sample(sample);
+                }
+            }
+            break;
+
+        case RunPhase::STEADY:
+            if (freq_mhz < steady_mean_ * (1.0 - options_.throttle_drop)) {
+                low_run_++;
+            } else {
+                low_run_ = 0;
+            }
+
+            if (low_run_ >= options_.throttle_samples) {
+                size_t low_samples = low_run_;
+                throttle_events_++;
+                enter_phase(RunPhase::THROTTLING, time_sec);
+                // Only the low samples belong to the new level
+                while (window_.size() > low_samples) {
+                    window_.pop_front();
+                }
+            } else {
+                add_steady_sample(freq_mhz);
+            }
+            break;
+    }
+}
+
+bool SteadyStateDetector::converged() const {
+    return phase_ == RunPhase::STEADY &&
+           steady_count_ >= options_.window &&
+           ci_half_width() <= options_.ci_target_mhz;
+}
+
+double SteadyStateDetector::ci_half_width() const {
+    if (steady_count_ < 2) {
+        return INFINITY;
+    }
+    // Normal approximation of the 95% interval of the mean
+    double variance = steady_m2_ / (steady_count_ - 1);
+    return 1.96 * std::sqrt(variance / steady_count_);
+}
+
+std::vector<PhaseSpan> SteadyStateDetector::phases() const {
+    std::vector<PhaseSpan> spans = closed_phases_;
+    spans.push_back({phase_, phase_start_sec_, last_time_sec_});
+    return spans;
+}
+
+void SteadyStateDetector::enter_phase(RunPhase phase, double time_sec) {
+    closed_phases_.push_back({phase_, phase_start_sec_, time_sec});
+    phase_ = phase;
+    phase_start_sec_ = time_sec;
+    low_run_ = 0;
+}
+
+bool SteadyStateDetector::window_stable() const {
+    auto [min_it, max_it] = std::minmax_element(window_.begin(), window_.end());
+    double mean = 0.0;
+    for (double sample : window_) {
+        mean += sample;
+    }
+    mean /= window_.size();
+    if (mean <= 0.0) {
+        return false;
+    }
+    return (*max_it - *min_it) / mean <= options_.stable_tolerance;
+}
+
+void SteadyStateDetector::reset_steady_stats() {
+    steady_count_ = 0;
+    steady_mean_ = 0.0;
+    steady_m2_ = 0.0;
+}
+
+void SteadyStateDetector::add_steady_sample(double freq_mhz) {
+    steady_count_++;
+    double delta = freq_mhz - steady_mean_;
+    steady_mean_ += delta / steady_count_;
+    steady_m2_ += delta * (freq_mhz - steady_mean_);
+}
+
+std::string run_phase_name(RunPhase phase) {
+    switch(phase) {
+        case RunPhase::WARMUP:
+            return "warm-up";
+        case RunPhase::STEADY:
+            return "steady";
+        case RunPhase::THROTTLING:
+            return "throttling";
+    }
+    return "unknown";
+}
@@ -0,0 +1,30 @@
+#include "stop_signal.h"
+
+#include <csignal>
+#include <cstring>
+
+static volatile sig_atomic_t g_stop_requested = 0;
+
+static void handle_stop_signal(int signal_number) {
+    g_stop_requested = signal_number;
+}
+
+void install_stop_handlers() {
+    struct sigaction action;
+    memset(&action, 0, sizeof(action));
+    action.sa_handler = handle_stop_signal;
+    sigaction(SIGINT, &action, nullptr);
+    sigaction(SIGTERM, &action, nullptr);
+}
+
+bool stop_requested() {
+    return g_stop_requested != 0;
+}
+
+void restore_stop_handlers() {
+    signal(SIGINT, SIG_DFL);
+    signal(SIGTERM, SIG_DFL);
+    if (g_stop_requested != 0) {
+        raise(g_stop_requested);
+    }
+}
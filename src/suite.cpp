@@ -0,0 +1,212 @@
+#include "suite.h"
+#include "json_writer.h"
+#include "kernels.h"
+#include "report.h"
+#include "topology.h"
+
+#include <chrono>
+#include <cstdio>
+#include <iostream>
+#include <set>
+#include <sstream>
+#include <stdexcept>
+#include <thread>
+
+std::vector<SuitePlacement> parse_placement_list(const std::string& list) {
+    std::vector<SuitePlacement> placements;
+    std::stringstream ss(list);
+    std::string item;
+    while (std::getline(ss, item, ',')) {
+        SuitePlacement placement;
+        if (item == "single") {
+            placement = SuitePlacement::SINGLE;
+        } else if (item == "parallel") {
+            placement = SuitePlacement::PARALLEL;
+        } else if (item == "sequential") {
+            placement = SuitePlacement::SEQUENTIAL;
+        } else {
+            throw std::invalid_argument("Unknown placement: " + item + " (expected single, parallel or sequential)");
+        }
+        placements.push_back(placement);
+    }
+    if (placements.empty()) {
+        throw std::invalid_argument("Empty placement list");
+    }
+    return placements;
+}
+
+std::string get_placement_name(SuitePlacement placement) {
+    switch(placement) {
+        case SuitePlacement::SINGLE:
+            return "single";
+        case SuitePlacement::PARALLEL:
+            return "parallel";
+        case SuitePlacement::SEQUENTIAL:
+            return "sequential";
+    }
+    return "unknown";
+}
+
+// One CPU per package, on distinct physical cores
+static std::vector<int> default_single_cpus(const std::vector<CpuTopology>& topology) {
+    std::set<int> packages;
+    for (const auto& cpu : topology) {
+        packages.insert(cpu.package_id);
+    }
+    return spread_cpus(topology, static_cast<int>(packages.size()));
+}
+
+std::vector<SuiteEntry> run_suite(WorkerPool& pool, const SuiteOptions& suite) {
+    std::vector<int> single_cpus = suite.single_cpus;
+    if (single_cpus.empty()) {
+        single_cpus = default_single_cpus(get_cpu_topology(pool.cpus()));
+    }
+
+    // Expand the matrix first so progress can be numbered
+    std::vector<SuiteEntry> entries;
+    for (InstructionSet instr_set : suite.instr_sets) {
+        for (SuitePlacement placement : suite.placements) {
+            SuiteEntry entry;
+            entry.instr_set = instr_set;
+            entry.placement = placement;
+            entry.supported = get_kernel(instr_set) != nullptr;
+            if (placement == SuitePlacement::SINGLE) {
+                for (int cpu : single_cpus) {
+                    entry.cpus = {cpu};
+                    entries.push_back(entry);
+                }
+            } else {
+                entry.cpus = pool.cpus();
+                entries.push_back(entry);
+            }
+        }
+    }
+
+    size_t index = 0;
+    for (auto& entry : entries) {
+        index++;
+        std::string instr_name = get_instruction_set_name(entry.instr_set);
+        if (!entry.supported) {
+            std::cout << "[" << index << "/" << entries.size() << "] " << instr_name << " "
+                      << get_placement_name(entry.placement) << ": skipped, not supported by this CPU" << std::endl;
+            continue;
+        }
+        std::cout << "[" << index << "/" << entries.size() << "] " << instr_name << " "
+                  << get_placement_name(entry.placement);
+        if (entry.placement == SuitePlacement::SINGLE) {
+            std::cout << " on CPU " << entry.cpus[0];
+        } else {
+            std::cout << " on " << entry.cpus.size() << " CPUs";
+        }
+        std::cout << std::endl;
+
+        auto start = std::chrono::steady_clock::now();
+        switch(entry.placement) {
+            case SuitePlacement::SINGLE:
+            case SuitePlacement::SEQUENTIAL:
+                for (int cpu : entry.cpus) {
+                    entry.results.push_back(pool.submit_benchmark(cpu, entry.instr_set, suite.options).get());
+                }
+                break;
+            case SuitePlacement::PARALLEL: {
+                std::vector<CoreAssignment> assignments;
+                for (int cpu : entry.cpus) {
+                    assignments.push_back({cpu, entry.instr_set});
+                }
+                entry.results = run_synchronized(pool, assignments, suite.options);
+                break;
+            }
+        }
+        entry.wall_sec = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+        if (suite.cooldown_sec > 0 && index < entries.size()) {
+            std::this_thread::sleep_for(std::chrono::seconds(suite.cooldown_sec));
+        }
+    }
+    return entries;
+}
+
+void print_suite_summary(const std::vector<SuiteEntry>& entries) {
+    std::cout << "\n========== Benchmark Suite ==========\n" << std::endl;
+    printf("%-12s %-10s %-10s %8s %12s %12s %14s %8s\n",
+           "ISA", "Placement", "CPUs", "OK", "Avg MHz", "Min core MHz", "M iter/s", "Wall s");
+
+    for (const auto& entry : entries) {
+        std::string name = get_instruction_set_name(entry.instr_set);
+        std::string placement = get_placement_name(entry.placement);
+        char cpus[16];
+        if (entry.cpus.size() == 1) {
+            snprintf(cpus, sizeof(cpus), "%d", entry.cpus[0]);
+        } else {
+            snprintf(cpus, sizeof(cpus), "%zu", entry.cpus.size());
+        }
+
+        if (!entry.supported) {
+            printf("%-12s %-10s %-10s %8s %12s %12s %14s %8s\n",
+                   name.c_str(), placement.c_str(), cpus, "skipped", "-", "-", "-", "-");
+            continue;
+        }
+        ResultSummary summary = summarize_results(entry.results);
+        char ok[16];
+        snprintf(ok, sizeof(ok), "%d/%d", summary.succeeded, summary.cores);
+        if (summary.succeeded == 0) {
+            printf("%-12s %-10s %-10s %8s %12s %12s %14s %8.1f\n",
+                   name.c_str(), placement.c_str(), cpus, ok, "N/A", "N/A", "N/A", entry.wall_sec);
+            continue;
+        }
+        printf("%-12s %-10s %-10s %8s %12.2f %12.2f %14.2f %8.1f\n",
+               name.c_str(), placement.c_str(), cpus, ok, summary.avg_freq, summary.min_core_freq,
+               summary.throughput / 1e6, entry.wall_sec);
+    }
+}
+
+void write_suite_report(std::ostream& out, const SuiteOptions& suite,
+                        const std::vector<SuiteEntry>& entries, double wall_sec) {
+    JsonWriter json(out);
+
+    json.begin_object();
+    json.field("tool", "cpu_instr_freq");
+    json.field("mode", "suite");
+    json.key("host");
+    write_host_json(json);
+    json.key("options");
+    write_options_json(json, suite.options);
+    json.field("cooldown_sec", suite.cooldown_sec);
+    json.field("wall_sec", wall_sec);
+
+    json.key("entries").begin_array();
+    for (const auto& entry : entries) {
+        json.begin_object();
+        json.field("instr", get_instruction_set_name(entry.instr_set));
+        json.field("placement", get_placement_name(entry.placement));
+        json.key("cpus").begin_array(true);
+        for (int cpu : entry.cpus) {
+            json.value(cpu);
+        }
+        json.end_array();
+
+        if (!entry.supported) {
+            json.field("status", "unsupported");
+            json.end_object();
+            continue;
+        }
+        ResultSummary summary = summarize_results(entry.results);
+        json.field("status", summary.all_succeeded() ? "ok" : "failed");
+        json.field("wall_sec", entry.wall_sec);
+        json.key("summary");
+        write_summary_json(json, summary);
+        if (entry.placement == SuitePlacement::PARALLEL) {
+            StartAlignment alignment = compute_start_alignment(entry.results);
+            json.field("start_skew_us", alignment.skew_us);
+            json.field("overlap_sec", alignment.overlap_sec);
+        }
+        json.key("cores").begin_array();
+        for (const auto& result : entry.results) {
+            write_benchmark_result_json(json, entry.instr_set, result);
+        }
+        json.end_array();
+        json.end_object();
+    }
+    json.end_array();
+    json.end_object();
+}
@@ -0,0 +1,108 @@
+#include "sweep.h"
+#include "topology.h"
+
+#include <algorithm>
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <string>
+#include <thread>
+
+std::vector<SweepPoint> run_active_core_sweep(WorkerPool& pool,
+                                              const std::vector<InstructionSet>& instr_sets,
+                                              const BenchmarkOptions& options,
+                                              int cooldown_sec) {
+    std::vector<CpuTopology> topology = get_cpu_topology(pool.cpus());
+    std::vector<int> counts = sweep_core_counts(static_cast<int>(pool.cpus().size()));
+    std::vector<SweepPoint> points;
+
+    for (InstructionSet instr_set : instr_sets) {
+        for (int count : counts) {
+            SweepPoint point;
+            point.instr_set = instr_set;
+            point.active_cores = count;
+            point.cpus = spread_cpus(topology, count);
+
+            std::cout << "\nSweep: " << get_instruction_set_name(instr_set)
+                      << " on " << count << " active core(s)" << std::endl;
+
+            std::vector<CoreAssignment> assignments;
+            for (int cpu : point.cpus) {
+                assignments.push_back({cpu, instr_set});
+            }
+            std::vector<BenchmarkResult> results = run_synchronized(pool, assignments, options);
+            print_start_alignment(results);
+
+            // A cell only counts if every active core ran
+            ResultSummary summary = summarize_results(results);
+            point.success = summary.all_succeeded();
+            point.avg_freq = summary.avg_freq;
+            point.min_core_freq = summary.min_core_freq;
+            point.throughput = summary.throughput;
+            points.push_back(point);
+
+            if (summary.succeeded == 0) {
+                // Unsupported ISA: larger counts will fail the same way
+                std::cout << get_instruction_set_name(instr_set) << " is not supported, skipping" << std::endl;
+                break;
+            }
+
+            if (cooldown_sec > 0) {
+                std::this_thread::sleep_for(std::chrono::seconds(cooldown_sec));
+            }
+        }
+    }
+
+    return points;
+}
+
+void print_sweep_table(const std::vector<SweepPoint>& points) {
+    // Collect columns (ISAs in sweep order) and rows (active-core counts)
+    std::vector<InstructionSet> columns;
+    std::vector<int> rows;
+    std::map<std::pair<int, int>, const SweepPoint*> cells;
+
+    for (const auto& point : points) {
+        if (std::find(columns.begin(), columns.end(), point.instr_set) == columns.end()) {
+            columns.push_back(point.instr_set);
+        }
+        if (std::find(rows.begin(), rows.end(), point.active_cores) == rows.end()) {
+            rows.push_back(point.active_cores);
+        }
+        cells[{point.active_cores, static_cast<int>(point.instr_set)}] = &point;
+    }
+    std::sort(rows.begin(), rows.end());
+
+    auto print_table = [&](const std::string& title, double scale, int precision) {
+        std::cout << "\n========== " << title << " ==========\n" << std::endl;
+        std::cout << "Active   ";
+        for (InstructionSet instr_set : columns) {
+            std::cout << "| " << std::setw(14) << get_instruction_set_name(instr_set) << " ";
+        }
+        std::cout << std::endl;
+        std::cout << "---------";
+        for (size_t i = 0; i < columns.size(); i++) {
+            std::cout << "|----------------";
+        }
+        std::cout << std::endl;
+
+        for (int row : rows) {
+            std::cout << std::setw(8) << row << " ";
+            for (InstructionSet instr_set : columns) {
+                auto it = cells.find({row, static_cast<int>(instr_set)});
+                if (it != cells.end() && it->second->success) {
+                    std::cout << "| " << std::fixed << std::setw(14) << std::setprecision(precision)
+                              << it->second->avg_freq / scale << " ";
+                } else {
+                    std::cout << "| " << std::setw(14) << "N/A" << " ";
+                }
+            }
+            std::cout << std::endl;
+        }
+    };
+
+    print_table("Active-Core Sweep: Average Frequency (MHz)", 1.0, 2);
+    // Ratio to the 100 MHz reference clock, comparable with the turbo ratio limits
+    print_table("Active-Core Sweep: Measured Turbo Ratio", 100.0, 1);
+}
@@ -0,0 +1,268 @@
+#include "synthetic_tree.h"
+#include "stop_signal.h"
+#include "topology.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <ctime>
+#include <fcntl.h>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace {
+
+// Placement of one synthetic CPU
+struct SyntheticCpu {
+    int package_id;
+    int core_id;
+};
+
+std::vector<SyntheticCpu> layout_cpus(const SyntheticTreeOptions& options) {
+    int physical_cores = options.cpus / options.threads_per_core;
+    int cores_per_package = physical_cores / options.packages;
+    std::vector<SyntheticCpu> cpus(options.cpus);
+    for (int cpu = 0; cpu < options.cpus; cpu++) {
+        int physical = cpu % physical_cores;
+        cpus[cpu].package_id = physical / cores_per_package;
+        cpus[cpu].core_id = physical % cores_per_package;
+    }
+    return cpus;
+}
+
+void make_dirs(const std::string& path) {
+    for (size_t slash = 1; slash != std::string::npos; slash = path.find('/', slash + 1)) {
+        std::string prefix = path.substr(0, slash);
+        if (!prefix.empty() && mkdir(prefix.c_str(), 0755) != 0 && errno != EEXIST) {
+            throw std::runtime_error("cannot create " + prefix + ": " + strerror(errno));
+        }
+    }
+    if (mkdir(path.c_str(), 0755) != 0 && errno != EEXIST) {
+        throw std::runtime_error("cannot create " + path + ": " + strerror(errno));
+    }
+}
+
+void write_file(const std::string& path, const std::string& text) {
+    std::ofstream file(path, std::ios::trunc);
+    if (!(file << text)) {
+        throw std::runtime_error("cannot write " + path);
+    }
+}
+
+// Overwrite a file in place, so descriptors that readers keep open see the
+// new contents. The trailing newline keeps a shorter value parseable even if
+// a reader lands between the write and the truncate.
+void rewrite_in_place(int fd, const std::string& text) {
+    if (pwrite(fd, text.data(), text.size(), 0) == static_cast<ssize_t>(text.size())) {
+        if (ftruncate(fd, text.size()) != 0) {
+            // Leaves trailing bytes after the newline, which readers ignore
+        }
+    }
+}
+
+std::string cpuinfo_text(const std::vector<SyntheticCpu>& cpus, const std::vector<uint32_t>& khz) {
+    std::ostringstream text;
+    char mhz[32];
+    for (size_t cpu = 0; cpu < cpus.size(); cpu++) {
+        snprintf(mhz, sizeof(mhz), "%u.%03u", khz[cpu] / 1000, khz[cpu] % 1000);
+        text << "processor\t: " << cpu << "\n"
+             << "vendor_id\t: GenuineIntel\n"
+             << "model name\t: Synthetic CPU\n"
+             << "cpu MHz\t\t: " << mhz << "\n"
+             << "physical id\t: " << cpus[cpu].package_id << "\n"
+             << "core id\t\t: " << cpus[cpu].core_id << "\n"
+             << "flags\t\t: fpu sse sse2 avx avx2 fma avx512f\n\n";
+    }
+    return text.str();
+}
+
+std::string cpu_dir(const std::string& root, int cpu) {
+    return root + "/sys/devices/system/cpu/cpu" + std::to_string(cpu);
+}
+
+void validate(const SyntheticTreeOptions& options) {
+    if (options.root.empty()) {
+        throw std::invalid_argument("synthetic tree needs a directory");
+    }
+    if (options.cpus <= 0 || options.packages <= 0 || options.threads_per_core <= 0
+        || options.cpus % (options.packages * options.threads_per_core) != 0) {
+        throw std::invalid_argument("CPU count must be a positive multiple of packages x threads per core");
+    }
+}
+
+} // namespace
+
+std::vector<TimelineStep> load_timeline(const std::string& path) {
+    std::ifstream file(path);
+    if (!file) {
+        throw std::runtime_error("cannot open timeline " + path);
+    }
+
+    std::vector<TimelineStep> steps;
+    std::string line;
+    int line_number = 0;
+    while (std::getline(file, line)) {
+        line_number++;
+        size_t comment = line.find('#');
+        if (comment != std::string::npos) {
+            line.resize(comment);
+        }
+        std::istringstream fields(line);
+        std::string time_text, cpus_text, khz_text, extra;
+        if (!(fields >> time_text)) {
+            continue;
+        }
+
+        try {
+            if (!(fields >> cpus_text >> khz_text) || (fields >> extra)) {
+                throw std::invalid_argument("expected 'SECONDS CPUS KHZ'");
+            }
+            TimelineStep step;
+            char* end = nullptr;
+            step.time_sec = strtod(time_text.c_str(), &end);
+            if (*end != '\0' || step.time_sec < 0) {
+                throw std::invalid_argument("bad time '" + time_text + "'");
+            }
+            unsigned long khz = strtoul(khz_text.c_str(), &end, 10);
+            if (*end != '\0' || khz == 0) {
+                throw std::invalid_argument("bad frequency '" + khz_text + "'");
+            }
+            step.khz = static_cast<uint32_t>(khz);
+            if (cpus_text != "all") {
+                step.cpus = parse_cpu_list(cpus_text);
+            }
+            steps.push_back(step);
+        } catch (const std::exception& e) {
+            throw std::runtime_error(path + ":" + std::to_string(line_number) + ": " + e.what());
+        }
+    }
+
+    std::stable_sort(steps.begin(), steps.end(), [](const TimelineStep& a, const TimelineStep& b) {
+        return a.time_sec < b.time_sec;
+    });
+    return steps;
+}
+
+void build_synthetic_tree(const SyntheticTreeOptions& options) {
+    validate(options);
+    std::vector<SyntheticCpu> cpus = layout_cpus(options);
+    std::string range = "0-" + std::to_string(options.cpus - 1) + "\n";
+
+    std::string system_cpu = options.root + "/sys/devices/system/cpu";
+    make_dirs(system_cpu);
+    write_file(system_cpu + "/online", range);
+    write_file(system_cpu + "/present", range);
+    write_file(system_cpu + "/possible", range);
+
+    for (int cpu = 0; cpu < options.cpus; cpu++) {
+        std::string dir = cpu_dir(options.root, cpu);
+        make_dirs(dir + "/cpufreq");
+        make_dirs(dir + "/topology");
+        write_file(dir + "/cpufreq/scaling_cur_freq", std::to_string(options.base_khz) + "\n");
+        write_file(dir + "/cpufreq/cpuinfo_max_freq", std::to_string(options.base_khz) + "\n");
+        write_file(dir + "/topology/physical_package_id", std::to_string(cpus[cpu].package_id) + "\n");
+        write_file(dir + "/topology/core_id", std::to_string(cpus[cpu].core_id) + "\n");
+    }
+
+    make_dirs(options.root + "/proc");
+    write_file(options.root + "/proc/cpuinfo",
+               cpuinfo_text(cpus, std::vector<uint32_t>(options.cpus, options.base_khz)));
+}
+
+int run_synthetic_tree(const SyntheticTreeOptions& options) {
+    std::vector<TimelineStep> steps;
+    try {
+        build_synthetic_tree(options);
+        if (!options.timeline_path.empty()) {
+            steps = load_timeline(options.timeline_path);
+        }
+    } catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << std::endl;
+        return 1;
+    }
+
+    std::cout << "Synthetic tree with " << options.cpus << " CPUs (" << options.packages << " package(s), "
+              << options.threads_per_core << " thread(s) per core) at " << options.root << std::endl;
+    if (steps.empty()) {
+        return 0;
+    }
+
+    // Descriptors stay open so each step is a handful of pwrite() calls
+    std::vector<int> freq_fds(options.cpus, -1);
+    for (int cpu = 0; cpu < options.cpus; cpu++) {
+        std::string path = cpu_dir(options.root, cpu) + "/cpufreq/scaling_cur_freq";
+        freq_fds[cpu] = open(path.c_str(), O_WRONLY | O_CLOEXEC);
+    }
+    int cpuinfo_fd = open((options.root + "/proc/cpuinfo").c_str(), O_WRONLY | O_CLOEXEC);
+    std::vector<SyntheticCpu> cpus = layout_cpus(options);
+    std::vector<uint32_t> khz(options.cpus, options.base_khz);
+
+    install_stop_handlers();
+    std::cout << "Playing " << steps.size() << " timeline step(s) from " << options.timeline_path
+              << "; Ctrl+C to stop" << std::endl;
+
+    struct timespec start;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+
+    for (size_t i = 0; i < steps.size() && !stop_requested(); i++) {
+        const TimelineStep& step = steps[i];
+        struct timespec when = start;
+        double whole = 0.0;
+        double fraction = modf(step.time_sec, &whole);
+        when.tv_sec += static_cast<time_t>(whole);
+        when.tv_nsec += static_cast<long>(fraction * 1e9);
+        if (when.tv_nsec >= 1000000000L) {
+            when.tv_nsec -= 1000000000L;
+            when.tv_sec++;
+        }
+        while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &when, nullptr) == EINTR && !stop_requested()) {
+        }
+        if (stop_requested()) {
+            break;
+        }
+
+        std::string value = std::to_string(step.khz) + "\n";
+        auto apply = [&](int cpu) {
+            if (cpu >= 0 && cpu < options.cpus) {
+                khz[cpu] = step.khz;
+                rewrite_in_place(freq_fds[cpu], value);
+            }
+        };
+        if (step.cpus.empty()) {
+            for (int cpu = 0; cpu < options.cpus; cpu++) {
+                apply(cpu);
+            }
+        } else {
+            for (int cpu : step.cpus) {
+                apply(cpu);
+            }
+        }
+        if (cpuinfo_fd >= 0) {
+            rewrite_in_place(cpuinfo_fd, cpuinfo_text(cpus, khz));
+        }
+    }
+
+    if (!stop_requested()) {
+        std::cout << "Timeline finished; holding the last step until stopped" << std::endl;
+        struct timespec idle = {0, 200000000L};
+        while (!stop_requested()) {
+            nanosleep(&idle, nullptr);
+        }
+    }
+
+    for (int fd : freq_fds) {
+        if (fd >= 0) {
+            close(fd);
+        }
+    }
+    if (cpuinfo_fd >= 0) {
+        close(cpuinfo_fd);
+    }
+    return 0;
+}
@@ -0,0 +1,112 @@
+#include "topology.h"
+#include "probe/sources.h"
+
+#include <algorithm>
+#include <fstream>
+#include <map>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+
+// Read a single integer from a sysfs file, or return fallback
+static int read_sysfs_int(const std::string& path, int fallback) {
+    std::ifstream file(path);
+    int value;
+    if (file >> value) {
+        return value;
+    }
+    return fallback;
+}
+
+std::vector<CpuTopology> get_cpu_topology(const std::vector<int>& cpus) {
+    std::vector<CpuTopology> topology;
+    std::map<std::pair<int, int>, int> threads_per_core;
+
+    for (int cpu : cpus) {
+        std::stringstream base;
+        base << cfp::fs_path("/sys/devices/system/cpu/cpu") << cpu << "/topology/";
+
+        CpuTopology entry;
+        entry.cpu = cpu;
+        entry.package_id = read_sysfs_int(base.str() + "physical_package_id", 0);
+        entry.core_id = read_sysfs_int(base.str() + "core_id", cpu);
+        entry.smt_index = threads_per_core[{entry.package_id, entry.core_id}]++;
+        topology.push_back(entry);
+    }
+
+    return topology;
+}
+
+std::vector<int> spread_cpus(const std::vector<CpuTopology>& topology, int count) {
+    // Per package, order CPUs so every physical core comes before any sibling
+    std::map<int, std::vector<CpuTopology>> by_package;
+    for (const auto& entry : topology) {
+        by_package[entry.package_id].push_back(entry);
+    }
+    for (auto& [package_id, entries] : by_package) {
+        std::stable_sort(entries.begin(), entries.end(), [](const CpuTopology& a, const CpuTopology& b) {
+            return a.smt_index < b.smt_index;
+        });
+    }
+
+    // Round-robin across packages
+    std::vector<int> chosen;
+    size_t round = 0;
+    while (static_cast<int>(chosen.size()) < count) {
+        bool picked = false;
+        for (const auto& [package_id, entries] : by_package) {
+            if (round < entries.size() && static_cast<int>(chosen.size()) < count) {
+                chosen.push_back(entries[round].cpu);
+                picked = true;
+            }
+        }
+        if (!picked) {
+            break;  // Fewer CPUs than requested
+        }
+        round++;
+    }
+
+    return chosen;
+}
+
+std::vector<int> sweep_core_counts(int max_count) {
+    std::vector<int> counts;
+    for (int count = 1; count < max_count; count *= 2) {
+        counts.push_back(count);
+    }
+    if (max_count > 0) {
+        counts.push_back(max_count);
+    }
+    return counts;
+}
+
+std::vector<int> parse_cpu_list(const std::string& list) {
+    std::vector<int> cpus;
+    if (!cfp::parse_cpu_list(list, cpus)) {
+        throw std::invalid_argument("Invalid CPU list: " + list);
+    }
+    return cpus;
+}
+
+std::string format_cpu_list(const std::vector<int>& cpus) {
+    std::vector<int> sorted = cpus;
+    std::sort(sorted.begin(), sorted.end());
+    sorted.erase(std::unique(sorted.begin(), sorted.end()), sorted.end());
+
+    std::string list;
+    for (size_t i = 0; i < sorted.size();) {
+        size_t end = i;
+        while (end + 1 < sorted.size() && sorted[end + 1] == sorted[end] + 1) {
+            end++;
+        }
+        if (!list.empty()) {
+            list += ",";
+        }
+        list += std::to_string(sorted[i]);
+        if (end > i) {
+            list += "-" + std::to_string(sorted[end]);
+        }
+        i = end + 1;
+    }
+    return list;
+}
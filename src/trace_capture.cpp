@@ -0,0 +1,143 @@
+#include "trace_capture.h"
+#include "stop_signal.h"
+#include "probe/tracepoints.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <iomanip>
+#include <iostream>
+#include <map>
+
+namespace {
+
+// Transitions seen for one CPU
+struct CpuTransitions {
+    uint64_t frequency_changes = 0;
+    uint32_t min_khz = 0;
+    uint32_t max_khz = 0;
+    uint32_t last_khz = 0;
+    uint64_t first_ns = 0;
+    uint64_t last_ns = 0;
+    uint64_t idle_entries = 0;
+};
+
+} // namespace
+
+int run_trace_capture(const TraceCaptureOptions& options) {
+    cfp::TracepointOptions source_options;
+    source_options.tracefs_root = options.tracefs_root;
+    source_options.idle_events = options.idle_events;
+
+    install_stop_handlers();
+
+    cfp::TracepointSource source;
+    std::string error;
+    if (!source.open(source_options, {}, error)) {
+        std::cerr << "Error: " << error << std::endl;
+        return 1;
+    }
+
+    FILE* csv = nullptr;
+    if (!options.output_path.empty()) {
+        csv = fopen(options.output_path.c_str(), "w");
+        if (csv == nullptr) {
+            std::cerr << "Error: cannot write " << options.output_path << std::endl;
+            return 1;
+        }
+        setvbuf(csv, nullptr, _IOFBF, 256 * 1024);
+        fprintf(csv, "timestamp_ns,cpu,event,value\n");
+    }
+
+    std::cout << (source.is_live() ? "Capturing" : "Replaying") << " power:cpu_frequency"
+              << (options.idle_events ? " and power:cpu_idle" : "") << " from " << source.root()
+              << " (trace clock: " << (source.clock().empty() ? "unknown" : source.clock()) << ")" << std::endl;
+    if (source.is_live()) {
+        std::cout << "Press Ctrl+C to stop" << std::endl;
+    }
+
+    std::map<int, CpuTransitions> transitions;
+    std::vector<cfp::TraceEvent> events;
+    uint64_t total_events = 0;
+
+    auto handle_batch = [&]() {
+        // Per-CPU buffers are only ordered individually
+        std::sort(events.begin(), events.end(), [](const cfp::TraceEvent& a, const cfp::TraceEvent& b) {
+            return a.timestamp_ns < b.timestamp_ns;
+        });
+
+        for (const auto& event : events) {
+            int cpu = static_cast<int>(event.cpu);
+            if (!options.cpus.empty() && std::find(options.cpus.begin(), options.cpus.end(), cpu) == options.cpus.end()) {
+                continue;
+            }
+            total_events++;
+
+            CpuTransitions& entry = transitions[cpu];
+            if (event.kind == cfp::TraceEvent::FREQUENCY) {
+                if (entry.frequency_changes == 0) {
+                    entry.min_khz = entry.max_khz = event.value;
+                    entry.first_ns = event.timestamp_ns;
+                }
+                entry.frequency_changes++;
+                entry.min_khz = std::min(entry.min_khz, event.value);
+                entry.max_khz = std::max(entry.max_khz, event.value);
+                entry.last_khz = event.value;
+                entry.last_ns = event.timestamp_ns;
+            } else if (event.value != cfp::kIdleExit) {
+                entry.idle_entries++;
+            }
+
+            if (csv != nullptr) {
+                if (event.kind == cfp::TraceEvent::FREQUENCY) {
+                    fprintf(csv, "%llu,%d,frequency,%u\n",
+                            static_cast<unsigned long long>(event.timestamp_ns), cpu, event.value);
+                } else {
+                    fprintf(csv, "%llu,%d,idle,%d\n",
+                            static_cast<unsigned long long>(event.timestamp_ns), cpu, static_cast<int32_t>(event.value));
+                }
+            }
+        }
+        events.clear();
+    };
+
+    bool more = true;
+    while (more && !stop_requested()) {
+        more = source.read(events, 1000);
+        handle_batch();
+    }
+    // Drain what arrived since the last wakeup
+    if (more) {
+        source.read(events, 0);
+        handle_batch();
+    }
+    source.close();
+    if (csv != nullptr) {
+        fclose(csv);
+    }
+
+    std::cout << "\n" << total_events << " events";
+    if (source.lost_events() > 0) {
+        std::cout << ", " << source.lost_events() << " lost to ring-buffer overruns";
+    }
+    std::cout << std::endl;
+
+    if (!transitions.empty()) {
+        std::cout << "\nCPU   Changes   Min MHz   Max MHz  Last MHz   Changes/s   Idle entries" << std::endl;
+        for (const auto& [cpu, entry] : transitions) {
+            double span_sec = (entry.last_ns - entry.first_ns) / 1e9;
+            std::cout << std::left << std::setw(4) << cpu << std::right
+                      << std::setw(10) << entry.frequency_changes
+                      << std::fixed << std::setprecision(0)
+                      << std::setw(10) << entry.min_khz / 1000.0
+                      << std::setw(10) << entry.max_khz / 1000.0
+                      << std::setw(10) << entry.last_khz / 1000.0
+                      << std::setprecision(1)
+                      << std::setw(12) << (span_sec > 0 ? (entry.frequency_changes - 1) / span_sec : 0.0)
+                      << std::setw(15) << entry.idle_entries << std::endl;
+        }
+    }
+    if (csv != nullptr) {
+        std::cout << "\nEvents written to " << options.output_path << std::endl;
+    }
+    return 0;
+}
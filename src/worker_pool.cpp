@@ -0,0 +1,146 @@
+#include "worker_pool.h"
+#include "cpu_utils.h"
+#include "spin_barrier.h"
+
+#include <set>
+#include <stdexcept>
+
+WorkerPool::WorkerPool(const std::vector<int>& cpus) : cpus_(cpus) {
+    std::vector<std::future<void>> ready;
+
+    for (int cpu : cpus_) {
+        auto worker = std::make_unique<Worker>();
+        worker->cpu = cpu;
+        ready.push_back(worker->ready.get_future());
+        worker->thread = std::thread(worker_loop, std::ref(*worker));
+        workers_[cpu] = std::move(worker);
+    }
+
+    // Wait until every worker has tried to pin itself
+    for (auto& f : ready) {
+        f.wait();
+    }
+}
+
+WorkerPool::~WorkerPool() {
+    for (auto& [cpu, worker] : workers_) {
+        {
+            std::lock_guard<std::mutex> lock(worker->mutex);
+            worker->stopping = true;
+        }
+        worker->cv.notify_one();
+    }
+
+    for (auto& [cpu, worker] : workers_) {
+        if (worker->thread.joinable()) {
+            worker->thread.join();
+        }
+    }
+}
+
+bool WorkerPool::is_pinned(int cpu) const {
+    auto it = workers_.find(cpu);
+    return it != workers_.end() && it->second->pinned;
+}
+
+std::future<void> WorkerPool::submit(int cpu, std::function<void()> job) {
+    Worker& worker = *workers_.at(cpu);
+
+    auto task = std::make_shared<std::packaged_task<void()>>(std::move(job));
+    std::future<void> future = task->get_future();
+    {
+        std::lock_guard<std::mutex> lock(worker.mutex);
+        worker.queue.emplace_back([task]() { (*task)(); });
+    }
+    worker.cv.notify_one();
+
+    return future;
+}
+
+std::future<BenchmarkResult> WorkerPool::submit_benchmark(int cpu, InstructionSet instr_set, const BenchmarkOptions& options) {
+    auto promise = std::make_shared<std::promise<BenchmarkResult>>();
+    std::future<BenchmarkResult> future = promise->get_future();
+    bool pinned = is_pinned(cpu);
+
+    BenchmarkOptions job_options = options;
+    job_options.pin_thread = false;
+
+    submit(cpu, [promise, pinned, cpu, instr_set, job_options]() {
+        if (!pinned) {
+            // Still release the other participants of a synchronized start
+            if (job_options.start_barrier != nullptr) {
+                job_options.start_barrier->arrive_and_wait();
+            }
+            BenchmarkResult result;
+            result.core_id = cpu;
+            result.success = false;
+            result.failure = BenchmarkFailure::NOT_PINNABLE;
+            promise->set_value(result);
+            return;
+        }
+        // run_benchmark_with_result() reports its own failures; this only keeps
+        // the promise from being dropped
+        try {
+            promise->set_value(run_benchmark_with_result(instr_set, job_options, cpu));
+        } catch (...) {
+            BenchmarkResult result;
+            result.core_id = cpu;
+            result.success = false;
+            result.failure = BenchmarkFailure::ERROR;
+            result.error = "unexpected exception";
+            promise->set_value(result);
+        }
+    });
+
+    return future;
+}
+
+void WorkerPool::worker_loop(Worker& worker) {
+    worker.pinned = try_pin_to_core(worker.cpu);
+    worker.ready.set_value();
+
+    while (true) {
+        std::function<void()> job;
+        {
+            std::unique_lock<std::mutex> lock(worker.mutex);
+            worker.cv.wait(lock, [&worker]() { return worker.stopping || !worker.queue.empty(); });
+            if (worker.queue.empty()) {
+                return;  // Stopping and drained
+            }
+            job = std::move(worker.queue.front());
+            worker.queue.pop_front();
+        }
+        job();
+    }
+}
+
+std::vector<BenchmarkResult> run_synchronized(WorkerPool& pool, const std::vector<CoreAssignment>& assignments, const BenchmarkOptions& options) {
+    // Validate everything before queueing anything: a job already waiting at
+    // the barrier would spin forever for one that never gets submitted. Two
+    // assignments on one worker would run one after the other, so the first
+    // would never see the second arrive either.
+    std::set<int> seen;
+    for (const auto& assignment : assignments) {
+        if (!pool.has_cpu(assignment.cpu)) {
+            throw std::invalid_argument("CPU " + std::to_string(assignment.cpu) + " has no worker in the pool");
+        }
+        if (!seen.insert(assignment.cpu).second) {
+            throw std::invalid_argument("CPU " + std::to_string(assignment.cpu) + " is assigned twice in one run");
+        }
+    }
+
+    SpinBarrier start_barrier(static_cast<int>(assignments.size()));
+    BenchmarkOptions synced_options = options;
+    synced_options.start_barrier = &start_barrier;
+
+    std::vector<std::future<BenchmarkResult>> pending;
+    for (const auto& assignment : assignments) {
+        pending.push_back(pool.submit_benchmark(assignment.cpu, assignment.instr_set, synced_options));
+    }
+
+    std::vector<BenchmarkResult> results;
+    for (auto& f : pending) {
+        results.push_back(f.get());
+    }
+    return results;
+}